@@ -0,0 +1,855 @@
+//
+// Copyright © 2025 Agora
+// This file is part of TEN Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// ten_vad_bench: reproducible performance and accuracy run over testset/
+//
+//   ten_vad_bench [--testset dir] [--model path] [--out result.json]
+//                 [--baseline result.json] [--tolerance 0.002]
+//                 [--pr-data PR_data.txt] [--threads max] [--streams n]
+//                 [--seconds s] [--handles n] [--precision fp32|int8]
+//                 [--math libm|fast] [--pitch full|lazy]
+//
+// Sections, all written to one JSON object (stdout unless --out):
+//   single_stream  real-time factor and exact per-hop latency distribution
+//                  of ten_vad_process() over every testset file
+//   stages         per-stage latencies of ten_vad_get_stats() over that run
+//   accuracy       precision / recall over the thresholds 0.00 .. 1.00 with
+//                  the frame alignment of plot_pr_curves.py, and the area
+//                  under the PR curve; with --precision int8, --math fast
+//                  or --pitch lazy also the reference (float32 model, libm
+//                  math, full pitch) over the same files and the pr_auc
+//                  delta
+//   memory         ten_vad_get_mem_size() and peak RSS growth per handle
+//   create_destroy first create (model load) and the create + destroy cost
+//                  of further handles sharing the model
+//   multi_stream   throughput of streams interleaved hop by hop on 1, 2, 4,
+//                  ... up to --threads threads (default: all cores)
+// With --baseline, the run fails (exit code 2) when pr_auc drops more than
+// --tolerance below the value in that earlier output, e.g. after changing
+// optimization flags.
+//
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "ten_vad.h"
+
+#define BENCH_HOP_SIZE (256) // 16 ms per frame
+#define BENCH_FS (16000)
+#define BENCH_THRESHOLD (0.5f)
+#define BENCH_MAX_FILES (256)
+#define BENCH_PR_STEPS (101) // thresholds 0.00, 0.01, ... 1.00
+
+typedef struct
+{
+  char name[256];
+  int16_t *pcm;
+  size_t num_samples;
+  int *label; // frame-wise 0/1 label at BENCH_HOP_SIZE, NULL if no .scv
+  size_t num_labels;
+} bench_file_t;
+
+typedef struct
+{
+  const char *testset;
+  const char *model_path;
+  const char *out;
+  const char *baseline;
+  const char *pr_data;
+  double tolerance;
+  int max_threads;
+  int streams_per_thread;
+  double seconds;
+  int handles;
+  int model_precision; // ten_vad_config_t::model_precision
+  int fast_math;       // ten_vad_config_t::fast_math
+  int lazy_pitch;      // ten_vad_config_t::lazy_pitch
+} bench_opts_t;
+
+typedef struct
+{
+  ten_vad_handle_t *handles;
+  int num_handles;
+  const int16_t *pcm; // looped input of all streams
+  size_t num_samples;
+  size_t hops; // hops per stream
+  int failed;
+} bench_worker_t;
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static long bench_peak_rss_bytes(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+#if defined(__APPLE__)
+  return (long)ru.ru_maxrss; // bytes
+#else
+  return (long)ru.ru_maxrss * 1024; // kilobytes
+#endif
+}
+
+static int bench_cmp_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static int bench_cmp_file(const void *a, const void *b)
+{
+  return strcmp(((const bench_file_t *)a)->name, ((const bench_file_t *)b)->name);
+}
+
+static void bench_config(const bench_opts_t *opts, ten_vad_config_t *config)
+{
+  memset(config, 0, sizeof(*config));
+  config->hop_size = BENCH_HOP_SIZE;
+  config->threshold = BENCH_THRESHOLD;
+  config->model_path = opts->model_path;
+  config->model_precision = opts->model_precision;
+  config->fast_math = opts->fast_math;
+  config->lazy_pitch = opts->lazy_pitch;
+}
+
+// probabilities of every hop of every file, probs[i] holds hops + 1 entries
+static int bench_run_probs(const ten_vad_config_t *config, const bench_file_t *files,
+                           int num_files, float **probs)
+{
+  int ret = 0;
+  for (int i = 0; i < num_files; i++)
+  {
+    size_t hops = files[i].num_samples / BENCH_HOP_SIZE;
+    ten_vad_handle_t h = NULL;
+    int flag;
+    probs[i] = (float *)calloc(hops + 1, sizeof(float));
+    if (ten_vad_create_ex(&h, config) != 0)
+    {
+      ret = 1;
+      continue;
+    }
+    for (size_t k = 0; k < hops; k++)
+    {
+      if (ten_vad_process(h, files[i].pcm + k * BENCH_HOP_SIZE, BENCH_HOP_SIZE, &probs[i][k], &flag) != 0)
+      {
+        ret = 1;
+      }
+    }
+    ten_vad_destroy(&h);
+  }
+  return ret;
+}
+
+// precision / recall at the BENCH_PR_STEPS thresholds, frame k + 1 of the
+// model output against label frame k as in plot_pr_curves.py; returns the
+// area under the PR curve
+static double bench_pr_curve(const bench_file_t *files, int num_files, float *const *probs,
+                             double *precision, double *recall, size_t *eval_frames)
+{
+  uint64_t tp[BENCH_PR_STEPS], fp[BENCH_PR_STEPS], fn[BENCH_PR_STEPS];
+  double pr_auc = 0.0;
+  memset(tp, 0, sizeof(tp));
+  memset(fp, 0, sizeof(fp));
+  memset(fn, 0, sizeof(fn));
+  *eval_frames = 0;
+  for (int i = 0; i < num_files; i++)
+  {
+    size_t hops = files[i].num_samples / BENCH_HOP_SIZE;
+    size_t frame_num = files[i].num_labels < hops ? files[i].num_labels : hops;
+    if (files[i].label == NULL || probs[i] == NULL)
+    {
+      continue;
+    }
+    for (size_t k = 0; k + 1 < frame_num; k++)
+    {
+      float p = probs[i][k + 1];
+      int lab = files[i].label[k];
+      for (int t = 0; t < BENCH_PR_STEPS; t++)
+      {
+        int pred = p >= (float)t * 0.01f;
+        tp[t] += pred && lab;
+        fp[t] += pred && !lab;
+        fn[t] += !pred && lab;
+      }
+      (*eval_frames)++;
+    }
+  }
+  for (int t = 0; t < BENCH_PR_STEPS; t++)
+  {
+    precision[t] = tp[t] + fp[t] ? (double)tp[t] / (tp[t] + fp[t]) : 0.0;
+    recall[t] = tp[t] + fn[t] ? (double)tp[t] / (tp[t] + fn[t]) : 0.0;
+  }
+  // recall falls as the threshold rises; the last threshold is left out as
+  // in the plotted curve
+  for (int t = 1; t < BENCH_PR_STEPS - 1; t++)
+  {
+    pr_auc += (recall[t - 1] - recall[t]) * 0.5 * (precision[t - 1] + precision[t]);
+  }
+  return pr_auc;
+}
+
+// 16 kHz mono 16-bit PCM only, as in testset/
+static int bench_read_wav(const char *path, int16_t **pcm, size_t *num_samples)
+{
+  FILE *fp = fopen(path, "rb");
+  char id[4];
+  uint32_t size;
+  uint16_t fmt[2] = {0, 0};
+  uint32_t fs = 0;
+  uint16_t bits = 0;
+  int ret = -1;
+
+  if (fp == NULL)
+  {
+    return -1;
+  }
+  fseek(fp, 12, SEEK_SET); // RIFF header
+  while (fread(id, 1, 4, fp) == 4 && fread(&size, 4, 1, fp) == 1)
+  {
+    if (memcmp(id, "fmt ", 4) == 0 && size >= 16)
+    {
+      fread(fmt, 2, 2, fp);
+      fread(&fs, 4, 1, fp);
+      fseek(fp, 6, SEEK_CUR); // byte rate, block align
+      fread(&bits, 2, 1, fp);
+      fseek(fp, size - 16 + (size & 1), SEEK_CUR);
+    }
+    else if (memcmp(id, "data", 4) == 0)
+    {
+      if (fmt[0] != 1 || fmt[1] != 1 || fs != BENCH_FS || bits != 16)
+      {
+        break;
+      }
+      *num_samples = size / sizeof(int16_t);
+      *pcm = (int16_t *)malloc(*num_samples * sizeof(int16_t));
+      ret = fread(*pcm, sizeof(int16_t), *num_samples, fp) == *num_samples ? 0 : -1;
+      break;
+    }
+    else
+    {
+      fseek(fp, size + (size & 1), SEEK_CUR);
+    }
+  }
+  fclose(fp);
+  return ret;
+}
+
+// frame-wise label of a .scv file, the same as convert_label_to_framewise()
+// of plot_pr_curves.py: "name,start,end,label,start,end,label,..."
+static int bench_read_label(const char *path, int **label, size_t *num_labels)
+{
+  FILE *fp = fopen(path, "r");
+  double frame_dur = (double)BENCH_HOP_SIZE / BENCH_FS;
+  double start, end, first_start = -1.0, last_end = 0.0;
+  int lab, c;
+  size_t cap = 1024, num = 0, max_num;
+
+  if (fp == NULL)
+  {
+    return -1;
+  }
+  while ((c = fgetc(fp)) != EOF && c != ',')
+  {
+  } // skip the name
+  *label = (int *)malloc(cap * sizeof(int));
+  while (fscanf(fp, "%lf,%lf,%d", &start, &end, &lab) == 3)
+  {
+    long seg = (long)(((end - start) / frame_dur) + 0.5);
+    if (first_start < 0.0)
+    {
+      first_start = start;
+    }
+    last_end = end;
+    for (long i = 0; i < seg; i++)
+    {
+      if (num == cap)
+      {
+        cap *= 2;
+        *label = (int *)realloc(*label, cap * sizeof(int));
+      }
+      (*label)[num++] = lab;
+    }
+    if (fgetc(fp) != ',')
+    {
+      break;
+    }
+  }
+  fclose(fp);
+  max_num = (size_t)((last_end - first_start) / frame_dur);
+  *num_labels = num < max_num ? num : max_num;
+  return 0;
+}
+
+static int bench_load_testset(const char *dir, bench_file_t *files, int *num_files)
+{
+  DIR *d = opendir(dir);
+  struct dirent *e;
+  char path[1024];
+  int num = 0;
+
+  if (d == NULL)
+  {
+    fprintf(stderr, "cannot open testset dir %s\n", dir);
+    return -1;
+  }
+  while ((e = readdir(d)) != NULL && num < BENCH_MAX_FILES)
+  {
+    size_t len = strlen(e->d_name);
+    bench_file_t *f = &files[num];
+    if (len < 5 || len >= sizeof(f->name) || strcmp(e->d_name + len - 4, ".wav") != 0)
+    {
+      continue;
+    }
+    memset(f, 0, sizeof(*f));
+    strcpy(f->name, e->d_name);
+    snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+    if (bench_read_wav(path, &f->pcm, &f->num_samples) != 0)
+    {
+      fprintf(stderr, "skipping %s: not 16 kHz mono 16-bit PCM\n", path);
+      continue;
+    }
+    strcpy(path + strlen(path) - 4, ".scv");
+    if (bench_read_label(path, &f->label, &f->num_labels) != 0)
+    {
+      f->label = NULL;
+      f->num_labels = 0;
+    }
+    num++;
+  }
+  closedir(d);
+  qsort(files, num, sizeof(bench_file_t), bench_cmp_file);
+  *num_files = num;
+  return num > 0 ? 0 : -1;
+}
+
+static void bench_json_latency(FILE *out, const char *name, const ten_vad_latency_t *l, int last)
+{
+  fprintf(out,
+          "      \"%s\": {\"count\": %llu, \"min_ns\": %llu, \"avg_ns\": %llu, "
+          "\"p99_ns\": %llu, \"max_ns\": %llu}%s\n",
+          name, (unsigned long long)l->count, (unsigned long long)l->min_ns,
+          (unsigned long long)l->avg_ns, (unsigned long long)l->p99_ns,
+          (unsigned long long)l->max_ns, last ? "" : ",");
+}
+
+static void *bench_worker(void *arg)
+{
+  bench_worker_t *w = (bench_worker_t *)arg;
+  size_t pos = 0;
+  float prob;
+  int flag;
+
+  for (size_t h = 0; h < w->hops; h++)
+  {
+    if (pos + BENCH_HOP_SIZE > w->num_samples)
+    {
+      pos = 0;
+    }
+    for (int s = 0; s < w->num_handles; s++)
+    {
+      if (ten_vad_process(w->handles[s], w->pcm + pos, BENCH_HOP_SIZE, &prob, &flag) != 0)
+      {
+        w->failed = 1;
+      }
+    }
+    pos += BENCH_HOP_SIZE;
+  }
+  return NULL;
+}
+
+// value after "key": in a previous output of this tool
+static int bench_read_baseline(const char *path, const char *key, double *value)
+{
+  FILE *fp = fopen(path, "r");
+  char buf[65536];
+  char pattern[64];
+  size_t len;
+  const char *p;
+
+  if (fp == NULL)
+  {
+    return -1;
+  }
+  len = fread(buf, 1, sizeof(buf) - 1, fp);
+  fclose(fp);
+  buf[len] = '\0';
+  snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+  p = strstr(buf, pattern);
+  if (p == NULL || sscanf(p + strlen(pattern), "%lf", value) != 1)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+static void bench_usage(void)
+{
+  fprintf(stderr,
+          "usage: ten_vad_bench [--testset dir] [--model path] [--out result.json]\n"
+          "                     [--baseline result.json] [--tolerance 0.002]\n"
+          "                     [--pr-data PR_data.txt] [--threads max] [--streams n]\n"
+          "                     [--seconds s] [--handles n] [--precision fp32|int8]\n"
+          "                     [--math libm|fast] [--pitch full|lazy]\n");
+}
+
+int main(int argc, char *argv[])
+{
+  bench_opts_t opts = {"testset", NULL, NULL, NULL, NULL, 0.002, 0, 4, 10.0, 64, 0, 0, 0};
+  static bench_file_t files[BENCH_MAX_FILES];
+  ten_vad_config_t config;
+  ten_vad_stats_t stats;
+  int num_files = 0;
+  FILE *out = stdout;
+  int ret = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+    if (val == NULL)
+    {
+      bench_usage();
+      return 1;
+    }
+    if (strcmp(arg, "--testset") == 0)
+      opts.testset = val;
+    else if (strcmp(arg, "--model") == 0)
+      opts.model_path = val;
+    else if (strcmp(arg, "--out") == 0)
+      opts.out = val;
+    else if (strcmp(arg, "--baseline") == 0)
+      opts.baseline = val;
+    else if (strcmp(arg, "--tolerance") == 0)
+      opts.tolerance = atof(val);
+    else if (strcmp(arg, "--pr-data") == 0)
+      opts.pr_data = val;
+    else if (strcmp(arg, "--threads") == 0)
+      opts.max_threads = atoi(val);
+    else if (strcmp(arg, "--streams") == 0)
+      opts.streams_per_thread = atoi(val);
+    else if (strcmp(arg, "--seconds") == 0)
+      opts.seconds = atof(val);
+    else if (strcmp(arg, "--handles") == 0)
+      opts.handles = atoi(val);
+    else if (strcmp(arg, "--precision") == 0 && strcmp(val, "fp32") == 0)
+      opts.model_precision = 0;
+    else if (strcmp(arg, "--precision") == 0 && strcmp(val, "int8") == 0)
+      opts.model_precision = 1;
+    else if (strcmp(arg, "--math") == 0 && strcmp(val, "libm") == 0)
+      opts.fast_math = 0;
+    else if (strcmp(arg, "--math") == 0 && strcmp(val, "fast") == 0)
+      opts.fast_math = 1;
+    else if (strcmp(arg, "--pitch") == 0 && strcmp(val, "full") == 0)
+      opts.lazy_pitch = 0;
+    else if (strcmp(arg, "--pitch") == 0 && strcmp(val, "lazy") == 0)
+      opts.lazy_pitch = 1;
+    else
+    {
+      bench_usage();
+      return 1;
+    }
+    i++;
+  }
+  if (opts.max_threads <= 0)
+  {
+    opts.max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    opts.max_threads = opts.max_threads > 0 ? opts.max_threads : 1;
+  }
+  if (opts.streams_per_thread <= 0 || opts.seconds <= 0.0 || opts.handles <= 0)
+  {
+    bench_usage();
+    return 1;
+  }
+  bench_config(&opts, &config);
+
+  if (bench_load_testset(opts.testset, files, &num_files) != 0)
+  {
+    fprintf(stderr, "no usable wav files in %s\n", opts.testset);
+    return 1;
+  }
+
+  // create / destroy: the first handle loads the model, which the later
+  // ones share while it is alive --------------------------------------------
+  ten_vad_handle_t keeper = NULL;
+  uint64_t t0 = bench_now_ns();
+  if (ten_vad_create_ex(&keeper, &config) != 0)
+  {
+    fprintf(stderr, "ten_vad_create_ex failed, check --model\n");
+    return 1;
+  }
+  uint64_t first_create_ns = bench_now_ns() - t0;
+  const int create_reps = 200;
+  t0 = bench_now_ns();
+  for (int i = 0; i < create_reps; i++)
+  {
+    ten_vad_handle_t h = NULL;
+    if (ten_vad_create_ex(&h, &config) != 0 || ten_vad_destroy(&h) != 0)
+    {
+      ret = 1;
+    }
+  }
+  uint64_t create_destroy_ns = (bench_now_ns() - t0) / create_reps;
+
+  // memory: the peak RSS growth of a batch of handles that each processed
+  // a few hops, their model is shared ----------------------------------------
+  size_t mem_size = 0;
+  ten_vad_get_mem_size(&config, &mem_size);
+  ten_vad_handle_t *mem_handles = (ten_vad_handle_t *)calloc(opts.handles, sizeof(ten_vad_handle_t));
+  long rss_before = bench_peak_rss_bytes();
+  for (int i = 0; i < opts.handles; i++)
+  {
+    float prob;
+    int flag;
+    if (ten_vad_create_ex(&mem_handles[i], &config) != 0)
+    {
+      ret = 1;
+      continue;
+    }
+    for (int h = 0; h < 8 && (size_t)(h + 1) * BENCH_HOP_SIZE <= files[0].num_samples; h++)
+    {
+      ten_vad_process(mem_handles[i], files[0].pcm + h * BENCH_HOP_SIZE, BENCH_HOP_SIZE, &prob, &flag);
+    }
+  }
+  long rss_after = bench_peak_rss_bytes();
+  for (int i = 0; i < opts.handles; i++)
+  {
+    ten_vad_destroy(&mem_handles[i]);
+  }
+  free(mem_handles);
+
+  // single stream: every hop of every file timed on its own ------------------
+  size_t total_hops = 0;
+  for (int i = 0; i < num_files; i++)
+  {
+    total_hops += files[i].num_samples / BENCH_HOP_SIZE;
+  }
+  uint64_t *hop_ns = (uint64_t *)malloc((total_hops + 1) * sizeof(uint64_t));
+  float **probs = (float **)calloc(num_files, sizeof(float *));
+  ten_vad_latency_t stage_sum[5];
+  memset(stage_sum, 0, sizeof(stage_sum));
+  uint64_t proc_ns = 0;
+  size_t hop_idx = 0;
+  for (int i = 0; i < num_files; i++)
+  {
+    size_t hops = files[i].num_samples / BENCH_HOP_SIZE;
+    ten_vad_handle_t h = NULL;
+    int flag;
+    probs[i] = (float *)malloc((hops + 1) * sizeof(float));
+    if (ten_vad_create_ex(&h, &config) != 0)
+    {
+      ret = 1;
+      continue;
+    }
+    for (size_t k = 0; k < hops; k++)
+    {
+      t0 = bench_now_ns();
+      if (ten_vad_process(h, files[i].pcm + k * BENCH_HOP_SIZE, BENCH_HOP_SIZE, &probs[i][k], &flag) != 0)
+      {
+        ret = 1;
+      }
+      hop_ns[hop_idx] = bench_now_ns() - t0;
+      proc_ns += hop_ns[hop_idx++];
+    }
+    // stage latencies summed over the files, min / max / p99 kept as the
+    // extremes, avg weighted by count
+    if (ten_vad_get_stats(h, &stats) == 0)
+    {
+      ten_vad_latency_t *src[5] = {&stats.stft, &stats.mel, &stats.pitch, &stats.inference, &stats.hop};
+      for (int s = 0; s < 5; s++)
+      {
+        ten_vad_latency_t *acc = &stage_sum[s];
+        if (src[s]->count == 0)
+        {
+          continue;
+        }
+        acc->min_ns = (acc->count == 0 || src[s]->min_ns < acc->min_ns) ? src[s]->min_ns : acc->min_ns;
+        acc->max_ns = src[s]->max_ns > acc->max_ns ? src[s]->max_ns : acc->max_ns;
+        acc->p99_ns = src[s]->p99_ns > acc->p99_ns ? src[s]->p99_ns : acc->p99_ns;
+        acc->avg_ns = (acc->avg_ns * acc->count + src[s]->avg_ns * src[s]->count) /
+                      (acc->count + src[s]->count);
+        acc->count += src[s]->count;
+      }
+    }
+    ten_vad_destroy(&h);
+  }
+  double audio_sec = (double)total_hops * BENCH_HOP_SIZE / BENCH_FS;
+  double rtf = (double)proc_ns * 1e-9 / audio_sec;
+  qsort(hop_ns, hop_idx, sizeof(uint64_t), bench_cmp_u64);
+#define BENCH_PCTL(p) (hop_idx ? hop_ns[(size_t)((hop_idx - 1) * (p))] : 0)
+
+  // accuracy: the PR curve of the run above, and of the float32 model for a
+  // reduced precision one ------------------------------------------------------
+  double precision[BENCH_PR_STEPS], recall[BENCH_PR_STEPS];
+  double ref_precision[BENCH_PR_STEPS], ref_recall[BENCH_PR_STEPS];
+  size_t eval_frames = 0;
+  double pr_auc = bench_pr_curve(files, num_files, probs, precision, recall, &eval_frames);
+  double best_f1 = 0.0, best_f1_thr = 0.0;
+  for (int t = 0; t < BENCH_PR_STEPS; t++)
+  {
+    double f1 = precision[t] + recall[t] > 0.0
+                    ? 2.0 * precision[t] * recall[t] / (precision[t] + recall[t])
+                    : 0.0;
+    if (f1 > best_f1)
+    {
+      best_f1 = f1;
+      best_f1_thr = t * 0.01;
+    }
+  }
+  double ref_pr_auc = pr_auc, max_prob_diff = 0.0;
+  const int has_ref = opts.model_precision != 0 || opts.fast_math != 0 || opts.lazy_pitch != 0;
+  if (has_ref)
+  {
+    ten_vad_config_t ref_config = config;
+    float **ref_probs = (float **)calloc(num_files, sizeof(float *));
+    size_t ref_frames = 0;
+    ref_config.model_precision = 0;
+    ref_config.fast_math = 0;
+    ref_config.lazy_pitch = 0;
+    if (bench_run_probs(&ref_config, files, num_files, ref_probs) != 0)
+    {
+      ret = 1;
+    }
+    ref_pr_auc = bench_pr_curve(files, num_files, ref_probs, ref_precision, ref_recall, &ref_frames);
+    for (int i = 0; i < num_files; i++)
+    {
+      size_t hops = files[i].num_samples / BENCH_HOP_SIZE;
+      for (size_t k = 0; k < hops && probs[i] != NULL && ref_probs[i] != NULL; k++)
+      {
+        double d = probs[i][k] > ref_probs[i][k] ? probs[i][k] - ref_probs[i][k]
+                                                 : ref_probs[i][k] - probs[i][k];
+        max_prob_diff = d > max_prob_diff ? d : max_prob_diff;
+      }
+      free(ref_probs[i]);
+    }
+    free(ref_probs);
+  }
+  if (opts.pr_data != NULL)
+  {
+    FILE *fpr = fopen(opts.pr_data, "w");
+    if (fpr != NULL)
+    {
+      for (int t = 0; t < BENCH_PR_STEPS; t++)
+      {
+        fprintf(fpr, "%.2f %.4f %.4f\n", t * 0.01, precision[t], recall[t]);
+      }
+      fclose(fpr);
+    }
+  }
+
+  // multi stream: streams_per_thread streams per thread, interleaved hop by
+  // hop, all fed the concatenated testset audio ---------------------------------
+  size_t all_samples = 0;
+  for (int i = 0; i < num_files; i++)
+  {
+    all_samples += files[i].num_samples / BENCH_HOP_SIZE * BENCH_HOP_SIZE;
+  }
+  int16_t *all_pcm = (int16_t *)malloc(all_samples * sizeof(int16_t));
+  for (size_t i = 0, pos = 0; i < (size_t)num_files; i++)
+  {
+    size_t len = files[i].num_samples / BENCH_HOP_SIZE * BENCH_HOP_SIZE;
+    memcpy(all_pcm + pos, files[i].pcm, len * sizeof(int16_t));
+    pos += len;
+  }
+  int num_runs = 0;
+  int run_threads[64];
+  double run_hops_per_sec[64], run_rt_streams[64];
+  for (int t = 1; num_runs < 64; t = t * 2 < opts.max_threads && t < opts.max_threads ? t * 2 : opts.max_threads)
+  {
+    int nstreams = t * opts.streams_per_thread;
+    bench_worker_t *workers = (bench_worker_t *)calloc(t, sizeof(bench_worker_t));
+    pthread_t *threads = (pthread_t *)calloc(t, sizeof(pthread_t));
+    ten_vad_handle_t *handles = (ten_vad_handle_t *)calloc(nstreams, sizeof(ten_vad_handle_t));
+    size_t hops = (size_t)(opts.seconds * BENCH_FS / BENCH_HOP_SIZE);
+    for (int s = 0; s < nstreams; s++)
+    {
+      if (ten_vad_create_ex(&handles[s], &config) != 0)
+      {
+        ret = 1;
+      }
+    }
+    for (int w = 0; w < t; w++)
+    {
+      workers[w].handles = handles + w * opts.streams_per_thread;
+      workers[w].num_handles = opts.streams_per_thread;
+      workers[w].pcm = all_pcm;
+      workers[w].num_samples = all_samples;
+      workers[w].hops = hops;
+    }
+    t0 = bench_now_ns();
+    for (int w = 0; w < t; w++)
+    {
+      pthread_create(&threads[w], NULL, bench_worker, &workers[w]);
+    }
+    for (int w = 0; w < t; w++)
+    {
+      pthread_join(threads[w], NULL);
+      ret |= workers[w].failed;
+    }
+    double wall = (double)(bench_now_ns() - t0) * 1e-9;
+    run_threads[num_runs] = t;
+    run_hops_per_sec[num_runs] = (double)hops * nstreams / wall;
+    run_rt_streams[num_runs] = opts.seconds * nstreams / wall;
+    num_runs++;
+    for (int s = 0; s < nstreams; s++)
+    {
+      ten_vad_destroy(&handles[s]);
+    }
+    free(handles);
+    free(threads);
+    free(workers);
+    if (t == opts.max_threads)
+    {
+      break;
+    }
+  }
+  free(all_pcm);
+
+  // process-wide aggregate over every section above
+  ten_vad_stats_t global;
+  memset(&global, 0, sizeof(global));
+  ten_vad_get_stats(NULL, &global);
+  ten_vad_destroy(&keeper);
+
+  // output ---------------------------------------------------------------------
+  if (opts.out != NULL && (out = fopen(opts.out, "w")) == NULL)
+  {
+    fprintf(stderr, "cannot write %s\n", opts.out);
+    return 1;
+  }
+  fprintf(out, "{\n");
+  fprintf(out, "  \"version\": \"%s\",\n", ten_vad_get_version());
+  fprintf(out, "  \"hop_size\": %d,\n", BENCH_HOP_SIZE);
+  fprintf(out, "  \"model_precision\": \"%s\",\n", opts.model_precision ? "int8" : "fp32");
+  fprintf(out, "  \"math\": \"%s\",\n", opts.fast_math ? "fast" : "libm");
+  fprintf(out, "  \"pitch\": \"%s\",\n", opts.lazy_pitch ? "lazy" : "full");
+  fprintf(out, "  \"files\": %d,\n", num_files);
+  fprintf(out, "  \"single_stream\": {\n");
+  fprintf(out, "    \"audio_sec\": %.3f,\n", audio_sec);
+  fprintf(out, "    \"proc_sec\": %.6f,\n", (double)proc_ns * 1e-9);
+  fprintf(out, "    \"rtf\": %.6f,\n", rtf);
+  fprintf(out, "    \"hops\": %zu,\n", hop_idx);
+  fprintf(out,
+          "    \"hop_ns\": {\"min\": %llu, \"avg\": %llu, \"p50\": %llu, \"p90\": %llu, "
+          "\"p99\": %llu, \"p999\": %llu, \"max\": %llu}\n",
+          (unsigned long long)BENCH_PCTL(0.0),
+          (unsigned long long)(hop_idx ? proc_ns / hop_idx : 0),
+          (unsigned long long)BENCH_PCTL(0.5), (unsigned long long)BENCH_PCTL(0.9),
+          (unsigned long long)BENCH_PCTL(0.99), (unsigned long long)BENCH_PCTL(0.999),
+          (unsigned long long)BENCH_PCTL(1.0));
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"stages\": {\n");
+  fprintf(out, "    \"single_stream\": {\n");
+  bench_json_latency(out, "stft", &stage_sum[0], 0);
+  bench_json_latency(out, "mel", &stage_sum[1], 0);
+  bench_json_latency(out, "pitch", &stage_sum[2], 0);
+  bench_json_latency(out, "inference", &stage_sum[3], 0);
+  bench_json_latency(out, "hop", &stage_sum[4], 1);
+  fprintf(out, "    },\n");
+  fprintf(out, "    \"process\": {\n");
+  fprintf(out, "      \"frames\": %llu, \"gated_frames\": %llu, \"inferred_frames\": %llu,\n",
+          (unsigned long long)global.frames, (unsigned long long)global.gated_frames,
+          (unsigned long long)global.inferred_frames);
+  bench_json_latency(out, "stft", &global.stft, 0);
+  bench_json_latency(out, "mel", &global.mel, 0);
+  bench_json_latency(out, "pitch", &global.pitch, 0);
+  bench_json_latency(out, "inference", &global.inference, 0);
+  bench_json_latency(out, "hop", &global.hop, 1);
+  fprintf(out, "    }\n");
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"accuracy\": {\n");
+  fprintf(out, "    \"frames\": %zu,\n", eval_frames);
+  fprintf(out, "    \"pr_auc\": %.6f,\n", pr_auc);
+  fprintf(out, "    \"precision_at_0.5\": %.6f,\n", precision[50]);
+  fprintf(out, "    \"recall_at_0.5\": %.6f,\n", recall[50]);
+  fprintf(out, "    \"best_f1\": %.6f,\n", best_f1);
+  fprintf(out, "    \"best_f1_threshold\": %.2f%s\n", best_f1_thr,
+          has_ref ? "," : "");
+  if (has_ref)
+  {
+    fprintf(out, "    \"ref_pr_auc\": %.6f,\n", ref_pr_auc);
+    fprintf(out, "    \"pr_auc_delta\": %.6f,\n", pr_auc - ref_pr_auc);
+    fprintf(out, "    \"ref_precision_at_0.5\": %.6f,\n", ref_precision[50]);
+    fprintf(out, "    \"ref_recall_at_0.5\": %.6f,\n", ref_recall[50]);
+    fprintf(out, "    \"max_prob_diff\": %.6f\n", max_prob_diff);
+  }
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"memory\": {\n");
+  fprintf(out, "    \"mem_size_bytes\": %zu,\n", mem_size);
+  fprintf(out, "    \"handles\": %d,\n", opts.handles);
+  fprintf(out, "    \"peak_rss_per_handle_bytes\": %ld\n", (rss_after - rss_before) / opts.handles);
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"create_destroy\": {\n");
+  fprintf(out, "    \"first_create_ns\": %llu,\n", (unsigned long long)first_create_ns);
+  fprintf(out, "    \"create_destroy_ns\": %llu\n", (unsigned long long)create_destroy_ns);
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"multi_stream\": {\n");
+  fprintf(out, "    \"streams_per_thread\": %d,\n", opts.streams_per_thread);
+  fprintf(out, "    \"audio_sec_per_stream\": %.3f,\n", opts.seconds);
+  fprintf(out, "    \"runs\": [\n");
+  for (int r = 0; r < num_runs; r++)
+  {
+    fprintf(out,
+            "      {\"threads\": %d, \"streams\": %d, \"hops_per_sec\": %.1f, "
+            "\"realtime_streams\": %.1f}%s\n",
+            run_threads[r], run_threads[r] * opts.streams_per_thread,
+            run_hops_per_sec[r], run_rt_streams[r], r + 1 < num_runs ? "," : "");
+  }
+  fprintf(out, "    ]\n");
+  fprintf(out, "  }\n");
+  fprintf(out, "}\n");
+  if (out != stdout)
+  {
+    fclose(out);
+  }
+
+  fprintf(stderr, "rtf %.6f, hop p99 %llu ns, pr_auc %.6f, %.1f realtime streams on %d threads\n",
+          rtf, (unsigned long long)BENCH_PCTL(0.99), pr_auc,
+          num_runs ? run_rt_streams[num_runs - 1] : 0.0, num_runs ? run_threads[num_runs - 1] : 0);
+  if (has_ref)
+  {
+    fprintf(stderr, "pr_auc delta %+.6f against the reference %.6f, max prob diff %.6f\n",
+            pr_auc - ref_pr_auc, ref_pr_auc, max_prob_diff);
+  }
+  if (ret != 0)
+  {
+    fprintf(stderr, "processing errors occurred\n");
+  }
+  if (opts.baseline != NULL)
+  {
+    double base_auc;
+    if (bench_read_baseline(opts.baseline, "pr_auc", &base_auc) != 0)
+    {
+      fprintf(stderr, "no pr_auc in baseline %s\n", opts.baseline);
+      ret = 1;
+    }
+    else if (pr_auc < base_auc - opts.tolerance)
+    {
+      fprintf(stderr, "accuracy regression: pr_auc %.6f < baseline %.6f - %.4f\n",
+              pr_auc, base_auc, opts.tolerance);
+      ret = 2;
+    }
+  }
+
+  for (int i = 0; i < num_files; i++)
+  {
+    free(files[i].pcm);
+    free(files[i].label);
+    free(probs[i]);
+  }
+  free(probs);
+  free(hop_ns);
+  return ret;
+}
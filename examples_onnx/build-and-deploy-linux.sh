@@ -7,17 +7,23 @@
 #
 set -euo pipefail
 
-if [[ "$#" -lt 2 || "$1" != "--ort-path" ]]; then
-    echo "usage: $0 --ort-path <path_to_onnxruntime>" >&2
-    exit 1
-fi
+if [[ "$#" -ge 1 && "$1" == "--native" ]]; then
+    cmake_args=(-DTEN_VAD_NATIVE_BACKEND=ON)
+    shift 1
+else
+    if [[ "$#" -lt 2 || "$1" != "--ort-path" ]]; then
+        echo "usage: $0 --ort-path <path_to_onnxruntime> | --native" >&2
+        exit 1
+    fi
 
-ORT_ROOT="$2"
-shift 2
+    ORT_ROOT="$2"
+    shift 2
 
-if [[ ! -d "$ORT_ROOT" || ! -d "$ORT_ROOT/lib" || ! -d "$ORT_ROOT/include" ]]; then
-    echo "invalid onnxruntime library path: $ORT_ROOT" >&2
-    exit 1
+    if [[ ! -d "$ORT_ROOT" || ! -d "$ORT_ROOT/lib" || ! -d "$ORT_ROOT/include" ]]; then
+        echo "invalid onnxruntime library path: $ORT_ROOT" >&2
+        exit 1
+    fi
+    cmake_args=(-DORT_ROOT="$ORT_ROOT")
 fi
 
 arch=x64
@@ -27,7 +33,7 @@ mkdir -p $build_dir
 cd $build_dir
 
 # Step 1: Build the demo
-cmake ../../ -DORT_ROOT="$ORT_ROOT"
+cmake ../../ "${cmake_args[@]}"
 cmake --build . --config Release
 
 # Step 2: Run the demo
@@ -47,6 +47,130 @@ extern "C"
   TENVAD_API int ten_vad_create(ten_vad_handle_t *handle, size_t hop_size,
                                 float threshold);
 
+  /**
+   * @typedef ten_vad_config_t
+   * @brief Creation parameters for ten_vad_create_ex().
+   * Zero-initialize it and set the fields of interest.
+   */
+  typedef struct ten_vad_config_t
+  {
+    size_t hop_size;        /**< Same as hop_size of ten_vad_create(), but
+                                 counted at sample_rate. */
+    float threshold;        /**< Same as threshold of ten_vad_create(). */
+    const char *model_path; /**< Path of the model file, NULL for the
+                                 default "onnx_model/ten-vad.onnx" relative to
+                                 the working directory. */
+    const void *model_data; /**< Caller-owned model in memory (e.g. mmap'ed
+                                 or linked into the binary), used instead of
+                                 model_path when not NULL. It must stay valid
+                                 and unchanged until every handle created from
+                                 it has been destroyed. */
+    size_t model_data_len;  /**< Size of model_data in bytes. */
+    float gate_rms_threshold; /**< Energy gate: once the RMS of the int16
+                                   samples has stayed below this for
+                                   gate_hang_frames frames, pitch estimation
+                                   and model inference are skipped and the
+                                   probability decays towards 0 until a
+                                   louder frame arrives. 0 disables the gate,
+                                   10 (-70 dBFS) suits muted or digitally
+                                   silent input. */
+    size_t gate_hang_frames;  /**< Frames of 16 ms below gate_rms_threshold
+                                   before gating starts, 0 for the default of
+                                   8. */
+    size_t inference_stride;  /**< Run the model only on every
+                                   inference_stride-th 16 ms frame and repeat
+                                   its probability in between, to save power.
+                                   Features are still updated every frame.
+                                   Onsets are detected up to
+                                   inference_stride - 1 frames later.
+                                   0 or 1: every frame. */
+    float inference_stride_margin; /**< Keep inferring every frame while the
+                                        probability is within this margin of
+                                        threshold, so only confident speech
+                                        or silence is strided. 0: always
+                                        strided. */
+    int sample_rate;          /**< Sampling rate of the audio passed to the
+                                   process calls: 8000, 16000, 24000, 32000
+                                   or 48000, 0 for 16000. Other rates than
+                                   16000 are resampled to 16 kHz internally,
+                                   hop_size * 16000 must then be a multiple
+                                   of sample_rate (e.g. 80 or 128 at 8 kHz,
+                                   480 or 768 at 48 kHz) and the resampler
+                                   adds a few ms of delay. Frame counts,
+                                   gate_hang_frames and inference_stride
+                                   still count 16 ms frames. */
+    size_t spectrum_fft_size; /**< Non-zero: the audio comes with the
+                                   caller's power spectrum of this FFT size
+                                   (256 .. 1024) through
+                                   ten_vad_process_spectrum(), which then
+                                   replaces the internal STFT. Requires a
+                                   hop_size of 256 at 16000 Hz. 0: internal
+                                   STFT, ten_vad_process() and friends. */
+    int model_precision;      /**< 0: float32 model. 1: int8 weights for the
+                                   LSTM and dense layers with int16
+                                   activations, a quarter of the weight
+                                   memory and a slightly different
+                                   probability; built-in native backend only,
+                                   the ONNX Runtime backend rejects it (a
+                                   quantized model can be passed there
+                                   through model_path or model_data). */
+    int fast_math;            /**< 0: libm log / exp in the mel features and
+                                   the pitch estimator. 1: vectorised
+                                   polynomial approximations instead (within
+                                   1 ulp, about 4x faster), a slightly
+                                   different probability. */
+    int lazy_pitch;           /**< 0: pitch estimation on every frame. 1:
+                                   only on frames a zero-crossing and
+                                   low-band energy check finds possibly
+                                   voiced, and a pitch of 0 on the others,
+                                   a slightly different probability. */
+  } ten_vad_config_t;
+
+  /**
+   * @brief Create and initialize a ten_vad instance with an explicit model
+   * source. Handles created from the same model path or the same model_data
+   * buffer share one loaded model.
+   *
+   * @param[out] handle       Pointer to receive the vad handle.
+   * @param[in]  config       Creation parameters, see ten_vad_config_t.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_create_ex(ten_vad_handle_t *handle,
+                                   const ten_vad_config_t *config);
+
+  /**
+   * @brief Query the memory needed by ten_vad_create_in() for a given
+   * configuration.
+   *
+   * @param[in]  config       Creation parameters, see ten_vad_config_t.
+   * @param[out] mem_size     Pointer to receive the size in bytes.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_get_mem_size(const ten_vad_config_t *config,
+                                      size_t *mem_size);
+
+  /**
+   * @brief Create and initialize a ten_vad instance inside caller-provided
+   * memory, e.g. to pack many instances into one large slab. The instance
+   * and all of its processing state are placed in mem, nothing else is
+   * allocated per instance except a few small model I/O descriptors of the
+   * ONNX Runtime backend. The loaded model is shared as with
+   * ten_vad_create_ex(). ten_vad_destroy() must still be called, but it does
+   * not free mem.
+   *
+   * @param[out] handle       Pointer to receive the vad handle, which points
+   * into mem.
+   * @param[in]  mem          Caller-owned memory, 8-byte aligned, which must
+   * stay valid until the handle is destroyed.
+   * @param[in]  mem_size     Size of mem, at least what ten_vad_get_mem_size()
+   * returns for the same config.
+   * @param[in]  config       Creation parameters, see ten_vad_config_t.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_create_in(ten_vad_handle_t *handle, void *mem,
+                                   size_t mem_size,
+                                   const ten_vad_config_t *config);
+
   /**
    * @brief Process one audio frame for voice activity detection.
    * Must call ten_vad_init() before calling this, and ten_vad_destroy() when done.
@@ -65,6 +189,598 @@ extern "C"
   TENVAD_API int ten_vad_process(ten_vad_handle_t handle, const int16_t *audio_data, size_t audio_data_length,
                                  float *out_probability, int *out_flag);
 
+  /**
+   * @brief Process one audio frame of float samples, e.g. straight from a
+   * float32 PCM pipeline, without an intermediate int16 buffer.
+   * The samples are read once and scaled by 32768 while being queued for the
+   * analysis, so a frame holding x / 32768 gives exactly the results of
+   * ten_vad_process() on the int16 samples x.
+   *
+   * @param[in]  handle           Valid VAD handle returned by ten_vad_create().
+   * @param[in]  audio_data       Pointer to an array of float samples in
+   * [-1.0, 1.0], buffer length must equal the hop size.
+   * @param[in]  audio_data_length  size of audio_data buffer, here should be equal to hop_size.
+   * @param[out] out_probability  See ten_vad_process().
+   * @param[out] out_flag         See ten_vad_process().
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_process_f32(ten_vad_handle_t handle, const float *audio_data, size_t audio_data_length,
+                                     float *out_probability, int *out_flag);
+
+  /**
+   * @brief Process one audio frame together with its power spectrum, e.g.
+   * taken from a noise suppressor or echo canceller running at the same hop,
+   * instead of the internal STFT. Only for instances created with a
+   * non-zero ten_vad_config_t::spectrum_fft_size.
+   * The spectrum is the plain |X[k]|^2 of an unnormalized DFT of the int16
+   * samples without pre-emphasis, which is applied to it as a spectral tilt;
+   * it should cover the frame that ends with audio_data. The internal
+   * analysis, whose levels the model was trained on, uses a 768-sample Hann
+   * window zero-padded to 1024 points; other FFT sizes are mapped onto its
+   * 513 bins by nearest neighbour. With the internal analysis on the
+   * testset, under 0.5 % of the decisions differ from ten_vad_process();
+   * coarser spectra cost accuracy (about 6 % differ at 512 points).
+   *
+   * @param[in]  handle           Valid VAD handle created with
+   * spectrum_fft_size.
+   * @param[in]  audio_data       Pointer to an array of hop_size int16_t
+   * samples, still used for pitch estimation and the energy gate.
+   * @param[in]  audio_data_length  size of audio_data buffer, here should be equal to hop_size.
+   * @param[in]  power            Pointer to spectrum_fft_size / 2 + 1 power
+   * bins, DC first.
+   * @param[in]  n_bins           Number of bins in power, spectrum_fft_size
+   * / 2 + 1.
+   * @param[out] out_probability  See ten_vad_process().
+   * @param[out] out_flag         See ten_vad_process().
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_process_spectrum(ten_vad_handle_t handle, const int16_t *audio_data,
+                                          size_t audio_data_length, const float *power,
+                                          size_t n_bins, float *out_probability,
+                                          int *out_flag);
+
+  /**
+   * @brief Process one audio frame on each of several ten_vad instances.
+   * The model inference of all instances is stacked into a single batched run,
+   * which is considerably cheaper than calling ten_vad_process() per instance
+   * when serving many concurrent streams.
+   *
+   * @param[in]  handles          Array of num valid VAD handles returned by
+   * ten_vad_create(), all created with the same hop size.
+   * @param[in]  audio_data       Array of num pointers, each to an array of
+   * int16_t samples of length hop_size for the corresponding handle.
+   * @param[in]  audio_data_length  size of each audio_data buffer, here should be equal to hop_size.
+   * @param[out] out_probabilities  Array of num floats receiving the voice
+   * activity probability of each handle, see ten_vad_process().
+   * @param[out] out_flags        Array of num ints receiving the binary voice
+   * activity decision of each handle, see ten_vad_process().
+   * @param[in]  num              Number of handles.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_process_batch(ten_vad_handle_t *handles, const int16_t *const *audio_data,
+                                       size_t audio_data_length, float *out_probabilities,
+                                       int *out_flags, size_t num);
+
+  /**
+   * @brief Process a whole buffer of audio, e.g. a file in offline jobs.
+   * The results are identical to calling ten_vad_process() on each hop_size
+   * chunk in turn, and the instance keeps its state, so consecutive buffers
+   * of one stream may be passed in further calls or mixed with
+   * ten_vad_process(). Internally the front end of many frames runs in one
+   * tight loop before the model runs over the frame sequence.
+   *
+   * @param[in]  handle           Valid VAD handle returned by ten_vad_create().
+   * @param[in]  pcm              Pointer to an array of n int16_t samples.
+   * @param[in]  n                Number of samples in pcm. Only the first
+   * n / hop_size * hop_size samples are processed, the caller should pass
+   * the remaining ones again at the start of the next buffer.
+   * @param[out] probs            Array of at least n / hop_size floats
+   * receiving the voice activity probability of each frame, see
+   * ten_vad_process().
+   * @param[out] flags            Array of at least n / hop_size ints
+   * receiving the binary voice activity decision of each frame, see
+   * ten_vad_process().
+   * @param[out] n_frames         Pointer to receive the number of frames
+   * written to probs and flags.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_process_buffer(ten_vad_handle_t handle, const int16_t *pcm, size_t n,
+                                        float *probs, int *flags, size_t *n_frames);
+
+  /**
+   * @brief Process a chunk of any length, e.g. a 10, 20 or 60 ms transport
+   * frame, without reframing it to hop_size first. The chunk is reframed
+   * internally: every hop_size frame it completes gets the result
+   * ten_vad_process() would give it, and a trailing partial frame is kept
+   * until the next call completes it. While a partial frame is pending, the
+   * instance only accepts further ten_vad_process_chunk() calls, the other
+   * process functions fail. Not for instances in spectrum mode.
+   *
+   * @param[in]  handle           Valid VAD handle returned by ten_vad_create().
+   * @param[in]  audio_data       Pointer to an array of audio_data_length
+   * int16_t samples, may be NULL if audio_data_length is 0.
+   * @param[in]  audio_data_length  Number of samples in audio_data, any value.
+   * @param[out] out_probabilities  Array of max_frames floats receiving the
+   * voice activity probability of each completed frame, see ten_vad_process().
+   * @param[out] out_flags        Array of max_frames ints receiving the binary
+   * voice activity decision of each completed frame, see ten_vad_process().
+   * @param[in]  max_frames       Size of out_probabilities and out_flags;
+   * audio_data_length / hop_size + 1 always suffices, the call fails without
+   * consuming any sample if the completed frames do not fit.
+   * @param[out] n_frames         Pointer to receive the number of completed
+   * frames written to out_probabilities and out_flags.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_process_chunk(ten_vad_handle_t handle, const int16_t *audio_data,
+                                       size_t audio_data_length, float *out_probabilities,
+                                       int *out_flags, size_t max_frames, size_t *n_frames);
+
+  /**
+   * @brief ten_vad_process_chunk() on float samples in [-1.0, 1.0], see
+   * ten_vad_process_f32().
+   */
+  TENVAD_API int ten_vad_process_chunk_f32(ten_vad_handle_t handle, const float *audio_data,
+                                           size_t audio_data_length, float *out_probabilities,
+                                           int *out_flags, size_t max_frames, size_t *n_frames);
+
+  /**
+   * @typedef ten_vad_segmenter_config_t
+   * @brief Parameters of the speech segmenter, see ten_vad_segmenter_start().
+   * Zero-initialize it and set the fields of interest.
+   */
+  typedef struct ten_vad_segmenter_config_t
+  {
+    float start_threshold;    /**< A segment starts once the probability is
+                                   at least this, 0 for the threshold the
+                                   instance was created with. */
+    float end_threshold;      /**< and ends once it has stayed below this,
+                                   0 for start_threshold - 0.15, at least
+                                   half of start_threshold. */
+    size_t min_speech_frames; /**< 16 ms frames the probability has to stay
+                                   at start_threshold or above before a
+                                   segment starts, 0 for the default of 3. */
+    size_t min_silence_frames; /**< 16 ms frames it has to stay below
+                                    end_threshold before the segment ends,
+                                    0 for the default of 10. */
+  } ten_vad_segmenter_config_t;
+
+  /**
+   * @typedef ten_vad_segment_t
+   * @brief One speech segment of ten_vad_segment_buffer() and friends.
+   */
+  typedef struct ten_vad_segment_t
+  {
+    uint64_t start_sample; /**< First sample of the speech, counted at
+                                sample_rate since the instance was created,
+                                reset or its segmenter started. */
+    uint64_t end_sample;   /**< One past its last sample. */
+    float max_prob;        /**< Highest probability within the segment. */
+  } ten_vad_segment_t;
+
+  /**
+   * @brief Start or restart the speech segmenter of a ten_vad instance: a
+   * hysteresis on the probability turning the frames processed by
+   * ten_vad_segment_buffer() and ten_vad_segment_batch() into speech
+   * segments, instead of one result per hop. The timestamps are corrected
+   * for the algorithm delay, e.g. 16 ms plus that of the resampler, so they
+   * point at the speech itself, to the 16 ms frame. ten_vad_reset()
+   * restarts the segmenter as well; its state is not part of a snapshot,
+   * ten_vad_restore() closes no segment and restarts it at the restored
+   * position. Frames processed by the other process functions in between
+   * take the probability of the next frame fed to the segmenter.
+   *
+   * @param[in] handle        Valid VAD handle returned by ten_vad_create(),
+   * not in spectrum mode.
+   * @param[in] config        Segmenter parameters, NULL for the defaults.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_segmenter_start(ten_vad_handle_t handle,
+                                         const ten_vad_segmenter_config_t *config);
+
+  /**
+   * @brief ten_vad_process_buffer() feeding the speech segmenter, see
+   * ten_vad_segmenter_start(); returns the segments that ended within the
+   * buffer instead of a result per hop. A segment still open at the end of
+   * the buffer is returned by a later call, or by ten_vad_segment_flush().
+   *
+   * @param[in]  handle        VAD handle with a started segmenter.
+   * @param[in]  pcm           Pointer to an array of n int16_t samples.
+   * @param[in]  n             Number of samples in pcm, see
+   * ten_vad_process_buffer().
+   * @param[out] segments      Array of max_segments segments receiving the
+   * ended ones, oldest first.
+   * @param[in]  max_segments  Size of segments; n / hop_size / 2 + 1 always
+   * suffices, the call fails without consuming any sample if it is smaller.
+   * @param[out] n_segments    Pointer to receive the number of segments
+   * written.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_segment_buffer(ten_vad_handle_t handle, const int16_t *pcm, size_t n,
+                                        ten_vad_segment_t *segments, size_t max_segments,
+                                        size_t *n_segments);
+
+  /**
+   * @brief ten_vad_process_batch() feeding the speech segmenter of every
+   * instance, see ten_vad_segmenter_start(). A hop ends at most one segment
+   * per instance.
+   *
+   * @param[in]  handles       Array of num VAD handles with a started
+   * segmenter, all created with the same hop size.
+   * @param[in]  audio_data    See ten_vad_process_batch().
+   * @param[in]  audio_data_length  See ten_vad_process_batch().
+   * @param[out] segments      Array of num segments receiving the ended
+   * ones.
+   * @param[out] handle_indices  Array of num size_t receiving the index in
+   * handles of the instance each segment belongs to.
+   * @param[in]  num           Number of handles.
+   * @param[out] n_segments    Pointer to receive the number of segments
+   * written.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_segment_batch(ten_vad_handle_t *handles, const int16_t *const *audio_data,
+                                       size_t audio_data_length, ten_vad_segment_t *segments,
+                                       size_t *handle_indices, size_t num, size_t *n_segments);
+
+  /**
+   * @brief End the open segment of the speech segmenter, if any, at the last
+   * frame processed, e.g. at the end of a file or stream.
+   *
+   * @param[in]  handle        VAD handle with a started segmenter.
+   * @param[out] segment       Pointer to receive the segment.
+   * @param[out] n_segments    Pointer to receive 1 if a segment was open and
+   * is written to segment, else 0.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_segment_flush(ten_vad_handle_t handle, ten_vad_segment_t *segment,
+                                       size_t *n_segments);
+
+  /**
+   * @typedef ten_vad_engine_t
+   * @brief Opaque handle of a ten_vad_engine, a fixed pool of worker threads
+   * processing the frames of many streams.
+   */
+  typedef void *ten_vad_engine_t;
+
+  /**
+   * @typedef ten_vad_engine_result_t
+   * @brief Result of one processed frame of a ten_vad_engine.
+   */
+  typedef struct ten_vad_engine_result_t
+  {
+    ten_vad_handle_t handle; /**< Handle (stream) the frame belongs to. */
+    uint64_t frame_index;    /**< Index of the frame within its stream,
+                                  counted from ten_vad_engine_attach(). */
+    float probability;       /**< See out_probability of ten_vad_process(),
+                                  -1.0 on a processing error. */
+    int flag;                /**< See out_flag of ten_vad_process(), -1 on a
+                                  processing error. */
+  } ten_vad_engine_result_t;
+
+  /**
+   * @brief Result callback of a ten_vad_engine. It is called on the worker
+   * threads, possibly concurrently for different streams, while the frames of
+   * one stream are reported in order. It must not call back into the engine.
+   */
+  typedef void (*ten_vad_engine_callback_t)(const ten_vad_engine_result_t *result,
+                                            void *user_data);
+
+  /**
+   * @typedef ten_vad_engine_config_t
+   * @brief Creation parameters for ten_vad_engine_create().
+   * Zero-initialize it and set the fields of interest.
+   */
+  typedef struct ten_vad_engine_config_t
+  {
+    size_t num_workers;                 /**< Worker threads, 0 for one per
+                                             CPU core. */
+    size_t max_batch;                   /**< Max. streams whose frames a
+                                             worker runs in one batched
+                                             inference, 0 for 64. */
+    int pin_workers;                    /**< Non-zero pins worker i to core
+                                             i (Linux only). */
+    ten_vad_engine_callback_t callback; /**< Result callback, NULL to queue
+                                             the results for
+                                             ten_vad_engine_poll(). */
+    void *user_data;                    /**< Passed to callback. */
+  } ten_vad_engine_config_t;
+
+  /**
+   * @brief Create a ten_vad_engine. Streams ready to process are kept in one
+   * queue per worker; an idle worker steals from the others, and every worker
+   * runs one frame of up to max_batch ready streams in a single batched
+   * inference, see ten_vad_process_batch().
+   *
+   * @param[out] engine       Pointer to receive the engine handle.
+   * @param[in]  config       Creation parameters, NULL for the defaults.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_engine_create(ten_vad_engine_t *engine,
+                                       const ten_vad_engine_config_t *config);
+
+  /**
+   * @brief Attach a ten_vad instance to the engine as one stream. Until it is
+   * detached, the instance must only be fed through ten_vad_engine_submit().
+   *
+   * @param[in] engine        Valid engine handle.
+   * @param[in] handle        Valid VAD handle returned by ten_vad_create().
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_engine_attach(ten_vad_engine_t engine, ten_vad_handle_t handle);
+
+  /**
+   * @brief Queue samples of an attached stream, never blocks on processing.
+   * Any length is accepted; every complete hop_size frame is processed in
+   * order and incomplete frames wait for more samples.
+   *
+   * @param[in] engine        Valid engine handle.
+   * @param[in] handle        Attached VAD handle.
+   * @param[in] audio_data    Pointer to an array of int16_t samples.
+   * @param[in] audio_data_length  Number of samples in audio_data.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_engine_submit(ten_vad_engine_t engine, ten_vad_handle_t handle,
+                                       const int16_t *audio_data, size_t audio_data_length);
+
+  /**
+   * @brief Fetch queued results when the engine has no callback, never blocks.
+   *
+   * @param[in]  engine       Valid engine handle.
+   * @param[out] results      Array of max_results results.
+   * @param[in]  max_results  Capacity of results.
+   * @param[out] num_results  Pointer to receive the number of results written.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_engine_poll(ten_vad_engine_t engine, ten_vad_engine_result_t *results,
+                                     size_t max_results, size_t *num_results);
+
+  /**
+   * @brief Wait until every complete frame submitted so far has been
+   * processed and reported.
+   *
+   * @param[in] engine        Valid engine handle.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_engine_flush(ten_vad_engine_t engine);
+
+  /**
+   * @brief Detach a stream once its queued frames are processed; samples of
+   * an incomplete frame are dropped. No more samples may be submitted for it
+   * meanwhile. Afterwards the instance can be used or destroyed as usual.
+   *
+   * @param[in] engine        Valid engine handle.
+   * @param[in] handle        Attached VAD handle.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_engine_detach(ten_vad_engine_t engine, ten_vad_handle_t handle);
+
+  /**
+   * @brief Stop the workers and destroy the engine, frames not processed yet
+   * are dropped. The attached instances are not destroyed.
+   *
+   * @param[in,out] engine    Pointer to the engine handle; set to NULL on return.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_engine_destroy(ten_vad_engine_t *engine);
+
+  /**
+   * @typedef ten_vad_push_config_t
+   * @brief Parameters of ten_vad_push_start().
+   * Zero-initialize it and set the fields of interest.
+   */
+  typedef struct ten_vad_push_config_t
+  {
+    size_t queue_samples; /**< Capacity of the input queue in samples, at
+                               least hop_size, 0 for 16000 (1 s). Rounded up
+                               to a power of two. */
+    size_t queue_results; /**< Capacity of the result queue, 0 for 256.
+                               Rounded up to a power of two. */
+    int start_thread;     /**< Non-zero: the library runs its own consumer
+                               thread. Zero: the caller's consumer thread
+                               calls ten_vad_push_process(). */
+  } ten_vad_push_config_t;
+
+  /**
+   * @typedef ten_vad_result_t
+   * @brief Result of one frame of the ten_vad_push() mode.
+   */
+  typedef struct ten_vad_result_t
+  {
+    uint64_t timestamp; /**< Position of the first sample of the frame in the
+                             pushed stream, in samples since
+                             ten_vad_push_start(). */
+    float probability;  /**< See out_probability of ten_vad_process(). */
+    int flag;           /**< See out_flag of ten_vad_process(), -1 on a
+                             processing error. */
+  } ten_vad_result_t;
+
+  /**
+   * @brief Switch a ten_vad instance to the push mode for real-time audio
+   * threads: ten_vad_push() only copies samples into a wait-free
+   * single-producer / single-consumer queue, a consumer thread processes
+   * them, and the results come back through a second such queue drained by
+   * ten_vad_poll(). All memory is allocated here. While in push mode, the
+   * instance must not be used with ten_vad_process() or ten_vad_reset().
+   *
+   * @param[in] handle        Valid VAD handle returned by ten_vad_create().
+   * @param[in] config        Queue parameters, NULL for the defaults.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_push_start(ten_vad_handle_t handle,
+                                    const ten_vad_push_config_t *config);
+
+  /**
+   * @brief Queue samples for processing, wait-free and without allocation.
+   * Only one thread may push. Samples of any length are accepted and cut into
+   * hop_size frames in order.
+   *
+   * @param[in] handle        VAD handle in push mode.
+   * @param[in] pcm           Pointer to an array of n int16_t samples.
+   * @param[in] n             Number of samples.
+   * @return 0 on success, or -1 error occurs or the input queue does not
+   * have room for n samples, in which case none of them is queued.
+   */
+  TENVAD_API int ten_vad_push(ten_vad_handle_t handle, const int16_t *pcm, size_t n);
+
+  /**
+   * @brief Process the queued complete frames on the caller's consumer
+   * thread, when push mode was started without start_thread. It stops early
+   * once the result queue is full.
+   *
+   * @param[in]  handle       VAD handle in push mode.
+   * @param[out] n_frames     Pointer to receive the number of processed
+   * frames, may be NULL.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_push_process(ten_vad_handle_t handle, size_t *n_frames);
+
+  /**
+   * @brief Fetch results of the push mode, wait-free. Only one thread may
+   * poll.
+   *
+   * @param[in]  handle       VAD handle in push mode.
+   * @param[out] results      Array of max_results results, oldest first.
+   * @param[in]  max_results  Capacity of results.
+   * @param[out] num_results  Pointer to receive the number of results written.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_poll(ten_vad_handle_t handle, ten_vad_result_t *results,
+                              size_t max_results, size_t *num_results);
+
+  /**
+   * @brief Leave the push mode: stop the consumer thread and free the queues,
+   * dropping whatever they still hold. ten_vad_destroy() does this as well.
+   *
+   * @param[in] handle        VAD handle in push mode.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_push_stop(ten_vad_handle_t handle);
+
+  /**
+   * @brief Query the frame counters of a ten_vad instance, counted since its
+   * creation or last ten_vad_reset().
+   *
+   * @param[in]  handle        Valid VAD handle returned by ten_vad_create().
+   * @param[out] frames        Pointer to receive the number of 16 ms frames
+   * analyzed.
+   * @param[out] gated_frames  Pointer to receive how many of them were
+   * skipped by the energy gate, see ten_vad_config_t::gate_rms_threshold.
+   * @param[out] inferred_frames  Pointer to receive on how many the model
+   * ran, see ten_vad_config_t::inference_stride; may be NULL.
+   * The counters are not synchronized with processing running on another
+   * thread (push or engine mode), read them between calls there.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_get_frame_counts(ten_vad_handle_t handle, uint64_t *frames,
+                                          uint64_t *gated_frames,
+                                          uint64_t *inferred_frames);
+
+  /**
+   * @typedef ten_vad_latency_t
+   * @brief Latency of one processing stage, in nanoseconds.
+   */
+  typedef struct ten_vad_latency_t
+  {
+    uint64_t count;  /**< Number of timed runs. */
+    uint64_t min_ns;
+    uint64_t avg_ns;
+    uint64_t p99_ns; /**< 99th percentile, accurate to a quarter octave. */
+    uint64_t max_ns;
+  } ten_vad_latency_t;
+
+  /**
+   * @typedef ten_vad_stats_t
+   * @brief Counters of ten_vad_get_stats().
+   */
+  typedef struct ten_vad_stats_t
+  {
+    uint64_t frames;          /**< 16 ms frames analyzed. */
+    uint64_t gated_frames;    /**< Frames skipped by the energy gate. */
+    uint64_t inferred_frames; /**< Frames the model ran on. */
+    ten_vad_latency_t stft;      /**< Analysis window, FFT and power
+                                      spectrum of a frame. */
+    ten_vad_latency_t mel;       /**< Mel filter-bank and feature stack of a
+                                      frame. */
+    ten_vad_latency_t pitch;     /**< Pitch estimation of a frame. */
+    ten_vad_latency_t inference; /**< Model run (ONNX Runtime or native) of
+                                      a frame. */
+    ten_vad_latency_t hop;       /**< Whole processing of one hop_size
+                                      chunk. */
+  } ten_vad_stats_t;
+
+  /**
+   * @brief Query the frame counters and per-stage latencies of a ten_vad
+   * instance since its creation or last ten_vad_reset(), or the process-wide
+   * aggregate of all instances since the library was loaded. Work timed as
+   * a group, i.e. a batched or whole-buffer inference and the hops of
+   * ten_vad_process_batch() and ten_vad_process_buffer(), counts as that
+   * many runs of the average latency. The latencies are all 0 when the
+   * library is built without them (TEN_VAD_STATS=OFF). As with
+   * ten_vad_get_frame_counts(), the counters of an instance are not
+   * synchronized with processing on another thread; the aggregate may be
+   * read at any time.
+   *
+   * @param[in]  handle        Valid VAD handle returned by ten_vad_create(),
+   * or NULL for the process-wide aggregate.
+   * @param[out] stats         Pointer to receive the counters.
+   * @return 0 on success, or -1 error occurs, including a NULL handle when
+   * built with TEN_VAD_STATS=OFF.
+   */
+  TENVAD_API int ten_vad_get_stats(ten_vad_handle_t handle, ten_vad_stats_t *stats);
+
+  /**
+   * @brief Reset a ten_vad instance to its freshly created state, e.g. to
+   * reuse it for a new stream. Only the signal state is cleared, the loaded
+   * model and constant tables are kept, which is much cheaper than
+   * destroying and creating a new instance. Fails while the instance is in
+   * push mode, see ten_vad_push_start().
+   *
+   * @param[in] handle Valid VAD handle returned by ten_vad_create().
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_reset(ten_vad_handle_t handle);
+
+  /**
+   * @brief Query the size of a snapshot of a ten_vad instance, see
+   * ten_vad_snapshot(). It only depends on the configuration the instance
+   * was created with, some ten kB.
+   *
+   * @param[in]  handle Valid VAD handle returned by ten_vad_create().
+   * @param[out] size   Pointer to receive the snapshot size in bytes.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_snapshot_size(ten_vad_handle_t handle, size_t *size);
+
+  /**
+   * @brief Save the processing state of a ten_vad instance, e.g. to migrate
+   * a live stream to another process or to clone a warmed-up instance. The
+   * snapshot is a versioned binary blob holding the queued samples, model
+   * recurrent state, features, pitch tracker and filter memories and the
+   * frame counters; it can be restored into any instance created with the
+   * same hop_size, sample_rate and spectrum_fft_size by the same library
+   * version on a machine of the same byte order. Fails while the instance is
+   * in push mode, see ten_vad_push_start().
+   *
+   * @param[in]  handle   Valid VAD handle returned by ten_vad_create().
+   * @param[out] buf      Buffer receiving the snapshot.
+   * @param[in]  buf_size Size of buf, at least ten_vad_snapshot_size().
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_snapshot(ten_vad_handle_t handle, void *buf, size_t buf_size);
+
+  /**
+   * @brief Restore a snapshot taken by ten_vad_snapshot(). The instance then
+   * produces exactly the results the snapshotted one would have produced on
+   * the following audio, without warming up again. Its threshold and the
+   * other runtime settings are kept. The instance is left untouched if the
+   * snapshot does not match it. Fails while the instance is in push mode.
+   *
+   * @param[in] handle Valid VAD handle returned by ten_vad_create().
+   * @param[in] buf    Snapshot written by ten_vad_snapshot().
+   * @param[in] size   Size of the snapshot in bytes.
+   * @return 0 on success, or -1 error occurs.
+   */
+  TENVAD_API int ten_vad_restore(ten_vad_handle_t handle, const void *buf, size_t size);
+
   /**
    * @brief Destroy a ten_vad instance and release its resources.
    *
@@ -4,11 +4,36 @@
 #  Licensed under the Apache License, Version 2.0, with certain conditions.
 #  Refer to the "LICENSE" file in the root directory for more information.
 #
-from ctypes import c_int, c_int32, c_float, c_size_t, CDLL, c_void_p, POINTER
+from ctypes import c_int, c_int32, c_float, c_size_t, c_uint64, CDLL, c_void_p, POINTER, Structure, sizeof
 import numpy as np
 import os
 import platform
 
+class TenVadSegmenterConfig(Structure):
+    _fields_ = [
+        ("start_threshold", c_float),
+        ("end_threshold", c_float),
+        ("min_speech_frames", c_size_t),
+        ("min_silence_frames", c_size_t),
+    ]
+
+class TenVadSegment(Structure):
+    _fields_ = [
+        ("start_sample", c_uint64),
+        ("end_sample", c_uint64),
+        ("max_prob", c_float),
+    ]
+
+# numpy view of an array of TenVadSegment
+SEGMENT_DTYPE = np.dtype({
+    "names": ["start_sample", "end_sample", "max_prob"],
+    "formats": [np.uint64, np.uint64, np.float32],
+    "offsets": [TenVadSegment.start_sample.offset,
+                TenVadSegment.end_sample.offset,
+                TenVadSegment.max_prob.offset],
+    "itemsize": sizeof(TenVadSegment),
+})
+
 class TenVad:
     def __init__(self, hop_size: int = 256, threshold: float = 0.5):
         self.hop_size = hop_size
@@ -136,4 +161,80 @@ class TenVad:
         )
         return self.out_probability.value, self.out_flags.value
 
+    def start_segmenter(self, start_threshold: float = 0.0, end_threshold: float = 0.0,
+                        min_speech_frames: int = 0, min_silence_frames: int = 0):
+        """Start the speech segmenter, see ten_vad_segmenter_start(); 0 picks
+        the default of a parameter."""
+        # bound here, libraries built before the segmenter lack these
+        self.vad_library.ten_vad_segmenter_start.argtypes = [
+            c_void_p,
+            POINTER(TenVadSegmenterConfig),
+        ]
+        self.vad_library.ten_vad_segmenter_start.restype = c_int
 
+        self.vad_library.ten_vad_segment_buffer.argtypes = [
+            c_void_p,
+            c_void_p,
+            c_size_t,
+            c_void_p,
+            c_size_t,
+            POINTER(c_size_t),
+        ]
+        self.vad_library.ten_vad_segment_buffer.restype = c_int
+
+        self.vad_library.ten_vad_segment_flush.argtypes = [
+            c_void_p,
+            c_void_p,
+            POINTER(c_size_t),
+        ]
+        self.vad_library.ten_vad_segment_flush.restype = c_int
+
+        config = TenVadSegmenterConfig(
+            start_threshold, end_threshold, min_speech_frames, min_silence_frames
+        )
+        assert (
+            self.vad_library.ten_vad_segmenter_start(
+                self.vad_handler, POINTER(TenVadSegmenterConfig)(config)
+            )
+            == 0
+        ), "[TEN VAD]: segmenter start failure!"
+
+    def process_segments(self, audio_data: np.ndarray):
+        """Feed a buffer of int16 samples to the segmenter and return the
+        speech segments that ended within it as an array of SEGMENT_DTYPE,
+        see ten_vad_segment_buffer(). Only whole hops are processed, pass the
+        remaining len(audio_data) % hop_size samples again with the next
+        buffer."""
+        audio_data = np.ascontiguousarray(np.squeeze(audio_data))
+        assert (
+            len(audio_data.shape) == 1 and audio_data.dtype == np.int16
+        ), "[TEN VAD]: audio data must be a 1-D int16 array"
+        segments = np.zeros(audio_data.shape[0] // self.hop_size // 2 + 1, dtype=SEGMENT_DTYPE)
+        n_segments = c_size_t()
+        assert (
+            self.vad_library.ten_vad_segment_buffer(
+                self.vad_handler,
+                c_void_p(audio_data.__array_interface__["data"][0]),
+                c_size_t(audio_data.shape[0]),
+                c_void_p(segments.__array_interface__["data"][0]),
+                c_size_t(segments.shape[0]),
+                POINTER(c_size_t)(n_segments),
+            )
+            == 0
+        ), "[TEN VAD]: segment buffer failure!"
+        return segments[: n_segments.value]
+
+    def flush_segments(self):
+        """End the open speech segment, if any, and return it as an array of
+        SEGMENT_DTYPE of 0 or 1 entries, see ten_vad_segment_flush()."""
+        segments = np.zeros(1, dtype=SEGMENT_DTYPE)
+        n_segments = c_size_t()
+        assert (
+            self.vad_library.ten_vad_segment_flush(
+                self.vad_handler,
+                c_void_p(segments.__array_interface__["data"][0]),
+                POINTER(c_size_t)(n_segments),
+            )
+            == 0
+        ), "[TEN VAD]: segment flush failure!"
+        return segments[: n_segments.value]
@@ -34,6 +34,49 @@ export interface TenVADModule {
     outFlagPtr: number
   ): number;
 
+  /**
+   * Start the speech segmenter of a VAD instance, see
+   * ten_vad_segmenter_start() in ten_vad.h
+   * @param handle Valid VAD handle from ten_vad_create
+   * @param configPtr Pointer to a ten_vad_segmenter_config_t
+   * (start_threshold f32, end_threshold f32, min_speech_frames u32,
+   * min_silence_frames u32), 0 for the defaults
+   * @returns 0 on success, -1 on error
+   */
+  _ten_vad_segmenter_start(handle: number, configPtr: number): number;
+
+  /**
+   * Feed a buffer of audio to the segmenter and receive the speech segments
+   * that ended within it, see ten_vad_segment_buffer() in ten_vad.h
+   * @param handle VAD handle with a started segmenter
+   * @param pcmPtr Pointer to int16 audio samples array
+   * @param length Number of samples, only whole hops are processed
+   * @param segmentsPtr Pointer to maxSegments ten_vad_segment_t of 24 bytes
+   * (start_sample u64, end_sample u64, max_prob f32, padding)
+   * @param maxSegments Size of segmentsPtr, length / hopSize / 2 + 1
+   * always suffices
+   * @param nSegmentsPtr Pointer to a u32 receiving the number of segments
+   * @returns 0 on success, -1 on error
+   */
+  _ten_vad_segment_buffer(
+    handle: number,
+    pcmPtr: number,
+    length: number,
+    segmentsPtr: number,
+    maxSegments: number,
+    nSegmentsPtr: number
+  ): number;
+
+  /**
+   * End the open speech segment, if any, see ten_vad_segment_flush() in
+   * ten_vad.h
+   * @param handle VAD handle with a started segmenter
+   * @param segmentPtr Pointer to one ten_vad_segment_t
+   * @param nSegmentsPtr Pointer to a u32 receiving 1 if a segment was open
+   * @returns 0 on success, -1 on error
+   */
+  _ten_vad_segment_flush(handle: number, segmentPtr: number, nSegmentsPtr: number): number;
+
   /**
    * Destroy VAD instance and release resources
    * @param handlePtr Pointer to the VAD handle
@@ -67,6 +110,16 @@ export interface TenVADModule {
   stringToUTF8(str: string, outPtr: number, maxBytesToWrite: number): void;
 }
 
+/**
+ * Speech segment of the segmenter, in samples since the VAD instance was
+ * created or its segmenter started
+ */
+export interface TenVADSegment {
+  startSample: number;
+  endSample: number;
+  maxProb: number;
+}
+
 /**
  * High-level TypeScript wrapper for TEN VAD
  */
@@ -87,6 +140,29 @@ export class TenVAD {
     isVoice: boolean;
   } | null;
 
+  /**
+   * Start the speech segmenter, 0 or an omitted field picks its default
+   */
+  startSegmenter(config?: {
+    startThreshold?: number;
+    endThreshold?: number;
+    minSpeechFrames?: number;
+    minSilenceFrames?: number;
+  }): boolean;
+
+  /**
+   * Feed audio samples to the segmenter
+   * @param audioData Int16Array of audio samples, only whole hops are
+   * processed
+   * @returns The speech segments that ended within audioData, in samples
+   */
+  processSegments(audioData: Int16Array): TenVADSegment[] | null;
+
+  /**
+   * End the open speech segment, if any
+   */
+  flushSegments(): TenVADSegment | null;
+
   /**
    * Get library version
    */
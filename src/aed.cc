@@ -7,10 +7,18 @@
 #include <string.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <vector>
 #include <math.h>
 #include "aed.h"
 #include "aed_st.h"
+#include "aivad_net.h"
 #include "coeff.h"
+#include "fftw.h"
+#include "fscvrt.h"
 #include "pitch_est.h"
 #include "stft.h"
 #include <assert.h>
@@ -19,38 +27,225 @@
 #define AUP_AED_MAX(x, y) (((x) > (y)) ? (x) : (y))
 #define AUP_AED_MIN(x, y) (((x) > (y)) ? (y) : (x))
 #define AUP_AED_EPS (1e-20f)
+#define AUP_AED_PI (3.14159265358979323846)
+
+// the internal analysis always runs at this configuration, which the
+// intXxx / feaSz / melFbSz fields of Aed_St are set to; the per-frame code
+// uses the constants, so that trip counts are known when compiling
+#define AUP_AED_INT_HOPSZ (AUP_AED_ASSUMED_HOPSZ)
+#define AUP_AED_INT_FFTSZ (AUP_AED_ASSUMED_FFTSZ)
+#define AUP_AED_INT_NBINS ((AUP_AED_ASSUMED_FFTSZ >> 1) + 1)
+
+// stage timers, see AUP_Aed_statsAdd: TIC starts timer t, TOC turns it into
+// the elapsed ns; all of them vanish with AUP_AED_STATS 0
+#if AUP_AED_STATS
+#define AUP_AED_TIC(t) uint64_t t = AUP_Aed_nowNs()
+#define AUP_AED_TOC(t) t = AUP_Aed_nowNs() - t
+#define AUP_AED_STATS_ADD(stHdl, stage, ns, num) \
+  AUP_Aed_statsAdd((stHdl), (stage), (ns), (num))
+#define AUP_AED_STATS_FRM(idx, num) AUP_Aed_statsFrm((idx), (num))
+#else
+#define AUP_AED_TIC(t)
+#define AUP_AED_TOC(t)
+#define AUP_AED_STATS_ADD(stHdl, stage, ns, num)
+#define AUP_AED_STATS_FRM(idx, num)
+#endif
+// process-wide frame counters of the aggregate, see AUP_Aed_statsFrm
+#define AUP_AED_STATS_FRM_PROC (0)
+#define AUP_AED_STATS_FRM_GATED (1)
+#define AUP_AED_STATS_FRM_INFER (2)
 
 /// ///////////////////////////////////////////////////////////////////////
 /// Internal Utils
 /// ///////////////////////////////////////////////////////////////////////
 
-AUP_MODULE_AIVAD::AUP_MODULE_AIVAD(char* onnx_path) {
-  ort_api = OrtGetApiBase()->GetApi(ORT_API_VERSION);
-  OrtStatus* status =
-      ort_api->CreateEnv(ORT_LOGGING_LEVEL_WARNING, "TEN-VAD", &ort_env);
-  if (status) {
-    printf("Failed to create env: %s\n", ort_api->GetErrorMessage(status));
-    ort_api->ReleaseStatus(status);
-    ort_api->ReleaseEnv(ort_env);
-    ort_env = NULL;
+#if AUP_AED_STATS
+// process-wide aggregate of the stage records of all handlers, updated with
+// relaxed atomics next to the per-handler records
+struct Aed_GlobalStageStats {
+  std::atomic<uint64_t> cnt{0};
+  std::atomic<uint64_t> sumNs{0};
+  std::atomic<uint64_t> minNs{UINT64_MAX};
+  std::atomic<uint64_t> maxNs{0};
+  std::atomic<uint32_t> hist[AUP_AED_STATS_NBUCKETS] = {};
+};
+static Aed_GlobalStageStats aedGlobalStats[AUP_AED_STAGE_NUM];
+static std::atomic<uint64_t> aedGlobalFrmNum[3] = {};  // AUP_AED_STATS_FRM_xx
+
+static uint64_t AUP_Aed_nowNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// bucket AUP_AED_STATS_LIN_BUCKETS + 4 * (e - 4) + m of the values in
+// [(4 + m) << (e - 2), (5 + m) << (e - 2)), e = floor(log2(ns)) >= 4
+static int AUP_Aed_statsBucket(uint64_t ns) {
+  int e = 4;
+  if (ns < AUP_AED_STATS_LIN_BUCKETS) {
+    return (int)ns;
+  }
+  while ((ns >> (e + 1)) != 0) {
+    e++;
+  }
+  return AUP_AED_MIN(AUP_AED_STATS_LIN_BUCKETS + 4 * (e - 4) +
+                         (int)((ns >> (e - 2)) & 3),
+                     AUP_AED_STATS_NBUCKETS - 1);
+}
+
+// largest value of bucket idx
+static uint64_t AUP_Aed_statsBucketTop(int idx) {
+  int e, m;
+  if (idx < AUP_AED_STATS_LIN_BUCKETS) {
+    return (uint64_t)idx;
+  }
+  e = 4 + (idx - AUP_AED_STATS_LIN_BUCKETS) / 4;
+  m = (idx - AUP_AED_STATS_LIN_BUCKETS) % 4;
+  return ((uint64_t)(5 + m) << (e - 2)) - 1;
+}
+
+// record num runs of a stage taking ns in total, i.e. ns / num each
+static void AUP_Aed_statsAdd(Aed_St* stHdl, int stage, uint64_t ns,
+                             uint64_t num) {
+  Aed_StageStats* rec = &stHdl->stageStats[stage];
+  Aed_GlobalStageStats* glb = &aedGlobalStats[stage];
+  uint64_t each, cur;
+  int idx;
+
+  if (num == 0) {
+    return;
+  }
+  each = ns / num;
+  idx = AUP_Aed_statsBucket(each);
+
+  rec->cnt += num;
+  rec->sumNs += ns;
+  rec->minNs = AUP_AED_MIN(rec->minNs, each);
+  rec->maxNs = AUP_AED_MAX(rec->maxNs, each);
+  rec->hist[idx] += (uint32_t)num;
+
+  glb->cnt.fetch_add(num, std::memory_order_relaxed);
+  glb->sumNs.fetch_add(ns, std::memory_order_relaxed);
+  glb->hist[idx].fetch_add((uint32_t)num, std::memory_order_relaxed);
+  cur = glb->minNs.load(std::memory_order_relaxed);
+  while (each < cur && !glb->minNs.compare_exchange_weak(
+                           cur, each, std::memory_order_relaxed)) {
+  }
+  cur = glb->maxNs.load(std::memory_order_relaxed);
+  while (each > cur && !glb->maxNs.compare_exchange_weak(
+                           cur, each, std::memory_order_relaxed)) {
+  }
+}
+
+static void AUP_Aed_statsFrm(int idx, uint64_t num) {
+  aedGlobalFrmNum[idx].fetch_add(num, std::memory_order_relaxed);
+}
+
+static void AUP_Aed_statsReset(Aed_St* stHdl) {
+  memset(stHdl->stageStats, 0, sizeof(stHdl->stageStats));
+  for (int stage = 0; stage < AUP_AED_STAGE_NUM; stage++) {
+    stHdl->stageStats[stage].minNs = UINT64_MAX;
+  }
+}
+
+static void AUP_Aed_statsSummary(const Aed_StageStats* rec,
+                                 Aed_StageTiming* out) {
+  uint64_t rank, acc = 0;
+  int idx;
+
+  memset(out, 0, sizeof(Aed_StageTiming));
+  if (rec->cnt == 0) {
     return;
   }
+  out->cnt = rec->cnt;
+  out->minNs = rec->minNs;
+  out->avgNs = rec->sumNs / rec->cnt;
+  out->maxNs = rec->maxNs;
+  rank = rec->cnt - rec->cnt / 100;  // ceil(0.99 * cnt)
+  for (idx = 0; idx < AUP_AED_STATS_NBUCKETS - 1; idx++) {
+    acc += rec->hist[idx];
+    if (acc >= rank) {
+      break;
+    }
+  }
+  out->p99Ns = AUP_AED_MIN(AUP_Aed_statsBucketTop(idx), rec->maxNs);
+}
+#endif
+
+#if !AUP_AED_NATIVE_AIVAD
+// process-wide registry of loaded models, guarded by aivadModelMutex
+static std::mutex aivadModelMutex;
+static AUP_AIVAD_MODEL* aivadModelList = NULL;
+static OrtEnv* aivadOrtEnv = NULL;  // shared by all models in the registry
+
+AUP_AIVAD_MODEL::AUP_AIVAD_MODEL(const char* onnx_path, const void* model_data,
+                                 size_t model_data_len) {
+  ort_api = OrtGetApiBase()->GetApi(ORT_API_VERSION);
+  if (model_data != NULL) {
+    this->model_data = model_data;
+    this->model_data_len = model_data_len;
+  } else {
+    strncpy(model_path, onnx_path, sizeof(model_path) - 1);
+  }
+}
+
+AUP_AIVAD_MODEL::~AUP_AIVAD_MODEL() {
+  if (memory_info) {
+    ort_api->ReleaseMemoryInfo(memory_info);
+  }
+  if (ort_session) {
+    ort_api->ReleaseSession(ort_session);
+  }
+}
+
+// called with aivadModelMutex held
+int AUP_AIVAD_MODEL::Load() {
+  OrtStatus* status;
+  if (aivadOrtEnv == NULL) {
+    // one set of global thread pools for all sessions, single threaded since
+    // the parallelism is across streams (e.g. ten_vad_engine workers)
+    OrtThreadingOptions* tp_options = NULL;
+    status = ort_api->CreateThreadingOptions(&tp_options);
+    if (status == NULL) {
+      ort_api->SetGlobalIntraOpNumThreads(tp_options, 1);
+      ort_api->SetGlobalInterOpNumThreads(tp_options, 1);
+      ort_api->SetGlobalSpinControl(tp_options, 0);
+      status = ort_api->CreateEnvWithGlobalThreadPools(
+          ORT_LOGGING_LEVEL_WARNING, "TEN-VAD", tp_options, &aivadOrtEnv);
+      ort_api->ReleaseThreadingOptions(tp_options);
+    }
+    if (status) {
+      printf("Failed to create env: %s\n", ort_api->GetErrorMessage(status));
+      ort_api->ReleaseStatus(status);
+      aivadOrtEnv = NULL;
+      return -1;
+    }
+  }
 
   OrtSessionOptions* session_options;
   ort_api->CreateSessionOptions(&session_options);
-  ort_api->SetIntraOpNumThreads(session_options, 1);
-  status =
-      ort_api->CreateSession(ort_env, onnx_path, session_options, &ort_session);
+  ort_api->DisablePerSessionThreads(session_options);
+  if (model_data != NULL) {
+    // lets ORT-format models run directly from the caller's buffer
+    ort_api->AddSessionConfigEntry(session_options,
+                                   "session.use_ort_model_bytes_directly", "1");
+    status = ort_api->CreateSessionFromArray(aivadOrtEnv, model_data,
+                                             model_data_len, session_options,
+                                             &ort_session);
+  } else {
+    status = ort_api->CreateSession(aivadOrtEnv, model_path, session_options,
+                                    &ort_session);
+  }
   ort_api->ReleaseSessionOptions(session_options);
   if (status) {
     printf("Failed to create ort_session: %s\n",
            ort_api->GetErrorMessage(status));
     ort_api->ReleaseStatus(status);
-    ort_api->ReleaseEnv(ort_env);
-    ort_env = NULL;
-    return;
+    ort_session = NULL;
+    return -1;
   }
 
+  OrtAllocator* ort_allocator = NULL;
   ort_api->GetAllocatorWithDefaultOptions(&ort_allocator);
   size_t num_inputs;
   ort_api->SessionGetInputCount(ort_session, &num_inputs);
@@ -74,24 +269,100 @@ AUP_MODULE_AIVAD::AUP_MODULE_AIVAD(char* onnx_path) {
     ort_api->AllocatorFree(ort_allocator, output_name);
   }
 
-  OrtMemoryInfo* memory_info;
   status = ort_api->CreateCpuMemoryInfo(OrtDeviceAllocator, OrtMemTypeDefault,
                                         &memory_info);
   if (status != NULL) {
     printf("Failed to create memory info: %s\n",
            ort_api->GetErrorMessage(status));
     ort_api->ReleaseStatus(status);
-    ort_api->ReleaseSession(ort_session);
-    ort_api->ReleaseEnv(ort_env);
-    ort_session = NULL;
-    ort_env = NULL;
+    memory_info = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+AUP_AIVAD_MODEL* AUP_AIVAD_MODEL::Acquire(const char* onnx_path,
+                                          const void* model_data,
+                                          size_t model_data_len) {
+  if (model_data == NULL && onnx_path == NULL) {
+    return NULL;
+  }
+  if (model_data == NULL && strlen(onnx_path) >= AUP_AED_MODEL_PATH_LENGTH) {
+    printf("Model path too long: %s\n", onnx_path);
+    return NULL;
+  }
+
+  std::lock_guard<std::mutex> lock(aivadModelMutex);
+  AUP_AIVAD_MODEL* model;
+  for (model = aivadModelList; model != NULL; model = model->next) {
+    if (model_data != NULL
+            ? (model->model_data == model_data &&
+               model->model_data_len == model_data_len)
+            : (model->model_data == NULL &&
+               strcmp(model->model_path, onnx_path) == 0)) {
+      model->ref_cnt++;
+      return model;
+    }
+  }
+
+  model = new AUP_AIVAD_MODEL(onnx_path, model_data, model_data_len);
+  if (model->Load() != 0) {
+    delete model;
+    if (aivadModelList == NULL && aivadOrtEnv != NULL) {
+      OrtGetApiBase()->GetApi(ORT_API_VERSION)->ReleaseEnv(aivadOrtEnv);
+      aivadOrtEnv = NULL;
+    }
+    return NULL;
+  }
+  model->ref_cnt = 1;
+  model->next = aivadModelList;
+  aivadModelList = model;
+  return model;
+}
+
+void AUP_AIVAD_MODEL::Release(AUP_AIVAD_MODEL* model) {
+  if (model == NULL) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(aivadModelMutex);
+  if (--model->ref_cnt > 0) {
+    return;
+  }
+
+  AUP_AIVAD_MODEL** link = &aivadModelList;
+  while (*link != NULL && *link != model) {
+    link = &(*link)->next;
+  }
+  if (*link != NULL) {
+    *link = model->next;
+  }
+  const OrtApi* api = model->ort_api;
+  delete model;
+  if (aivadModelList == NULL && aivadOrtEnv != NULL) {
+    api->ReleaseEnv(aivadOrtEnv);
+    aivadOrtEnv = NULL;
+  }
+}
+
+AUP_MODULE_AIVAD::AUP_MODULE_AIVAD(const char* onnx_path,
+                                   const void* model_data,
+                                   size_t model_data_len, int precision) {
+  if (precision != AUP_AED_MODEL_FP32) {
+    return;
+  }
+  model = AUP_AIVAD_MODEL::Acquire(onnx_path, model_data, model_data_len);
+  if (model == NULL) {
     return;
   }
+  ort_api = model->ort_api;
+
+  OrtStatus* status;
   int64_t input_shapes0[] = {1, AUP_AED_CONTEXT_WINDOW_LEN, AUP_AED_FEA_LEN};
   int64_t input_shapes1234[] = {1, AUP_AED_MODEL_HIDDEN_DIM};
-  for (int i = 0; i < num_inputs; i++) {
+  for (int i = 0; i < AUP_AED_MODEL_IO_NUM; i++) {
     status = ort_api->CreateTensorWithDataAsOrtValue(
-        memory_info, i == 0 ? input_data_buf_0 : input_data_buf_1234[i - 1],
+        model->memory_info,
+        i == 0 ? input_data_buf_0 : input_data_buf_1234[i - 1],
         i == 0 ? sizeof(input_data_buf_0) : sizeof(input_data_buf_1234[i - 1]),
         i == 0 ? input_shapes0 : input_shapes1234,
         i == 0 ? sizeof(input_shapes0) / sizeof(input_shapes0[0])
@@ -101,19 +372,20 @@ AUP_MODULE_AIVAD::AUP_MODULE_AIVAD(char* onnx_path) {
       printf("Failed to create input tensor %d: %s\n", i,
              ort_api->GetErrorMessage(status));
       ort_api->ReleaseStatus(status);
-      ort_api->ReleaseSession(ort_session);
-      ort_api->ReleaseEnv(ort_env);
-      ort_session = NULL;
-      ort_env = NULL;
+      ort_input_tensors[i] = NULL;
       return;
     }
   }
 
   int64_t output_shapes0[] = {1, 1, 1};
   int64_t output_shapes1234[] = {1, AUP_AED_MODEL_HIDDEN_DIM};
-  for (int i = 0; i < num_outputs; i++) {
-    status = ort_api->CreateTensorAsOrtValue(
-        ort_allocator, i == 0 ? output_shapes0 : output_shapes1234,
+  for (int i = 0; i < AUP_AED_MODEL_IO_NUM; i++) {
+    status = ort_api->CreateTensorWithDataAsOrtValue(
+        model->memory_info,
+        i == 0 ? output_data_buf_0 : output_data_buf_1234[i - 1],
+        i == 0 ? sizeof(output_data_buf_0)
+               : sizeof(output_data_buf_1234[i - 1]),
+        i == 0 ? output_shapes0 : output_shapes1234,
         i == 0 ? sizeof(output_shapes0) / sizeof(output_shapes0[0])
                : sizeof(output_shapes1234) / sizeof(output_shapes1234[0]),
         ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &ort_output_tensors[i]);
@@ -121,10 +393,7 @@ AUP_MODULE_AIVAD::AUP_MODULE_AIVAD(char* onnx_path) {
       printf("Failed to create output tensor %d: %s\n", i,
              ort_api->GetErrorMessage(status));
       ort_api->ReleaseStatus(status);
-      ort_api->ReleaseSession(ort_session);
-      ort_api->ReleaseEnv(ort_env);
-      ort_session = NULL;
-      ort_env = NULL;
+      ort_output_tensors[i] = NULL;
       return;
     }
   }
@@ -133,18 +402,77 @@ AUP_MODULE_AIVAD::AUP_MODULE_AIVAD(char* onnx_path) {
 
 AUP_MODULE_AIVAD::~AUP_MODULE_AIVAD() {
   for (int i = 0; i < AUP_AED_MODEL_IO_NUM; i++) {
+    if (ort_input_tensors[i]) {
+      ort_api->ReleaseValue(ort_input_tensors[i]);
+    }
     if (ort_output_tensors[i]) {
       ort_api->ReleaseValue(ort_output_tensors[i]);
     }
   }
-  if (ort_session) {
-    ort_api->ReleaseSession(ort_session);
+  AUP_AIVAD_MODEL::Release(model);
+  model = NULL;
+}
+
+int AUP_MODULE_AIVAD::Process(float* input, float* output) {
+  if (!inited) {
+    printf("not inited!\n");
+    return -1;
   }
-  if (ort_env) {
-    ort_api->ReleaseEnv(ort_env);
+
+  memcpy(input_data_buf_0, input, sizeof(input_data_buf_0));
+  if (clear_hidden) {
+    memset(input_data_buf_1234, 0, sizeof(input_data_buf_1234));
+    clear_hidden = 0;
+  }
+  OrtStatus* status = ort_api->Run(
+      model->ort_session, NULL, model->input_names, ort_input_tensors,
+      AUP_AED_MODEL_IO_NUM, model->output_names, AUP_AED_MODEL_IO_NUM,
+      ort_output_tensors);
+  if (status != NULL) {
+    printf("Failed to run model: %s\n", ort_api->GetErrorMessage(status));
+    ort_api->ReleaseStatus(status);
+    return -1;
+  }
+  *output = output_data_buf_0[0];
+  memcpy(input_data_buf_1234, output_data_buf_1234,
+         sizeof(input_data_buf_1234));
+
+  return 0;
+}
+
+int AUP_MODULE_AIVAD::ProcessSeq(float* inputs, int num, float* outputs) {
+  const int feaLen = AUP_AED_CONTEXT_WINDOW_LEN * AUP_AED_FEA_LEN;
+  int i;
+  // the exported graph takes a single context window with the recurrent
+  // state as explicit I/O, so the sequence is one Run per frame
+  for (i = 0; i < num; i++) {
+    if (Process(inputs + i * feaLen, &outputs[i]) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+#else  // AUP_AED_NATIVE_AIVAD
+
+AUP_MODULE_AIVAD::AUP_MODULE_AIVAD(const char* onnx_path,
+                                   const void* model_data,
+                                   size_t model_data_len, int precision) {
+  (void)onnx_path;
+  (void)model_data;
+  (void)model_data_len;
+  if (precision == AUP_AED_MODEL_FP32) {
+    net_precision = AUP_AIVAD_PREC_FP32;
+  } else if (precision == AUP_AED_MODEL_INT8) {
+    net_precision = AUP_AIVAD_PREC_INT8;
+  } else {
+    return;
   }
+  inited = 1;
 }
 
+AUP_MODULE_AIVAD::~AUP_MODULE_AIVAD() {}
+
 int AUP_MODULE_AIVAD::Process(float* input, float* output) {
   if (!inited) {
     printf("not inited!\n");
@@ -156,21 +484,51 @@ int AUP_MODULE_AIVAD::Process(float* input, float* output) {
     memset(input_data_buf_1234, 0, sizeof(input_data_buf_1234));
     clear_hidden = 0;
   }
-  OrtStatus* status = ort_api->Run(
-      ort_session, NULL, input_names, ort_input_tensors, AUP_AED_MODEL_IO_NUM,
-      output_names, AUP_AED_MODEL_IO_NUM, ort_output_tensors);
-  float* output_data;
-  ort_api->GetTensorMutableData(ort_output_tensors[0], (void**)&output_data);
-  *output = output_data[0];
-  for (int i = 1; i < AUP_AED_MODEL_IO_NUM; i++) {
-    ort_api->GetTensorMutableData(ort_output_tensors[i], (void**)&output_data);
-    memcpy(input_data_buf_1234[i - 1], output_data,
-           sizeof(input_data_buf_1234[i - 1]));
+  if (AUP_AivadNet_proc(net_precision, input_data_buf_0,
+                        input_data_buf_1234[0], output_data_buf_1234[0],
+                        output_data_buf_0) != 0) {
+    return -1;
+  }
+  *output = output_data_buf_0[0];
+  memcpy(input_data_buf_1234, output_data_buf_1234,
+         sizeof(input_data_buf_1234));
+
+  return 0;
+}
+
+int AUP_MODULE_AIVAD::ProcessSeq(float* inputs, int num, float* outputs) {
+  if (!inited) {
+    printf("not inited!\n");
+    return -1;
+  }
+
+  if (clear_hidden) {
+    memset(input_data_buf_1234, 0, sizeof(input_data_buf_1234));
+    clear_hidden = 0;
   }
+  // the recurrent state is carried in place from frame to frame
+  return AUP_AivadNet_procSeq(net_precision, inputs, num,
+                              input_data_buf_1234[0], outputs);
+}
 
+int AUP_MODULE_AIVAD::ProcessBatch(AUP_MODULE_AIVAD* const* insts,
+                                   float* const* inputs, float* outputs,
+                                   int num) {
+  int i;
+  if (insts == NULL || inputs == NULL || outputs == NULL || num <= 0) {
+    return -1;
+  }
+  // no per-call dispatch overhead to amortize, run the instances in turn
+  for (i = 0; i < num; i++) {
+    if (insts[i] == NULL || insts[i]->Process(inputs[i], &outputs[i]) != 0) {
+      return -1;
+    }
+  }
   return 0;
 }
 
+#endif  // AUP_AED_NATIVE_AIVAD
+
 int AUP_MODULE_AIVAD::Reset() {
   if (!inited) {
     return -1;
@@ -180,6 +538,148 @@ int AUP_MODULE_AIVAD::Reset() {
   return 0;
 }
 
+void AUP_MODULE_AIVAD::SaveState(float* state) const {
+  if (clear_hidden) {  // the next inference starts from zeros
+    memset(state, 0, StateSize());
+  } else {
+    memcpy(state, input_data_buf_1234, StateSize());
+  }
+}
+
+void AUP_MODULE_AIVAD::LoadState(const float* state) {
+  memcpy(input_data_buf_1234, state, StateSize());
+  clear_hidden = 0;
+}
+
+#if !AUP_AED_NATIVE_AIVAD
+// scratch space of one batched Run, reused across calls of the same thread
+typedef struct AivadBatchBuf_ {
+  std::vector<float> input0;                                // [N][3 * 41]
+  std::vector<float> input1234[AUP_AED_MODEL_IO_NUM - 1];   // [N][64]
+  std::vector<float> output0;                               // [N]
+  std::vector<float> output1234[AUP_AED_MODEL_IO_NUM - 1];  // [N][64]
+} AivadBatchBuf;
+
+int AUP_MODULE_AIVAD::ProcessBatch(AUP_MODULE_AIVAD* const* insts,
+                                   float* const* inputs, float* outputs,
+                                   int num) {
+  static thread_local AivadBatchBuf buf;
+  const size_t feaLen = AUP_AED_CONTEXT_WINDOW_LEN * AUP_AED_FEA_LEN;
+  const size_t hidLen = AUP_AED_MODEL_HIDDEN_DIM;
+  AUP_AIVAD_MODEL* model;
+  OrtValue* inTensors[AUP_AED_MODEL_IO_NUM] = {NULL};
+  OrtValue* outTensors[AUP_AED_MODEL_IO_NUM] = {NULL};
+  OrtStatus* status = NULL;
+  int i, k;
+
+  if (insts == NULL || inputs == NULL || outputs == NULL || num <= 0) {
+    return -1;
+  }
+  for (i = 0; i < num; i++) {
+    if (insts[i] == NULL || !insts[i]->inited) {
+      printf("not inited!\n");
+      return -1;
+    }
+  }
+
+  // a single Run is only possible when every instance shares one model
+  // which has been exported with a dynamic batch dimension
+  model = insts[0]->model;
+  for (i = 1; i < num; i++) {
+    if (insts[i]->model != model) {
+      break;
+    }
+  }
+  if (num == 1 || i < num || !model->batch_supported) {
+    for (i = 0; i < num; i++) {
+      if (insts[i]->Process(inputs[i], &outputs[i]) != 0) {
+        return -1;
+      }
+    }
+    return 0;
+  }
+
+  // stack feature windows and hidden states into [N, ...] tensors
+  buf.input0.resize(num * feaLen);
+  buf.output0.resize(num);
+  for (k = 0; k < AUP_AED_MODEL_IO_NUM - 1; k++) {
+    buf.input1234[k].resize(num * hidLen);
+    buf.output1234[k].resize(num * hidLen);
+  }
+  for (i = 0; i < num; i++) {
+    AUP_MODULE_AIVAD* inst = insts[i];
+    if (inst->clear_hidden) {
+      memset(inst->input_data_buf_1234, 0, sizeof(inst->input_data_buf_1234));
+      inst->clear_hidden = 0;
+    }
+    memcpy(&buf.input0[i * feaLen], inputs[i], sizeof(float) * feaLen);
+    for (k = 0; k < AUP_AED_MODEL_IO_NUM - 1; k++) {
+      memcpy(&buf.input1234[k][i * hidLen], inst->input_data_buf_1234[k],
+             sizeof(float) * hidLen);
+    }
+  }
+
+  const OrtApi* api = model->ort_api;
+  int64_t input_shapes0[] = {num, AUP_AED_CONTEXT_WINDOW_LEN, AUP_AED_FEA_LEN};
+  int64_t output_shapes0[] = {num, 1, 1};
+  int64_t shapes1234[] = {num, AUP_AED_MODEL_HIDDEN_DIM};
+  for (k = 0; k < AUP_AED_MODEL_IO_NUM && status == NULL; k++) {
+    float* inData = k == 0 ? buf.input0.data() : buf.input1234[k - 1].data();
+    float* outData = k == 0 ? buf.output0.data() : buf.output1234[k - 1].data();
+    size_t inLen = k == 0 ? num * feaLen : num * hidLen;
+    size_t outLen = k == 0 ? num : num * hidLen;
+    status = api->CreateTensorWithDataAsOrtValue(
+        model->memory_info, inData, sizeof(float) * inLen,
+        k == 0 ? input_shapes0 : shapes1234, k == 0 ? 3 : 2,
+        ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &inTensors[k]);
+    if (status == NULL) {
+      status = api->CreateTensorWithDataAsOrtValue(
+          model->memory_info, outData, sizeof(float) * outLen,
+          k == 0 ? output_shapes0 : shapes1234, k == 0 ? 3 : 2,
+          ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &outTensors[k]);
+    }
+  }
+  if (status == NULL) {
+    status = api->Run(model->ort_session, NULL, model->input_names, inTensors,
+                      AUP_AED_MODEL_IO_NUM, model->output_names,
+                      AUP_AED_MODEL_IO_NUM, outTensors);
+  }
+  for (k = 0; k < AUP_AED_MODEL_IO_NUM; k++) {
+    if (inTensors[k]) {
+      api->ReleaseValue(inTensors[k]);
+    }
+    if (outTensors[k]) {
+      api->ReleaseValue(outTensors[k]);
+    }
+  }
+  if (status != NULL) {
+    // model without dynamic batch dimension: run each stream on its own
+    printf("Batched run not supported by model, falling back: %s\n",
+           api->GetErrorMessage(status));
+    api->ReleaseStatus(status);
+    model->batch_supported = 0;
+    for (i = 0; i < num; i++) {
+      if (insts[i]->Process(inputs[i], &outputs[i]) != 0) {
+        return -1;
+      }
+    }
+    return 0;
+  }
+
+  // scatter results back to each instance
+  for (i = 0; i < num; i++) {
+    outputs[i] = buf.output0[i];
+    for (k = 0; k < AUP_AED_MODEL_IO_NUM - 1; k++) {
+      memcpy(insts[i]->input_data_buf_1234[k], &buf.output1234[k][i * hidLen],
+             sizeof(float) * hidLen);
+    }
+  }
+
+  return 0;
+}
+
+#endif  // !AUP_AED_NATIVE_AIVAD
+
 static int AUP_Aed_checkStatCfg(Aed_StaticCfg* pCfg) {
   if (pCfg == NULL) {
     return -1;
@@ -189,12 +689,46 @@ static int AUP_Aed_checkStatCfg(Aed_StaticCfg* pCfg) {
   return -1;
 #endif
 
-  if (pCfg->hopSz < 32) {
+  if (pCfg->inputFs == 0) {
+    pCfg->inputFs = AUP_AED_FS;
+  }
+  if (pCfg->inputFs != 8000 && pCfg->inputFs != 16000 &&
+      pCfg->inputFs != 24000 && pCfg->inputFs != 32000 &&
+      pCfg->inputFs != 48000) {
+    return -1;
+  }
+  // every hop has to be resampled into a whole number of samples
+  if ((pCfg->hopSz * AUP_AED_FS) % pCfg->inputFs != 0) {
+    return -1;
+  }
+  if (pCfg->inputFs != AUP_AED_FS && pCfg->frqInputAvailableFlag != 0) {
+    return -1;
+  }
+
+  if (pCfg->hopSz * AUP_AED_FS / pCfg->inputFs < 32) {
+    return -1;
+  }
+
+  if (pCfg->modelData != NULL && pCfg->modelDataLen == 0) {
+    return -1;
+  }
+  if (pCfg->fastMath != 0 && pCfg->fastMath != 1) {
+    return -1;
+  }
+#if AUP_AED_NATIVE_AIVAD
+  if (pCfg->modelPrecision != AUP_AED_MODEL_FP32 &&
+      pCfg->modelPrecision != AUP_AED_MODEL_INT8) {
+    return -1;
+  }
+#else
+  if (pCfg->modelPrecision != AUP_AED_MODEL_FP32) {
     return -1;
   }
+#endif
 
   if (pCfg->frqInputAvailableFlag == 1) {
-    if (pCfg->fftSz < 128 || pCfg->fftSz < pCfg->hopSz) {
+    if (pCfg->fftSz < 128 || pCfg->fftSz < pCfg->hopSz ||
+        pCfg->fftSz > AUP_AED_MAX_FFT_SZ) {
       return -1;
     }
     if (pCfg->anaWindowSz > pCfg->fftSz || pCfg->anaWindowSz < pCfg->hopSz) {
@@ -221,7 +755,7 @@ static int AUP_Aed_publishStaticCfg(Aed_St* stHdl) {
     stHdl->extNBins = (stHdl->extFftSz >> 1) + 1;
     stHdl->extWinSz = pStatCfg->anaWindowSz;
   }
-  stHdl->extHopSz = pStatCfg->hopSz;
+  stHdl->extHopSz = pStatCfg->hopSz * AUP_AED_FS / pStatCfg->inputFs;
 
   stHdl->intFftSz = AUP_AED_ASSUMED_FFTSZ;
   stHdl->intHopSz = AUP_AED_ASSUMED_HOPSZ;
@@ -244,12 +778,11 @@ static int AUP_Aed_publishStaticCfg(Aed_St* stHdl) {
         1;  // use external spectrum with interpolation / exterpolation
   }
   stHdl->inputTimeFIFOLen = stHdl->extHopSz + stHdl->intHopSz;
+  stHdl->inputTimeFIFOCap = stHdl->inputTimeFIFOLen * 2;
 
-  // for aiaed release2.0.0, pre-emphasis for input time-signal is needed,
-  // therefore, we need redo analysis based on input time signal preprocessed by
-  // pre-emphasis.
-  stHdl->intAnalyFlag =
-      2;  // internally redo analysis based on input time signal
+  // for aiaed release2.0.0, pre-emphasis for input time-signal is needed; the
+  // internal analysis runs on the pre-emphasized time signal, external
+  // spectra get it as a spectral tilt, see AUP_Aed_getEmphTilt
 
   stHdl->feaSz = (size_t)AUP_AED_FEA_LEN;
   stHdl->melFbSz = (size_t)AUP_AED_MEL_FILTER_BANK_NUM;
@@ -270,6 +803,12 @@ static int AUP_Aed_publishDynamCfg(Aed_St* stHdl) {
   pDynmCfg = (const Aed_DynamCfg*)(&(stHdl->dynamCfg));
   stHdl->aivadResetFrmNum = pDynmCfg->resetFrameNum;
   stHdl->voiceDecideThresh = pDynmCfg->extVoiceThr;
+  stHdl->energyThresh = pDynmCfg->extEnergyThr;
+  stHdl->energyGateFlag = pDynmCfg->energyGateFlag;
+  stHdl->energyGateHangFrm = pDynmCfg->energyGateHangFrm;
+  stHdl->infStride = AUP_AED_MAX(pDynmCfg->infStride, (size_t)1);
+  stHdl->infStrideMargin = pDynmCfg->infStrideMargin;
+  stHdl->lazyPitchFlag = pDynmCfg->lazyPitchFlag;
 
   if (stHdl->pitchEstStPtr != NULL) {
     peDynmCfg.voicedThr = pDynmCfg->pitchEstVoicedThr;
@@ -279,92 +818,174 @@ static int AUP_Aed_publishDynamCfg(Aed_St* stHdl) {
   return 0;
 }
 
-static int AUP_Aed_resetVariables(Aed_St* stHdl) {
-  if (stHdl == NULL) {
-    return -1;
-  }
-
-  // first clear all the dynamic memory, all the dynamic variables which are
-  // not listed bellow are cleared to 0 by this step
-  memset(stHdl->dynamMemPtr, 0, stHdl->dynamMemSize);
-
-  float* melFbCoef = stHdl->melFilterBankCoef;
-  size_t* melBinBuff = stHdl->melFilterBinBuff;
+// generate the banded mel filter-bank coefficients for fftSz
+static int AUP_Aed_buildMelFilterBank(size_t fftSz, size_t melFbSz,
+                                      Aed_MelFilterBank* melFb) {
+  size_t melBinBuff[AUP_AED_MEL_FILTER_BANK_NUM + 2];
   size_t i, j;
-  size_t nBins = stHdl->intNBins;
-  size_t melFbSz = stHdl->melFbSz;
-
-  stHdl->aedProcFrmCnt = 0;
-  stHdl->inputTimeFIFOIdx = 0;
-  stHdl->aivadResetCnt = 0;
-  stHdl->timeSignalPre = 0.0f;
-  stHdl->aivadScore =
-      -1.0f;  // as default value, labeling as aed is not working yet
-  stHdl->aivadScorePre = -1.0f;
+  size_t offset = 0;
+  float* coef = NULL;
 
-  stHdl->pitchFreq = 0.0f;
+  if (fftSz > AUP_AED_MEL_MAX_FFTSZ || melFbSz > AUP_AED_MEL_FILTER_BANK_NUM) {
+    return -1;
+  }
 
-  // generate mel filter-bank coefficients
   float low_mel = 2595.0f * log10f(1.0f + 0.0f / 700.0f);
   float high_mel = 2595.0f * log10f(1.0f + 8000.0f / 700.0f);
   float mel_points = 0.0f;
   float hz_points = 0.0f;
-  size_t idx = 0;
 
   for (i = 0; i < melFbSz + 2; i++) {
     mel_points = i * (high_mel - low_mel) / ((float)melFbSz + 1.0f) + low_mel;
     hz_points = 700.0f * (powf(10.0f, mel_points / 2595.0f) - 1.0f);
-    melBinBuff[i] =
-        (size_t)((stHdl->intFftSz + 1.0f) * hz_points / (float)AUP_AED_FS);
+    melBinBuff[i] = (size_t)((fftSz + 1.0f) * hz_points / (float)AUP_AED_FS);
     if (i > 0 && melBinBuff[i] == melBinBuff[i - 1]) {
       return -1;
     }
   }
 
   for (j = 0; j < melFbSz; j++) {
+    melFb->bandStart[j] = melBinBuff[j];
+    melFb->bandLen[j] = melBinBuff[j + 2] - melBinBuff[j];
+    melFb->bandOffset[j] = offset;
+    if (offset + melFb->bandLen[j] > AUP_AED_MEL_MAX_COEF_NUM) {
+      return -1;
+    }
+    coef = melFb->coef + offset - melBinBuff[j];
     for (i = melBinBuff[j]; i < melBinBuff[j + 1]; i++) {
-      idx = j * nBins + i;
-      melFbCoef[idx] = (float)(i - melBinBuff[j]) /
-                       (float)(melBinBuff[j + 1] - melBinBuff[j]);
+      coef[i] = (float)(i - melBinBuff[j]) /
+                (float)(melBinBuff[j + 1] - melBinBuff[j]);
     }
     for (i = melBinBuff[j + 1]; i < melBinBuff[j + 2]; i++) {
-      idx = j * nBins + i;
-      melFbCoef[idx] = (float)(melBinBuff[j + 2] - i) /
-                       (float)(melBinBuff[j + 2] - melBinBuff[j + 1]);
+      coef[i] = (float)(melBinBuff[j + 2] - i) /
+                (float)(melBinBuff[j + 2] - melBinBuff[j + 1]);
     }
+    offset += melFb->bandLen[j];
   }
+  melFb->fftSz = fftSz;
+  melFb->melFbSz = melFbSz;
 
-  if (stHdl->pitchEstStPtr != NULL) {
-    if (AUP_PE_init(stHdl->pitchEstStPtr) < 0) {
-      return -1;
-    }
-  }
+  return 0;
+}
 
-  if (stHdl->aivadInf != NULL) {
-    stHdl->aivadInf->Reset();
-  }
+// the internal FFT size is fixed, so a single table built on first use is
+// shared read-only by all handlers
+static const Aed_MelFilterBank* AUP_Aed_getMelFilterBank(size_t fftSz,
+                                                         size_t melFbSz) {
+  static Aed_MelFilterBank melFb;
+  static const int melFbRet = AUP_Aed_buildMelFilterBank(
+      AUP_AED_ASSUMED_FFTSZ, AUP_AED_MEL_FILTER_BANK_NUM, &melFb);
 
-  if (stHdl->timeInAnalysis != NULL) {
-    if (AUP_Analyzer_init(stHdl->timeInAnalysis) < 0) {
-      return -1;
-    }
+  if (melFbRet < 0 || fftSz != melFb.fftSz || melFbSz != melFb.melFbSz) {
+    return NULL;
   }
+  return &melFb;
+}
 
-  return 0;
+static const float* AUP_Aed_buildEmphTilt(size_t fftSz, float* tilt) {
+  const double coef = (double)AUP_AED_PRE_EMPH_COEF;
+  size_t nBins = (fftSz >> 1) + 1;
+  for (size_t idx = 0; idx < nBins; idx++) {
+    tilt[idx] = (float)(1.0 + coef * coef -
+                        2.0 * coef * cos(2.0 * AUP_AED_PI * idx / fftSz));
+  }
+  return tilt;
 }
 
-static int AUP_Aed_addOneCnter(int cnter) {
-  cnter++;
-  if (cnter >= 1000000000) {
-    cnter = 0;  // reset every half year
+// pre-emphasis as a spectral tilt |1 - a * e^(-jw)|^2 over the internal bins,
+// applied to external spectra, which are without it; built on first use and
+// shared read-only as the mel filter-bank
+static const float* AUP_Aed_getEmphTilt(size_t nBins) {
+  static float tilt[(AUP_AED_ASSUMED_FFTSZ >> 1) + 1];
+  static const float* tiltPtr =
+      AUP_Aed_buildEmphTilt(AUP_AED_ASSUMED_FFTSZ, tilt);
+
+  if (nBins != (AUP_AED_ASSUMED_FFTSZ >> 1) + 1) {
+    return NULL;
   }
-  return (cnter);
+  return tiltPtr;
 }
 
-static void AUP_Aed_binPowerConvert(const float* src, float* tgt, int srcNBins,
-                                    int tgtNBins) {
-  float rate;
-  int srcIdx, tgtIdx;
+// clear the signal state only, the constant tables (mel filter-bank, window,
+// pitch-estimator DCT table) are set up once in memAllocate and kept
+static int AUP_Aed_resetVariables(Aed_St* stHdl) {
+  if (stHdl == NULL) {
+    return -1;
+  }
+
+  // first clear all the dynamic memory, all the dynamic variables which are
+  // not listed bellow are cleared to 0 by this step; the arena only holds
+  // signal state and scratch buffers
+  memset(stHdl->dynamMemPtr, 0, stHdl->dynamMemSize);
+
+  stHdl->aedProcFrmCnt = 0;
+  stHdl->inputTimeFIFOIdx = 0;
+  stHdl->inputTimeFIFORdIdx = 0;
+  stHdl->chunkFill = 0;
+  stHdl->chunkEnergy = 0.0f;
+  stHdl->frameRmsBuffIdx = 0;
+  stHdl->aivadInputFeatIdx = 0;
+  stHdl->aivadInputFeat = stHdl->aivadInputFeatStack;
+  stHdl->aivadResetCnt = 0;
+  stHdl->timeSignalPre = 0.0f;
+  stHdl->aivadScore =
+      -1.0f;  // as default value, labeling as aed is not working yet
+  stHdl->aivadScorePre = -1.0f;
+
+  stHdl->gateQuietFrmCnt = 0;
+  stHdl->frmGated = 0;
+  stHdl->pitchEstStale = 0;
+  stHdl->lazyPitchHangCnt = 0;
+  stHdl->infStrideCnt = 0;
+  stHdl->frmSkipInf = 0;
+  stHdl->frmLanesDone = 0;
+  stHdl->frmLanesMelNs = 0;
+  stHdl->procFrmNum = 0;
+  stHdl->gatedFrmNum = 0;
+  stHdl->inferFrmNum = 0;
+#if AUP_AED_STATS
+  AUP_Aed_statsReset(stHdl);
+#endif
+
+  stHdl->pitchFreq = 0.0f;
+
+  if (stHdl->pitchEstStPtr != NULL) {
+    if (AUP_PE_init(stHdl->pitchEstStPtr) < 0) {
+      return -1;
+    }
+  }
+
+  if (stHdl->aivadInf != NULL) {
+    stHdl->aivadInf->Reset();
+  }
+
+  if (stHdl->timeInAnalysis != NULL) {
+    if (AUP_Analyzer_init(stHdl->timeInAnalysis) < 0) {
+      return -1;
+    }
+  }
+
+  if (stHdl->stCfg.inputFs != AUP_AED_FS && stHdl->fsCvrtStPtr != NULL) {
+    if (AUP_Fscvrt_init(stHdl->fsCvrtStPtr) < 0) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int AUP_Aed_addOneCnter(int cnter) {
+  cnter++;
+  if (cnter >= 1000000000) {
+    cnter = 0;  // reset every half year
+  }
+  return (cnter);
+}
+
+static void AUP_Aed_binPowerConvert(const float* src, float* tgt, int srcNBins,
+                                    int tgtNBins) {
+  float rate;
+  int srcIdx, tgtIdx;
   if (srcNBins == tgtNBins) {
     memcpy(tgt, src, sizeof(float) * tgtNBins);
     return;
@@ -382,26 +1003,6 @@ static void AUP_Aed_binPowerConvert(const float* src, float* tgt, int srcNBins,
   return;
 }
 
-static void AUP_Aed_CalcBinPow(int nBins, const float* cmplxSpctr,
-                               float* binPow) {
-  int idx, realIdx, imagIdx;
-
-  // bin-0
-  binPow[0] = cmplxSpctr[0] * cmplxSpctr[0];
-
-  // bin-(NBins-1)
-  binPow[nBins - 1] = cmplxSpctr[1] * cmplxSpctr[1];
-
-  for (idx = 1; idx < (nBins - 1); idx++) {
-    realIdx = idx << 1;
-    imagIdx = realIdx + 1;
-
-    binPow[idx] = cmplxSpctr[realIdx] * cmplxSpctr[realIdx] +
-                  cmplxSpctr[imagIdx] * cmplxSpctr[imagIdx];
-  }
-  return;
-}
-
 static int AUP_Aed_pitch_proc(void* pitchModule, const float* timeSignal,
                               size_t timeLen, const float* binPow, size_t nBins,
                               PE_OutputData* pOut) {
@@ -416,62 +1017,87 @@ static int AUP_Aed_pitch_proc(void* pitchModule, const float* timeSignal,
   return AUP_PE_proc(pitchModule, &peInData, pOut);
 }
 
-static int AUP_Aed_aivad_proc(Aed_St* stHdl, const float* inBinPow,
-                              float* aivadScore) {
-  if (stHdl == NULL || inBinPow == NULL || aivadScore == NULL) {
+// mel band powers feat[0 .. AUP_AED_MEL_FILTER_BANK_NUM - 1] into normalized
+// log-energy features, in place
+static void AUP_Aed_melNorm(const Aed_St* stHdl, float* feat) {
+  const float powerNormal = 32768.0f * 32768.0f;
+  size_t i;
+
+  for (i = 0; i < AUP_AED_MEL_FILTER_BANK_NUM; i++) {
+    feat[i] = feat[i] / powerNormal + AUP_AED_EPS;
+  }
+  if (stHdl->stCfg.fastMath) {
+    AUP_FFTW_fastLog(feat, AUP_AED_MEL_FILTER_BANK_NUM, feat);
+  } else {
+    for (i = 0; i < AUP_AED_MEL_FILTER_BANK_NUM; i++) {
+      feat[i] = logf(feat[i]);
+    }
+  }
+  for (i = 0; i < AUP_AED_MEL_FILTER_BANK_NUM; i++) {
+    feat[i] = (feat[i] - AUP_AED_FEATURE_MEANS[i]) /
+              (AUP_AED_FEATURE_STDS[i] + AUP_AED_EPS);
+  }
+}
+
+// update the AIVAD input feature stack with the current frame, the mel
+// features are already in place if frmLanesDone
+static int AUP_Aed_aivad_feat(Aed_St* stHdl, const float* inBinPow) {
+  if (stHdl == NULL || inBinPow == NULL) {
     return -1;
   }
 
   size_t i, j;
-  size_t nBins = stHdl->intNBins;
-  size_t melFbSz = stHdl->melFbSz;
-  size_t srcOffset;
-  size_t srcLen;
+  size_t featIdx = (size_t)stHdl->aivadInputFeatIdx;
 
   float* aivadInputFeatStack = stHdl->aivadInputFeatStack;
-  float* melFbCoef = stHdl->melFilterBankCoef;
+  const Aed_MelFilterBank* melFb = stHdl->melFb;
   const float* aivadFeatMean = AUP_AED_FEATURE_MEANS;
   const float* aivadFeatStd = AUP_AED_FEATURE_STDS;
-  float* curMelFbCoefPtr = NULL;
+  const float* curMelFbCoefPtr = NULL;
+  const float* curBinPowPtr = NULL;
+  size_t bandLen;
   float* curInputFeatPtr = NULL;
   float perBandValue = 0.0f;
-  float powerNormal = 32768.0f * 32768.0f;
 
-  // update aivad feature buff.
-  srcOffset = stHdl->feaSz;
-  srcLen = (stHdl->algCtxtSz - 1) * stHdl->feaSz;
-  memmove(aivadInputFeatStack, aivadInputFeatStack + srcOffset,
-          sizeof(float) * srcLen);
-  curInputFeatPtr = aivadInputFeatStack + srcLen;
+  // update aivad feature buff., the new frame replaces the oldest one
+  curInputFeatPtr = aivadInputFeatStack + featIdx * AUP_AED_FEA_LEN;
 
   // cal. mel-filter-bank feature
-  for (i = 0; i < melFbSz; i++) {
-    perBandValue = 0.0f;
-    curMelFbCoefPtr = melFbCoef + i * nBins;
-    for (j = 0; j < nBins; j++) {
-      perBandValue += (inBinPow[j] * curMelFbCoefPtr[j]);
-    }
-    perBandValue = perBandValue / powerNormal;
-    perBandValue = logf(perBandValue + AUP_AED_EPS);
-    curInputFeatPtr[i] =
-        (perBandValue - aivadFeatMean[i]) / (aivadFeatStd[i] + AUP_AED_EPS);
+  if (!stHdl->frmLanesDone) {
+    for (i = 0; i < AUP_AED_MEL_FILTER_BANK_NUM; i++) {
+      perBandValue = 0.0f;
+      curMelFbCoefPtr = melFb->coef + melFb->bandOffset[i];
+      curBinPowPtr = inBinPow + melFb->bandStart[i];
+      bandLen = melFb->bandLen[i];
+      for (j = 0; j < bandLen; j++) {
+        perBandValue += (curBinPowPtr[j] * curMelFbCoefPtr[j]);
+      }
+      curInputFeatPtr[i] = perBandValue;
+    }
+    AUP_Aed_melNorm(stHdl, curInputFeatPtr);
   }
 
   // extra feat.
-  for (i = melFbSz; i < stHdl->feaSz; i++) {
+  for (i = AUP_AED_MEL_FILTER_BANK_NUM; i < AUP_AED_FEA_LEN; i++) {
     curInputFeatPtr[i] =
         (stHdl->pitchFreq - aivadFeatMean[i]) / (aivadFeatStd[i] + AUP_AED_EPS);
   }
 
-  // exe. aivad
-  // exe. aivad
-  float aivadOutput;
-  if (stHdl->aivadInf != NULL &&
-      stHdl->aivadInf->Process(stHdl->aivadInputFeatStack, &aivadOutput) != 0) {
-    return -1;
+  // mirror the frame and advance the window
+  memcpy(curInputFeatPtr + AUP_AED_CONTEXT_WINDOW_LEN * AUP_AED_FEA_LEN,
+         curInputFeatPtr, sizeof(float) * AUP_AED_FEA_LEN);
+  featIdx++;
+  if (featIdx == AUP_AED_CONTEXT_WINDOW_LEN) {
+    featIdx = 0;
   }
+  stHdl->aivadInputFeatIdx = (int)featIdx;
+  stHdl->aivadInputFeat = aivadInputFeatStack + featIdx * AUP_AED_FEA_LEN;
 
-  (*aivadScore) = aivadOutput;
+  return 0;
+}
+
+static int AUP_Aed_aivad_post(Aed_St* stHdl, float aivadScore) {
+  stHdl->aivadScore = aivadScore;
 
   stHdl->aivadResetCnt += 1;
   if (stHdl->aivadResetCnt >= stHdl->aivadResetFrmNum) {
@@ -488,7 +1114,6 @@ static int AUP_Aed_dynamMemPrepare(Aed_St* stHdl, void* memPtrExt,
   if (stHdl == NULL) {
     return -1;
   }
-  size_t pitchInNBins = stHdl->intNBins;
   size_t totalMemSize = 0;
   size_t inputTimeFIFOMemSize = 0;
   size_t inputEmphTimeFIFOMemSize = 0;
@@ -497,8 +1122,6 @@ static int AUP_Aed_dynamMemPrepare(Aed_St* stHdl, void* memPtrExt,
   size_t frameRmsBuffMemSize = 0;
   size_t aivadInputFeatStackMemSize = 0;
   size_t aimdInputFeatStackMemSize = 0;
-  size_t melFilterBankCoefMemSize = 0;
-  size_t melFilterBinBuffMemSize = 0;
   size_t inputFloatBuffMemSize = 0;
 
   // size_t vadScoreOutputBuffDelaySample = 384; // buff. delay for output
@@ -508,11 +1131,11 @@ static int AUP_Aed_dynamMemPrepare(Aed_St* stHdl, void* memPtrExt,
   // size_t spctrmMemSize = AUP_AED_ALIGN8(sizeof(float) * (nBins - 1) * 2);
 
   inputTimeFIFOMemSize =
-      AUP_AED_ALIGN8(sizeof(float) * stHdl->inputTimeFIFOLen);
+      AUP_AED_ALIGN8(sizeof(float) * stHdl->inputTimeFIFOCap);
   totalMemSize += inputTimeFIFOMemSize;
 
   inputEmphTimeFIFOMemSize =
-      AUP_AED_ALIGN8(sizeof(float) * stHdl->inputTimeFIFOLen);
+      AUP_AED_ALIGN8(sizeof(float) * stHdl->inputTimeFIFOCap);
   totalMemSize += inputEmphTimeFIFOMemSize;
 
   aivadInputCmplxSptrmMemSize = AUP_AED_ALIGN8(sizeof(float) * stHdl->intFftSz);
@@ -522,24 +1145,17 @@ static int AUP_Aed_dynamMemPrepare(Aed_St* stHdl, void* memPtrExt,
   totalMemSize += aivadInputBinPowMemSize;
 
   aivadInputFeatStackMemSize =
-      AUP_AED_ALIGN8(sizeof(float) * stHdl->algCtxtSz * stHdl->feaSz);
+      AUP_AED_ALIGN8(sizeof(float) * 2 * stHdl->algCtxtSz * stHdl->feaSz);
   totalMemSize += aivadInputFeatStackMemSize;
 
   aimdInputFeatStackMemSize =
       AUP_AED_ALIGN8(sizeof(float) * stHdl->algCtxtSz * stHdl->feaSz);
   totalMemSize += aimdInputFeatStackMemSize;
 
-  melFilterBankCoefMemSize =
-      AUP_AED_ALIGN8(sizeof(float) * pitchInNBins * stHdl->feaSz);
-  totalMemSize += melFilterBankCoefMemSize;
-
-  melFilterBinBuffMemSize = AUP_AED_ALIGN8(sizeof(size_t) * (stHdl->feaSz + 2));
-  totalMemSize += melFilterBinBuffMemSize;
-
   frameRmsBuffMemSize = AUP_AED_ALIGN8(stHdl->frmRmsBufLen * sizeof(float));
   totalMemSize += frameRmsBuffMemSize;
 
-  inputFloatBuffMemSize = AUP_AED_ALIGN8(stHdl->extHopSz * sizeof(float));
+  inputFloatBuffMemSize = AUP_AED_ALIGN8(stHdl->stCfg.hopSz * sizeof(float));
   totalMemSize += inputFloatBuffMemSize;
 
   if (memPtrExt == NULL) {
@@ -565,14 +1181,9 @@ static int AUP_Aed_dynamMemPrepare(Aed_St* stHdl, void* memPtrExt,
   memPtr += aivadInputBinPowMemSize;
 
   stHdl->aivadInputFeatStack = (float*)memPtr;
+  stHdl->aivadInputFeat = stHdl->aivadInputFeatStack;
   memPtr += aivadInputFeatStackMemSize;
 
-  stHdl->melFilterBankCoef = (float*)memPtr;
-  memPtr += melFilterBankCoefMemSize;
-
-  stHdl->melFilterBinBuff = (size_t*)memPtr;
-  memPtr += melFilterBinBuffMemSize;
-
   stHdl->frameRmsBuff = (float*)memPtr;
   memPtr += frameRmsBuffMemSize;
 
@@ -586,27 +1197,562 @@ static int AUP_Aed_dynamMemPrepare(Aed_St* stHdl, void* memPtrExt,
   return ((int)totalMemSize);
 }
 
-static int AUP_Aed_runOneFrm(Aed_St* stHdl, const float* tSignal, int hopSz,
-                             const float* binPowPtr, int nBins) {
+// update the energy gate with one internal frame, return whether it's gated
+static int AUP_Aed_gateFrm(Aed_St* stHdl, const float* tSignal, int hopSz) {
+  float frameRms = 0.0f;
+  int idx;
+
+  if (stHdl->energyGateFlag == 0) {
+    stHdl->gateQuietFrmCnt = 0;
+    return 0;
+  }
+
+  for (idx = 0; idx < hopSz; idx++) {
+    frameRms += (tSignal[idx] * tSignal[idx]);
+  }
+  frameRms = sqrtf(frameRms / (float)hopSz);
+  if (frameRms >= stHdl->energyThresh) {
+    stHdl->gateQuietFrmCnt = 0;
+    return 0;
+  }
+  if (stHdl->gateQuietFrmCnt < stHdl->energyGateHangFrm) {
+    stHdl->gateQuietFrmCnt++;
+    return 0;
+  }
+  return 1;
+}
+
+// voicing check of the lazy pitch-estimator on one internal frame, return
+// whether the pitch-estimator has to run on it: the frame or one of the last
+// AUP_AED_LAZY_PITCH_HANG_FRM frames has few zero-crossings and a good part
+// of its power in the pitch band
+static int AUP_Aed_lazyPitchFrm(Aed_St* stHdl, const float* tSignal,
+                                int hopSz, const float* binPowPtr,
+                                int nBins) {
+  const int fftSz = (nBins - 1) * 2;
+  const int loBin = AUP_AED_LAZY_PITCH_BAND_LO * fftSz / AUP_AED_FS;
+  const int hiBin = AUP_AED_LAZY_PITCH_BAND_HI * fftSz / AUP_AED_FS;
+  float bandPow = 0.0f, totalPow = 0.0f;
+  int zcr = 0;
+  int idx;
+
+  if (stHdl->lazyPitchFlag == 0) {
+    return 1;
+  }
+
+  for (idx = 1; idx < hopSz; idx++) {
+    zcr += ((tSignal[idx - 1] < 0.0f) != (tSignal[idx] < 0.0f));
+  }
+  for (idx = 0; idx < nBins; idx++) {
+    totalPow += binPowPtr[idx];
+    if (idx >= loBin && idx < hiBin) {
+      bandPow += binPowPtr[idx];
+    }
+  }
+  if ((float)zcr <= AUP_AED_LAZY_PITCH_ZCR_THR * (float)(hopSz - 1) &&
+      bandPow >= AUP_AED_LAZY_PITCH_BAND_RATIO * totalPow && totalPow > 0.0f) {
+    stHdl->lazyPitchHangCnt = AUP_AED_LAZY_PITCH_HANG_FRM;
+    return 1;
+  }
+  if (stHdl->lazyPitchHangCnt > 0) {
+    stHdl->lazyPitchHangCnt--;
+    return 1;
+  }
+  return 0;
+}
+
+// decide whether the AIVAD model skips the prepared frame, as it's gated or
+// falls between two strided inferences; sets stHdl->frmSkipInf
+static int AUP_Aed_skipInf(Aed_St* stHdl) {
+  if (stHdl->frmGated) {
+    // the first frame after the gate is inferred
+    stHdl->infStrideCnt = stHdl->infStride;
+    stHdl->frmSkipInf = 1;
+  } else if (stHdl->infStride > 1 && stHdl->aivadScore >= 0.0f &&
+             fabsf(stHdl->aivadScore - stHdl->voiceDecideThresh) >=
+                 stHdl->infStrideMargin &&
+             stHdl->infStrideCnt + 1 < stHdl->infStride) {
+    stHdl->infStrideCnt++;
+    stHdl->frmSkipInf = 1;
+  } else {
+    stHdl->infStrideCnt = 0;
+    stHdl->frmSkipInf = 0;
+    stHdl->inferFrmNum++;
+    AUP_AED_STATS_FRM(AUP_AED_STATS_FRM_INFER, 1);
+  }
+  return stHdl->frmSkipInf;
+}
+
+// voice probability reported for a skipped frame: the last one decays towards
+// 0 on gated frames and is held on strided ones
+static float AUP_Aed_skipScore(const Aed_St* stHdl) {
+  if (!stHdl->frmGated) {
+    return stHdl->aivadScore;
+  }
+  if (stHdl->aivadScore <= 0.0f) {
+    return 0.0f;
+  }
+  return stHdl->aivadScore * AUP_AED_GATE_SCORE_DECAY;
+}
+
+// pitch estimation and AIVAD feature extraction of one internal frame, the
+// model itself is run by the caller; gated frames and those failing the
+// voicing check of the lazy pitch-estimator skip the pitch-estimator and take
+// a pitch of 0
+static int AUP_Aed_prepOneFrm(Aed_St* stHdl, const float* tSignal, int hopSz,
+                              const float* binPowPtr, int nBins) {
   PE_OutputData peOutData = {0, 0};
-  float aivadScore = -1.0f;
-  float mediaFilterout = 0;
-  int mediaIdx = (int)(AUP_AED_OUTPUT_SMOOTH_FILTER_LEN) / 2;
-  int i;
 
-  if (AUP_Aed_pitch_proc(stHdl->pitchEstStPtr, tSignal, hopSz, binPowPtr, nBins,
-                         &peOutData) < 0) {
+  stHdl->frmGated = AUP_Aed_gateFrm(stHdl, tSignal, hopSz);
+  stHdl->procFrmNum++;
+  AUP_AED_STATS_FRM(AUP_AED_STATS_FRM_PROC, 1);
+  if (stHdl->frmGated) {
+    stHdl->gatedFrmNum++;
+    AUP_AED_STATS_FRM(AUP_AED_STATS_FRM_GATED, 1);
+    stHdl->lazyPitchHangCnt = 0;
+    stHdl->pitchEstStale = 1;
+    stHdl->pitchFreq = 0.0f;
+  } else if (!AUP_Aed_lazyPitchFrm(stHdl, tSignal, hopSz, binPowPtr, nBins)) {
+    stHdl->pitchEstStale = 1;
+    stHdl->pitchFreq = 0.0f;
+  } else {
+    if (stHdl->pitchEstStale) {
+      // only silence or unvoiced frames were skipped, which a cleared memory
+      // matches closely
+      if (AUP_PE_init(stHdl->pitchEstStPtr) < 0) {
+        return -1;
+      }
+      stHdl->pitchEstStale = 0;
+    }
+    AUP_AED_TIC(tPitch);
+    if (AUP_Aed_pitch_proc(stHdl->pitchEstStPtr, tSignal, hopSz, binPowPtr,
+                           nBins, &peOutData) < 0) {
+      return -1;
+    }
+    AUP_AED_TOC(tPitch);
+    AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_PITCH, tPitch, 1);
+    stHdl->pitchFreq = peOutData.pitchFreq;
+  }
+  AUP_AED_TIC(tMel);
+  if (AUP_Aed_aivad_feat(stHdl, binPowPtr) < 0) {
     return -1;
   }
-  stHdl->pitchFreq = peOutData.pitchFreq;
-  if (AUP_Aed_aivad_proc(stHdl, binPowPtr, &aivadScore) < 0) {
+  AUP_AED_TOC(tMel);
+  AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_MEL, tMel + stHdl->frmLanesMelNs, 1);
+  stHdl->frmLanesDone = 0;
+  stHdl->frmLanesMelNs = 0;
+
+  return 0;
+}
+
+// one pass over samples @ AUP_AED_FS: convert them, append them to the input
+// time FIFO and its pre-emphasized copy, return energy plus their energy
+template <typename T>
+static float AUP_Aed_writeFIFOs(Aed_St* stHdl, const T* in, float scale,
+                                int timeLen, float energy) {
+  float* timeSigPtr = stHdl->inputTimeFIFO + stHdl->inputTimeFIFOIdx;
+  float* timeSigEphaPtr = stHdl->inputEmphTimeFIFO + stHdl->inputTimeFIFOIdx;
+  float timeSignalPre = stHdl->timeSignalPre;
+  float x;
+  int idx;
+
+  for (idx = 0; idx < timeLen; idx++) {
+    x = (float)in[idx] * scale;
+    timeSigPtr[idx] = x;
+    energy += (x * x);
+    timeSigEphaPtr[idx] = x - AUP_AED_PRE_EMPH_COEF * timeSignalPre;
+    timeSignalPre = x;
+  }
+  stHdl->timeSignalPre = timeSignalPre;
+  stHdl->inputTimeFIFOIdx += timeLen;
+
+  return energy;
+}
+
+// AUP_Aed_writeFIFOs on timeLen samples of format sampleType
+static float AUP_Aed_writeSamples(Aed_St* stHdl, const void* in,
+                                  int sampleType, int timeLen, float energy) {
+  if (sampleType == AUP_AED_SAMPLE_S16) {
+    return AUP_Aed_writeFIFOs(stHdl, (const short*)in, 1.0f, timeLen, energy);
+  } else if (sampleType == AUP_AED_SAMPLE_F32) {
+    return AUP_Aed_writeFIFOs(stHdl, (const float*)in, 32768.0f, timeLen,
+                              energy);
+  }
+  return AUP_Aed_writeFIFOs(stHdl, (const float*)in, 1.0f, timeLen, energy);
+}
+
+// convert len samples of format sampleType into inputFloatBuff + offset, the
+// float in [-32768, 32767] the resampler takes
+static void AUP_Aed_writeFloatBuff(Aed_St* stHdl, const void* in,
+                                   int sampleType, int offset, int len) {
+  float* out = stHdl->inputFloatBuff + offset;
+  int idx;
+
+  if (sampleType == AUP_AED_SAMPLE_S16) {
+    for (idx = 0; idx < len; idx++) {
+      out[idx] = (float)((const short*)in)[idx];
+    }
+  } else if (sampleType == AUP_AED_SAMPLE_F32) {
+    for (idx = 0; idx < len; idx++) {
+      out[idx] = ((const float*)in)[idx] * 32768.0f;
+    }
+  } else {
+    memcpy(out, in, sizeof(float) * len);
+  }
+}
+
+// make room for timeLen more samples at the write position of the FIFOs
+static int AUP_Aed_reserveFIFOs(Aed_St* stHdl, int timeLen) {
+  int pendLen = stHdl->inputTimeFIFOIdx - stHdl->inputTimeFIFORdIdx;
+
+  if ((pendLen + timeLen) > (int)stHdl->inputTimeFIFOLen) {
     return -1;
   }
-  stHdl->aivadScore = aivadScore;
+  if ((stHdl->inputTimeFIFOIdx + timeLen) > (int)stHdl->inputTimeFIFOCap) {
+    // compact the queued samples to the head of the FIFOs
+    memmove(stHdl->inputTimeFIFO,
+            stHdl->inputTimeFIFO + stHdl->inputTimeFIFORdIdx,
+            sizeof(float) * pendLen);
+    memmove(stHdl->inputEmphTimeFIFO,
+            stHdl->inputEmphTimeFIFO + stHdl->inputTimeFIFORdIdx,
+            sizeof(float) * pendLen);
+    stHdl->inputTimeFIFORdIdx = 0;
+    stHdl->inputTimeFIFOIdx = pendLen;
+  }
 
   return 0;
 }
 
+// record the rms of a completed hop of timeLen samples @ AUP_AED_FS
+static void AUP_Aed_pushFrameRms(Aed_St* stHdl, float frameEnergy,
+                                 int timeLen) {
+  stHdl->frameRmsBuff[stHdl->frameRmsBuffIdx] =
+      sqrtf(frameEnergy / (float)timeLen);
+  stHdl->frameRmsBuffIdx++;
+  if (stHdl->frameRmsBuffIdx == (int)stHdl->frmRmsBufLen) {
+    stHdl->frameRmsBuffIdx = 0;
+  }
+}
+
+// validate the input, update frame energy and the input time FIFOs
+static int AUP_Aed_procInput(Aed_St* stHdl, const Aed_InputData* pIn,
+                             float* frameEnergy) {
+  FscvrtInData fsCvrtIn;
+  FscvrtOutData fsCvrtOut;
+  float* timeSigPtr;
+  int timeLen;
+
+  if (pIn == NULL || pIn->timeSignal == NULL) {
+    return -1;
+  }
+  if (pIn->sampleType < AUP_AED_SAMPLE_FLT ||
+      pIn->sampleType > AUP_AED_SAMPLE_F32) {
+    return -1;
+  }
+  if (stHdl->chunkFill != 0) {  // a hop of AUP_Aed_procChunk is pending
+    return -1;
+  }
+
+  if (stHdl->intAnalyFlag != 2) {  // the external spectra is going to be used
+    if (pIn->binPower == NULL) {
+      return -1;
+    }
+    if (pIn->nBins != (int)((stHdl->stCfg.fftSz >> 1) + 1) ||
+        pIn->hopSz != (int)(stHdl->stCfg.hopSz)) {
+      return -1;
+    }
+  }
+
+  // number of samples @ AUP_AED_FS this frame adds to the FIFOs
+  timeLen = pIn->hopSz;
+  if (stHdl->stCfg.inputFs != AUP_AED_FS) {
+    if (pIn->hopSz != (int)(stHdl->stCfg.hopSz)) {
+      return -1;
+    }
+    timeLen = (int)stHdl->extHopSz;
+  }
+  if (AUP_Aed_reserveFIFOs(stHdl, timeLen) < 0) {
+    return -1;
+  }
+
+  // input signal conversion, FIFOs and frame energy in one pass .........
+  if (stHdl->stCfg.inputFs != AUP_AED_FS) {
+    // the resampler takes float in [-32768, 32767] and writes the FIFO
+    fsCvrtIn.inDataSeq = pIn->timeSignal;
+    if (pIn->sampleType != AUP_AED_SAMPLE_FLT) {
+      AUP_Aed_writeFloatBuff(stHdl, pIn->timeSignal, pIn->sampleType, 0,
+                             pIn->hopSz);
+      fsCvrtIn.inDataSeq = (const void*)stHdl->inputFloatBuff;
+    }
+    timeSigPtr = stHdl->inputTimeFIFO + stHdl->inputTimeFIFOIdx;
+    fsCvrtIn.outDataSeqLen = timeLen;
+    fsCvrtOut.outDataSeq = (void*)timeSigPtr;
+    if (AUP_Fscvrt_proc(stHdl->fsCvrtStPtr, &fsCvrtIn, &fsCvrtOut) < 0 ||
+        fsCvrtOut.nOutData != timeLen) {
+      return -1;
+    }
+    (*frameEnergy) = AUP_Aed_writeFIFOs(stHdl, (const float*)timeSigPtr, 1.0f,
+                                        timeLen, 0.0f);
+  } else {
+    (*frameEnergy) = AUP_Aed_writeSamples(stHdl, pIn->timeSignal,
+                                          pIn->sampleType, timeLen, 0.0f);
+  }
+  AUP_Aed_pushFrameRms(stHdl, (*frameEnergy), timeLen);
+
+  return 0;
+}
+
+// prepare the next pending internal frame for AIVAD inference
+// return value: 1 - one frame prepared, 0 - nothing pending, -1 - error
+static int AUP_Aed_prepNextFrm(Aed_St* stHdl, const Aed_InputData* pIn) {
+  Analyzer_InputData analyzerInput;
+  Analyzer_OutputData analyzerOutput;
+  const float* binPowPtr = NULL;
+  int pendLen = stHdl->inputTimeFIFOIdx - stHdl->inputTimeFIFORdIdx;
+
+  if (stHdl->intAnalyFlag == 0) {  // directly use external spectra
+    if (pendLen == 0) {  // already processed
+      return 0;
+    }
+    if (pendLen != AUP_AED_INT_HOPSZ || pIn->nBins != AUP_AED_INT_NBINS) {
+      return -1;
+    }
+    AUP_AED_TIC(tStft);
+    for (int idx = 0; idx < AUP_AED_INT_NBINS; idx++) {
+      stHdl->aivadInputBinPow[idx] = pIn->binPower[idx] * stHdl->emphTilt[idx];
+    }
+    binPowPtr = stHdl->aivadInputBinPow;
+    AUP_AED_TOC(tStft);
+    AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_STFT, tStft, 1);
+  } else if (stHdl->intAnalyFlag ==
+             1) {  // do interpolation or extrapolation with external spectra
+    if (pendLen == 0) {  // already processed
+      return 0;
+    }
+    if (pendLen != AUP_AED_INT_HOPSZ || (int)(stHdl->extNBins) != pIn->nBins) {
+      return -1;
+    }
+    AUP_AED_TIC(tStft);
+    AUP_Aed_binPowerConvert(pIn->binPower, stHdl->aivadInputBinPow,
+                            (int)stHdl->extNBins, AUP_AED_INT_NBINS);
+    for (int idx = 0; idx < AUP_AED_INT_NBINS; idx++) {
+      stHdl->aivadInputBinPow[idx] *= stHdl->emphTilt[idx];
+    }
+    binPowPtr = stHdl->aivadInputBinPow;
+    AUP_AED_TOC(tStft);
+    AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_STFT, tStft, 1);
+  } else if (stHdl->frmLanesDone) {  // STFT done by AUP_Aed_prepLanes
+    binPowPtr = stHdl->aivadInputBinPow;
+  } else {  // we need to do STFT on the input time-signal
+    if (stHdl->timeInAnalysis == NULL) {
+      return -1;
+    }
+    if (pendLen < AUP_AED_INT_HOPSZ) {
+      return 0;
+    }
+
+    AUP_AED_TIC(tStft);
+    analyzerInput.input =
+        stHdl->inputEmphTimeFIFO + stHdl->inputTimeFIFORdIdx;
+    analyzerInput.iLength = AUP_AED_INT_HOPSZ;
+    analyzerOutput.output = stHdl->aivadInputCmplxSptrm;
+    analyzerOutput.oLength = AUP_AED_INT_FFTSZ;
+    if (AUP_Analyzer_proc(stHdl->timeInAnalysis, &analyzerInput,
+                          &analyzerOutput) < 0) {
+      return -1;
+    }
+
+    AUP_FFTW_binPower(AUP_AED_INT_FFTSZ, stHdl->aivadInputCmplxSptrm,
+                      stHdl->aivadInputBinPow);
+    binPowPtr = stHdl->aivadInputBinPow;
+    AUP_AED_TOC(tStft);
+    AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_STFT, tStft, 1);
+  }
+
+  stHdl->aedProcFrmCnt = AUP_Aed_addOneCnter(stHdl->aedProcFrmCnt);
+
+  // update: stHdl->pitchFreq, stHdl->aivadInputFeatStack
+  if (AUP_Aed_prepOneFrm(stHdl,
+                         stHdl->inputTimeFIFO + stHdl->inputTimeFIFORdIdx,
+                         AUP_AED_INT_HOPSZ, binPowPtr,
+                         AUP_AED_INT_NBINS) < 0) {
+    return -1;
+  }
+
+  return 1;
+}
+
+// advance the input FIFOs past the prepared frame
+static void AUP_Aed_advanceFrm(Aed_St* stHdl) {
+  if (stHdl->intAnalyFlag != 2) {
+    // update the inputTimeFIFO
+    stHdl->inputTimeFIFOIdx = 0;
+    stHdl->inputTimeFIFORdIdx = 0;
+    return;
+  }
+
+  // update the inputTimeFIFO & inputEmphTimeFIFO.....
+  stHdl->inputTimeFIFORdIdx += AUP_AED_INT_HOPSZ;
+  if (stHdl->inputTimeFIFORdIdx == stHdl->inputTimeFIFOIdx) {
+    stHdl->inputTimeFIFORdIdx = 0;
+    stHdl->inputTimeFIFOIdx = 0;
+  }
+}
+
+// consume the AIVAD result of the prepared frame and advance the FIFOs
+static int AUP_Aed_finishFrm(Aed_St* stHdl, float aivadScore) {
+  // update: stHdl->aivadScore
+  AUP_Aed_aivad_post(stHdl, aivadScore);
+  AUP_Aed_advanceFrm(stHdl);
+
+  return 0;
+}
+
+static int AUP_Aed_vadDecision(const Aed_St* stHdl, float voiceProb) {
+  if (voiceProb < 0.0f) {
+    return -1;
+  } else if (voiceProb <= stHdl->voiceDecideThresh) {
+    return 0;
+  }
+  return 1;
+}
+
+static void AUP_Aed_writeOutput(const Aed_St* stHdl, float frameEnergy,
+                                Aed_OutputData* pOut) {
+  float powerNormal = 32768.0f * 32768.0f;
+
+  // write to output res.
+  pOut->frameEnergy = frameEnergy / powerNormal;
+  pOut->frameRms = stHdl->frameRmsBuff[stHdl->frameRmsBuffIdx];
+  pOut->pitchFreq = stHdl->pitchFreq;
+  pOut->energyVadRes = (pOut->frameRms >= stHdl->energyThresh) ? 1 : 0;
+  pOut->voiceProb = stHdl->aivadScore;
+  pOut->vadRes = AUP_Aed_vadDecision(stHdl, pOut->voiceProb);
+  pOut->procFrmNum = stHdl->procFrmNum;
+}
+
+static void AUP_Aed_setDefaultCfg(Aed_St* stHdl) {
+  stHdl->stCfg.enableFlag = 1;  // as default, module enabled
+  stHdl->stCfg.fftSz = 1024;
+  stHdl->stCfg.hopSz = 256;
+  stHdl->stCfg.anaWindowSz = 768;
+  stHdl->stCfg.frqInputAvailableFlag = 0;
+  stHdl->stCfg.modelPath = NULL;
+  stHdl->stCfg.modelData = NULL;
+  stHdl->stCfg.modelDataLen = 0;
+  stHdl->stCfg.inputFs = AUP_AED_FS;
+  stHdl->stCfg.modelPrecision = AUP_AED_MODEL_FP32;
+  stHdl->stCfg.fastMath = 0;
+
+  stHdl->dynamCfg.extVoiceThr = 0.5f;
+  stHdl->dynamCfg.extMusicThr = 0.5f;
+  stHdl->dynamCfg.extEnergyThr = 10.0f;
+  stHdl->dynamCfg.resetFrameNum = 1875;  // TODO
+  stHdl->dynamCfg.pitchEstVoicedThr = AUP_AED_PITCH_EST_DEFAULT_VOICEDTHR;
+  stHdl->dynamCfg.energyGateFlag = 0;
+  stHdl->dynamCfg.energyGateHangFrm = AUP_AED_GATE_DEFAULT_HANG_FRM;
+  stHdl->dynamCfg.infStride = 1;
+  stHdl->dynamCfg.infStrideMargin = 0.0f;
+  stHdl->dynamCfg.lazyPitchFlag = 0;
+}
+
+// static config of the submodules, derived from the published static config
+// registers
+static void AUP_Aed_getPitchCfg(const Aed_St* stHdl,
+                                PE_StaticCfg* pitchStatCfg) {
+  pitchStatCfg->fftSz = stHdl->intFftSz;
+  pitchStatCfg->anaWindowSz = stHdl->intWinSz;
+  pitchStatCfg->hopSz = stHdl->intHopSz;
+  pitchStatCfg->useLPCPreFiltering = AUP_AED_PITCH_EST_USE_LPC;
+  pitchStatCfg->procFs = AUP_AED_PITCH_EST_PROCFS;
+  pitchStatCfg->fastMath = stHdl->stCfg.fastMath;
+}
+
+static void AUP_Aed_getAnalyzerCfg(const Aed_St* stHdl,
+                                   Analyzer_StaticCfg* analyzerStatCfg) {
+  analyzerStatCfg->win_len = (int)stHdl->intWinSz;
+  analyzerStatCfg->hop_size = (int)stHdl->intHopSz;
+  analyzerStatCfg->fft_size = (int)stHdl->intFftSz;
+  analyzerStatCfg->ana_win_coeff = stHdl->intAnalyWindowPtr;
+}
+
+static void AUP_Aed_getFscvrtCfg(const Aed_St* stHdl,
+                                 FscvrtStaticCfg* fsCvrtStatCfg) {
+  fsCvrtStatCfg->inputFs = stHdl->stCfg.inputFs;
+  fsCvrtStatCfg->outputFs = AUP_AED_FS;
+  fsCvrtStatCfg->stepSz = (int)stHdl->stCfg.hopSz;
+  fsCvrtStatCfg->inputType = 1;   // float in
+  fsCvrtStatCfg->outputType = 1;  // float out, right into inputTimeFIFO
+  fsCvrtStatCfg->engine = stHdl->stCfg.inputFs > AUP_AED_FS
+                              ? AUP_AED_FSCVRT_DOWN_ENGINE
+                              : AUP_FSCVRT_ENGINE_BIQUAD;
+}
+
+// memory layout inside caller's memory:
+// [Aed_St][AUP_MODULE_AIVAD][dynamic memory][PE][Analyzer][Fscvrt]
+// the Fscvrt is left out (fsCvrtSize = 0) when inputFs == AUP_AED_FS
+typedef struct Aed_MemLayout_ {
+  size_t stSize;
+  size_t aivadSize;
+  size_t dynamSize;
+  size_t pitchSize;
+  size_t analyzerSize;
+  size_t fsCvrtSize;
+  PE_StaticCfg pitchStatCfg;
+  Analyzer_StaticCfg analyzerStatCfg;
+  FscvrtStaticCfg fsCvrtStatCfg;
+} Aed_MemLayout;
+
+static int AUP_Aed_getMemLayout(const Aed_StaticCfg* pCfg,
+                                Aed_MemLayout* layout) {
+  Aed_St tmpSt;
+  int totalMemSize;
+
+  memset(&tmpSt, 0, sizeof(Aed_St));
+  memcpy(&(tmpSt.stCfg), pCfg, sizeof(Aed_StaticCfg));
+  if (AUP_Aed_checkStatCfg(&(tmpSt.stCfg)) < 0 ||
+      AUP_Aed_publishStaticCfg(&tmpSt) < 0) {
+    return -1;
+  }
+  totalMemSize = AUP_Aed_dynamMemPrepare(&tmpSt, NULL, 0);
+  if (totalMemSize < 0) {
+    return -1;
+  }
+
+  AUP_Aed_getPitchCfg(&tmpSt, &(layout->pitchStatCfg));
+  AUP_Aed_getAnalyzerCfg(&tmpSt, &(layout->analyzerStatCfg));
+  if (AUP_PE_getMemSize(&(layout->pitchStatCfg), &(layout->pitchSize)) < 0 ||
+      AUP_Analyzer_getMemSize(&(layout->analyzerStatCfg),
+                              &(layout->analyzerSize)) < 0) {
+    return -1;
+  }
+  layout->fsCvrtSize = 0;
+  if (tmpSt.stCfg.inputFs != AUP_AED_FS) {
+    AUP_Aed_getFscvrtCfg(&tmpSt, &(layout->fsCvrtStatCfg));
+    if (AUP_Fscvrt_getMemSize(&(layout->fsCvrtStatCfg),
+                              &(layout->fsCvrtSize)) < 0) {
+      return -1;
+    }
+  }
+  layout->stSize = AUP_AED_ALIGN8(sizeof(Aed_St));
+  layout->aivadSize = AUP_AED_ALIGN8(sizeof(AUP_MODULE_AIVAD));
+  layout->dynamSize = AUP_AED_ALIGN8((size_t)totalMemSize);
+
+  return 0;
+}
+
+static void AUP_Aed_releaseAivad(Aed_St* stHdl) {
+  if (stHdl->aivadInf == NULL) {
+    return;
+  }
+  if (stHdl->aivadInfMem != NULL) {
+    stHdl->aivadInf->~AUP_MODULE_AIVAD();
+  } else {
+    delete stHdl->aivadInf;
+  }
+  stHdl->aivadInf = NULL;
+}
+
 /// ///////////////////////////////////////////////////////////////////////
 /// Public API
 /// ///////////////////////////////////////////////////////////////////////
@@ -628,17 +1774,75 @@ int AUP_Aed_create(void** stPtr) {
     return -1;
   }
 
-  tmpPtr->stCfg.enableFlag = 1;  // as default, module enabled
-  tmpPtr->stCfg.fftSz = 1024;
-  tmpPtr->stCfg.hopSz = 256;
-  tmpPtr->stCfg.anaWindowSz = 768;
-  tmpPtr->stCfg.frqInputAvailableFlag = 0;
+  AUP_Aed_setDefaultCfg(tmpPtr);
+
+  (*stPtr) = (void*)tmpPtr;
+
+  return 0;
+}
+
+int AUP_Aed_getMemSize(const Aed_StaticCfg* pCfg, size_t* memSize) {
+  Aed_MemLayout layout;
+
+  if (pCfg == NULL || memSize == NULL) {
+    return -1;
+  }
+  if (AUP_Aed_getMemLayout(pCfg, &layout) < 0) {
+    return -1;
+  }
+  (*memSize) = layout.stSize + layout.aivadSize + layout.dynamSize +
+               layout.pitchSize + layout.analyzerSize + layout.fsCvrtSize;
+
+  return 0;
+}
+
+int AUP_Aed_createIn(void** stPtr, void* mem, size_t memSize,
+                     const Aed_StaticCfg* pCfg) {
+  Aed_MemLayout layout;
+  char* memPtr = (char*)mem;
+
+  if (stPtr == NULL || mem == NULL || pCfg == NULL ||
+      ((size_t)mem & 7) != 0) {
+    return -1;
+  }
+  if (AUP_Aed_getMemLayout(pCfg, &layout) < 0 ||
+      layout.stSize + layout.aivadSize + layout.dynamSize + layout.pitchSize +
+              layout.analyzerSize + layout.fsCvrtSize >
+          memSize) {
+    return -1;
+  }
+
+  Aed_St* tmpPtr = (Aed_St*)memPtr;
+  memset(tmpPtr, 0, sizeof(Aed_St));
+  memPtr += layout.stSize;
+  tmpPtr->extMemFlag = 1;
+
+  tmpPtr->aivadInfMem = memPtr;
+  memPtr += layout.aivadSize;
+
+  tmpPtr->dynamMemPtr = memPtr;
+  tmpPtr->dynamMemSize = layout.dynamSize;
+  memPtr += layout.dynamSize;
+
+  if (AUP_PE_createIn(&(tmpPtr->pitchEstStPtr), memPtr, layout.pitchSize,
+                      &(layout.pitchStatCfg)) < 0) {
+    return -1;
+  }
+  memPtr += layout.pitchSize;
+  if (AUP_Analyzer_createIn(&(tmpPtr->timeInAnalysis), memPtr,
+                            layout.analyzerSize,
+                            &(layout.analyzerStatCfg)) < 0) {
+    return -1;
+  }
+  memPtr += layout.analyzerSize;
+  if (layout.fsCvrtSize != 0) {
+    if (AUP_Fscvrt_createIn(&(tmpPtr->fsCvrtStPtr), memPtr, layout.fsCvrtSize,
+                            &(layout.fsCvrtStatCfg)) < 0) {
+      return -1;
+    }
+  }
 
-  tmpPtr->dynamCfg.extVoiceThr = 0.5f;
-  tmpPtr->dynamCfg.extMusicThr = 0.5f;
-  tmpPtr->dynamCfg.extEnergyThr = 10.0f;
-  tmpPtr->dynamCfg.resetFrameNum = 1875;  // TODO
-  tmpPtr->dynamCfg.pitchEstVoicedThr = AUP_AED_PITCH_EST_DEFAULT_VOICEDTHR;
+  AUP_Aed_setDefaultCfg(tmpPtr);
 
   (*stPtr) = (void*)tmpPtr;
 
@@ -651,10 +1855,7 @@ int AUP_Aed_destroy(void** stPtr) {
   }
   Aed_St* stHdl = (Aed_St*)(*stPtr);
 
-  if (stHdl->aivadInf != NULL) {
-    delete stHdl->aivadInf;
-  }
-  stHdl->aivadInf = NULL;
+  AUP_Aed_releaseAivad(stHdl);
 
   if (AUP_PE_destroy(&(stHdl->pitchEstStPtr)) < 0) {
     return -1;
@@ -662,6 +1863,14 @@ int AUP_Aed_destroy(void** stPtr) {
   if (AUP_Analyzer_destroy(&(stHdl->timeInAnalysis)) < 0) {
     return -1;
   }
+  if (AUP_Fscvrt_destroy(&(stHdl->fsCvrtStPtr)) < 0) {
+    return -1;
+  }
+
+  if (stHdl->extMemFlag) {  // memory is owned by the caller
+    (*stPtr) = NULL;
+    return 0;
+  }
 
   if (stHdl->dynamMemPtr != NULL) {
     free(stHdl->dynamMemPtr);
@@ -681,6 +1890,7 @@ int AUP_Aed_memAllocate(void* stPtr, const Aed_StaticCfg* pCfg) {
   Aed_StaticCfg aedStatCfg;
   PE_StaticCfg pitchStatCfg;
   Analyzer_StaticCfg analyzerStatCfg;
+  FscvrtStaticCfg fsCvrtStatCfg;
   int totalMemSize = 0;
 
   if (stPtr == NULL || pCfg == NULL) {
@@ -701,12 +1911,33 @@ int AUP_Aed_memAllocate(void* stPtr, const Aed_StaticCfg* pCfg) {
     return -1;
   }
 
+  stHdl->melFb = AUP_Aed_getMelFilterBank(stHdl->intFftSz, stHdl->melFbSz);
+  stHdl->emphTilt = AUP_Aed_getEmphTilt(stHdl->intNBins);
+  if (stHdl->melFb == NULL || stHdl->emphTilt == NULL) {
+    return -1;
+  }
+
   // 3th: create aivad instance
   if (stHdl->aivadInf == NULL) {
-    stHdl->aivadInf = new AUP_MODULE_AIVAD("onnx_model/ten-vad.onnx");
+    const char* modelPath = aedStatCfg.modelPath != NULL
+                                ? aedStatCfg.modelPath
+                                : AUP_AED_DEFAULT_MODEL_PATH;
+    if (stHdl->aivadInfMem != NULL) {
+      stHdl->aivadInf = new (stHdl->aivadInfMem)
+          AUP_MODULE_AIVAD(modelPath, aedStatCfg.modelData,
+                           aedStatCfg.modelDataLen, aedStatCfg.modelPrecision);
+    } else {
+      stHdl->aivadInf = new AUP_MODULE_AIVAD(
+          modelPath, aedStatCfg.modelData, aedStatCfg.modelDataLen,
+          aedStatCfg.modelPrecision);
+    }
     if (stHdl->aivadInf == NULL) {
       return -1;
     }
+    if (!stHdl->aivadInf->IsInited()) {
+      AUP_Aed_releaseAivad(stHdl);
+      return -1;
+    }
   }
   stHdl->aivadInf->Reset();
 
@@ -714,25 +1945,36 @@ int AUP_Aed_memAllocate(void* stPtr, const Aed_StaticCfg* pCfg) {
   if (AUP_PE_getStaticCfg(stHdl->pitchEstStPtr, &pitchStatCfg) < 0) {
     return -1;
   }
-  pitchStatCfg.fftSz = stHdl->intFftSz;
-  pitchStatCfg.anaWindowSz = stHdl->intWinSz;
-  pitchStatCfg.hopSz = stHdl->intHopSz;
-  pitchStatCfg.useLPCPreFiltering = AUP_AED_PITCH_EST_USE_LPC;
-  pitchStatCfg.procFs = AUP_AED_PITCH_EST_PROCFS;
+  AUP_Aed_getPitchCfg(stHdl, &pitchStatCfg);
   if (AUP_PE_memAllocate(stHdl->pitchEstStPtr, &pitchStatCfg) < 0) {
     return -1;
   }
 
   // creation and initialization with time-analysis module ......
   AUP_Analyzer_getStaticCfg(stHdl->timeInAnalysis, &analyzerStatCfg);
-  analyzerStatCfg.win_len = (int)stHdl->intWinSz;
-  analyzerStatCfg.hop_size = (int)stHdl->intHopSz;
-  analyzerStatCfg.fft_size = (int)stHdl->intFftSz;
-  analyzerStatCfg.ana_win_coeff = stHdl->intAnalyWindowPtr;
+  AUP_Aed_getAnalyzerCfg(stHdl, &analyzerStatCfg);
   if (AUP_Analyzer_memAllocate(stHdl->timeInAnalysis, &analyzerStatCfg) < 0) {
     return -1;
   }
 
+  // sampling-rate converter in front of the input FIFO ......
+  if (stHdl->stCfg.inputFs != AUP_AED_FS) {
+    if (stHdl->fsCvrtStPtr == NULL) {
+      if (stHdl->extMemFlag) {  // not reserved in caller's memory
+        return -1;
+      }
+      if (AUP_Fscvrt_create(&(stHdl->fsCvrtStPtr)) < 0) {
+        return -1;
+      }
+    }
+    AUP_Aed_getFscvrtCfg(stHdl, &fsCvrtStatCfg);
+    if (AUP_Fscvrt_memAllocate(stHdl->fsCvrtStPtr, &fsCvrtStatCfg) < 0) {
+      return -1;
+    }
+  } else if (stHdl->fsCvrtStPtr != NULL && !stHdl->extMemFlag) {
+    AUP_Fscvrt_destroy(&(stHdl->fsCvrtStPtr));
+  }
+
   // 5th: check memory requirement ..............................
   totalMemSize = AUP_Aed_dynamMemPrepare(stHdl, NULL, 0);
   if (totalMemSize < 0) {
@@ -741,6 +1983,9 @@ int AUP_Aed_memAllocate(void* stPtr, const Aed_StaticCfg* pCfg) {
 
   // 6th: allocate dynamic memory
   if (totalMemSize > (int)stHdl->dynamMemSize) {
+    if (stHdl->extMemFlag) {  // caller's memory can not grow
+      return -1;
+    }
     if (stHdl->dynamMemPtr != NULL) {
       free(stHdl->dynamMemPtr);
       stHdl->dynamMemPtr = NULL;
@@ -840,16 +2085,123 @@ int AUP_Aed_getAlgDelay(const void* stPtr, int* delayInFrms) {
   return 0;
 }
 
+int AUP_Aed_getFrmTiming(const void* stPtr, int* frmLen, int* delay) {
+  const Aed_St* stHdl = (const Aed_St*)(stPtr);
+  FscvrtGetData fsCvrtInfo = {0, 0};
+
+  if (stPtr == NULL || frmLen == NULL || delay == NULL) {
+    return -1;
+  }
+  if (stHdl->stCfg.inputFs != AUP_AED_FS && stHdl->fsCvrtStPtr != NULL) {
+    if (AUP_Fscvrt_getInfor(stHdl->fsCvrtStPtr, &fsCvrtInfo) < 0) {
+      return -1;
+    }
+  }
+
+  (*frmLen) = (int)(AUP_AED_INT_HOPSZ * stHdl->stCfg.inputFs / AUP_AED_FS);
+  (*delay) = (int)stHdl->algDelay * (*frmLen) + fsCvrtInfo.delayInInputFs;
+
+  return 0;
+}
+
+int AUP_Aed_getFrmCnts(const void* stPtr, uint64_t* procFrms,
+                       uint64_t* gatedFrms, uint64_t* inferFrms) {
+  const Aed_St* stHdl = (const Aed_St*)(stPtr);
+
+  if (stPtr == NULL || procFrms == NULL || gatedFrms == NULL) {
+    return -1;
+  }
+
+  (*procFrms) = stHdl->procFrmNum;
+  (*gatedFrms) = stHdl->gatedFrmNum;
+  if (inferFrms != NULL) {
+    (*inferFrms) = stHdl->inferFrmNum;
+  }
+
+  return 0;
+}
+
+int AUP_Aed_getStats(const void* stPtr, Aed_Stats* pStats) {
+  int stage;
+
+  if (pStats == NULL) {
+    return -1;
+  }
+  memset(pStats, 0, sizeof(Aed_Stats));
+
+  if (stPtr != NULL) {
+    const Aed_St* stHdl = (const Aed_St*)(stPtr);
+    pStats->procFrms = stHdl->procFrmNum;
+    pStats->gatedFrms = stHdl->gatedFrmNum;
+    pStats->inferFrms = stHdl->inferFrmNum;
+#if AUP_AED_STATS
+    for (stage = 0; stage < AUP_AED_STAGE_NUM; stage++) {
+      AUP_Aed_statsSummary(&stHdl->stageStats[stage], &pStats->stage[stage]);
+    }
+#endif
+    return 0;
+  }
+
+#if AUP_AED_STATS
+  pStats->procFrms =
+      aedGlobalFrmNum[AUP_AED_STATS_FRM_PROC].load(std::memory_order_relaxed);
+  pStats->gatedFrms =
+      aedGlobalFrmNum[AUP_AED_STATS_FRM_GATED].load(std::memory_order_relaxed);
+  pStats->inferFrms =
+      aedGlobalFrmNum[AUP_AED_STATS_FRM_INFER].load(std::memory_order_relaxed);
+  for (stage = 0; stage < AUP_AED_STAGE_NUM; stage++) {
+    const Aed_GlobalStageStats* glb = &aedGlobalStats[stage];
+    Aed_StageStats rec;
+    rec.cnt = glb->cnt.load(std::memory_order_relaxed);
+    rec.sumNs = glb->sumNs.load(std::memory_order_relaxed);
+    rec.minNs = glb->minNs.load(std::memory_order_relaxed);
+    rec.maxNs = glb->maxNs.load(std::memory_order_relaxed);
+    for (int idx = 0; idx < AUP_AED_STATS_NBUCKETS; idx++) {
+      rec.hist[idx] = glb->hist[idx].load(std::memory_order_relaxed);
+    }
+    AUP_Aed_statsSummary(&rec, &pStats->stage[stage]);
+  }
+  return 0;
+#else
+  (void)stage;
+  return -1;
+#endif
+}
+
+// run every pending internal frame through the AIVAD and write the result
+// of the hop that queued them
+static int AUP_Aed_procFrms(Aed_St* stHdl, const Aed_InputData* pIn,
+                            float frameEnergy, Aed_OutputData* pOut) {
+  float aivadScore;
+  int ret;
+
+  // loop processing .....
+  while ((ret = AUP_Aed_prepNextFrm(stHdl, pIn)) > 0) {
+    aivadScore = -1.0f;
+    if (AUP_Aed_skipInf(stHdl)) {
+      aivadScore = AUP_Aed_skipScore(stHdl);
+    } else if (stHdl->aivadInf != NULL) {
+      AUP_AED_TIC(tInf);
+      if (stHdl->aivadInf->Process(stHdl->aivadInputFeat, &aivadScore) != 0) {
+        return -1;
+      }
+      AUP_AED_TOC(tInf);
+      AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_INFER, tInf, 1);
+    }
+    AUP_Aed_finishFrm(stHdl, aivadScore);
+  }
+  if (ret < 0) {
+    return -1;
+  }
+
+  AUP_Aed_writeOutput(stHdl, frameEnergy, pOut);
+
+  return 0;
+}
+
 int AUP_Aed_proc(void* stPtr, const Aed_InputData* pIn, Aed_OutputData* pOut) {
-  Analyzer_InputData analyzerInput;
-  Analyzer_OutputData analyzerOutput;
   Aed_St* stHdl = (Aed_St*)(stPtr);
-
-  const float* binPowPtr = NULL;
-  float frameRms = 0.0f;
   float frameEnergy = 0.0f;
-  float powerNormal = 32768.0f * 32768.0f;
-  int idx;
 
   if (stPtr == NULL) {
     return -1;
@@ -860,133 +2212,636 @@ int AUP_Aed_proc(void* stPtr, const Aed_InputData* pIn, Aed_OutputData* pOut) {
   if (pIn == NULL || pIn->timeSignal == NULL || pOut == NULL) {
     return -1;
   }
+  AUP_AED_TIC(tHop);
 
-  if (stHdl->intAnalyFlag != 2) {  // the external spectra is going to be used
-    if (pIn->binPower == NULL) {
-      return -1;
+  if (AUP_Aed_procInput(stHdl, pIn, &frameEnergy) < 0) {
+    return -1;
+  }
+  if (AUP_Aed_procFrms(stHdl, pIn, frameEnergy, pOut) < 0) {
+    return -1;
+  }
+  AUP_AED_TOC(tHop);
+  AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_HOP, tHop, 1);
+
+  return 0;
+}
+
+int AUP_Aed_procChunk(void* stPtr, const Aed_InputData* pIn,
+                      Aed_OutputData* pOuts, int maxOuts, int* nOuts) {
+  Aed_St* stHdl = (Aed_St*)(stPtr);
+  const char* in;
+  size_t sampleSz;
+  size_t hopSz;
+  int len, pos, n, num;
+
+  if (stPtr == NULL || pIn == NULL || pIn->timeSignal == NULL ||
+      pOuts == NULL || nOuts == NULL || pIn->hopSz < 0) {
+    return -1;
+  }
+  if (pIn->sampleType < AUP_AED_SAMPLE_FLT ||
+      pIn->sampleType > AUP_AED_SAMPLE_F32) {
+    return -1;
+  }
+  *nOuts = 0;
+  if (stHdl->stCfg.enableFlag == 0) {  // this module is disabled
+    return 0;
+  }
+  if (stHdl->intAnalyFlag != 2) {  // external spectra come hop by hop
+    return -1;
+  }
+  hopSz = stHdl->stCfg.hopSz;
+  len = pIn->hopSz;
+  if ((stHdl->chunkFill + (size_t)len) / hopSz > (size_t)maxOuts) {
+    return -1;
+  }
+  AUP_AED_TIC(tHop);
+
+  // reframe into hops of stCfg.hopSz: @ AUP_AED_FS the samples go straight
+  // into the FIFOs and the hop energy accumulates across calls, otherwise
+  // they are gathered in inputFloatBuff for the resampler
+  in = (const char*)pIn->timeSignal;
+  sampleSz = (pIn->sampleType == AUP_AED_SAMPLE_S16) ? sizeof(short)
+                                                      : sizeof(float);
+  num = 0;
+  for (pos = 0; pos < len; pos += n) {
+    n = (int)AUP_AED_MIN((size_t)(len - pos), hopSz - stHdl->chunkFill);
+    if (stHdl->stCfg.inputFs != AUP_AED_FS) {
+      AUP_Aed_writeFloatBuff(stHdl, in + pos * sampleSz, pIn->sampleType,
+                             (int)stHdl->chunkFill, n);
+    } else {
+      if (stHdl->chunkFill == 0 &&
+          AUP_Aed_reserveFIFOs(stHdl, (int)hopSz) < 0) {
+        return -1;
+      }
+      stHdl->chunkEnergy =
+          AUP_Aed_writeSamples(stHdl, in + pos * sampleSz, pIn->sampleType, n,
+                               stHdl->chunkEnergy);
     }
-    if (pIn->nBins != (int)((stHdl->stCfg.fftSz >> 1) + 1) ||
-        pIn->hopSz != (int)(stHdl->stCfg.hopSz)) {
+    stHdl->chunkFill += (size_t)n;
+    if (stHdl->chunkFill < hopSz) {
+      break;
+    }
+
+    // one complete hop, processed as by AUP_Aed_proc
+    float frameEnergy = stHdl->chunkEnergy;
+    stHdl->chunkFill = 0;
+    stHdl->chunkEnergy = 0.0f;
+    if (stHdl->stCfg.inputFs != AUP_AED_FS) {
+      Aed_InputData hopIn;
+      hopIn.binPower = NULL;
+      hopIn.nBins = -1;
+      hopIn.timeSignal = stHdl->inputFloatBuff;
+      hopIn.sampleType = AUP_AED_SAMPLE_FLT;
+      hopIn.hopSz = (int)hopSz;
+      if (AUP_Aed_procInput(stHdl, &hopIn, &frameEnergy) < 0) {
+        return -1;
+      }
+    } else {
+      AUP_Aed_pushFrameRms(stHdl, frameEnergy, (int)hopSz);
+    }
+    if (AUP_Aed_procFrms(stHdl, pIn, frameEnergy, &pOuts[num]) < 0) {
       return -1;
     }
+    num++;
+    *nOuts = num;
   }
-
-  // cal. input frame energy ....
-  for (idx = 0; idx < pIn->hopSz; idx++) {
-    frameRms += (pIn->timeSignal[idx] * pIn->timeSignal[idx]);
+  AUP_AED_TOC(tHop);
+  if (num > 0) {
+    AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_HOP, tHop, num);
   }
-  frameEnergy = frameRms;
-  frameRms = sqrtf(frameRms / (float)pIn->hopSz);
-  memmove(stHdl->frameRmsBuff, stHdl->frameRmsBuff + 1,
-          sizeof(float) * (stHdl->frmRmsBufLen - 1));
-  stHdl->frameRmsBuff[stHdl->frmRmsBufLen - 1] = frameRms;
 
-  // input signal conversion .........
-  if ((stHdl->inputTimeFIFOIdx + pIn->hopSz) > (int)stHdl->inputTimeFIFOLen) {
+  return 0;
+}
+
+// STFT, power spectrum and mel projection of the pending frames of n (>= 2)
+// handlers using the internal STFT, one handler per SIMD lane; the rest of
+// the frame is left to AUP_Aed_prepNextFrm, which finds frmLanesDone set.
+// lanes is AUP_FFTW_lanes(), buf holds (2 * fftSz + nBins) * lanes floats
+static int AUP_Aed_prepFrmLanes(Aed_St* const* grp, int n, int lanes,
+                                float* buf) {
+  void* anaSt[AUP_FFTW_MAX_LANES];
+  Analyzer_InputData anaIn[AUP_FFTW_MAX_LANES];
+  float* binPow[AUP_FFTW_MAX_LANES];
+  float* sptrm = buf;
+  float* work = sptrm + AUP_AED_INT_FFTSZ * lanes;
+  float* pow = work + AUP_AED_INT_FFTSZ * lanes;
+  const Aed_MelFilterBank* melFb = grp[0]->melFb;
+  float acc[AUP_FFTW_MAX_LANES];
+  const float* coef;
+  const float* p;
+  size_t i, j, bandLen;
+  int c;
+
+  AUP_AED_TIC(tStft);
+  for (c = 0; c < n; c++) {
+    anaSt[c] = grp[c]->timeInAnalysis;
+    anaIn[c].input = grp[c]->inputEmphTimeFIFO + grp[c]->inputTimeFIFORdIdx;
+    anaIn[c].iLength = AUP_AED_INT_HOPSZ;
+  }
+  if (AUP_Analyzer_procLanes(anaSt, anaIn, n, sptrm, work) < 0) {
     return -1;
   }
+  AUP_FFTW_binPowerLanes(AUP_AED_INT_FFTSZ, sptrm, pow);
+  for (c = 0; c < lanes; c++) {  // unused lanes go to scratch
+    binPow[c] = c < n ? grp[c]->aivadInputBinPow : work;
+  }
+  AUP_FFTW_deinterleaveLanes(pow, AUP_AED_INT_NBINS, binPow);
+  AUP_AED_TOC(tStft);
+
+  // the bands of AUP_Aed_aivad_feat, summed in the same order per lane
+  AUP_AED_TIC(tMel);
+  for (i = 0; i < AUP_AED_MEL_FILTER_BANK_NUM; i++) {
+    coef = melFb->coef + melFb->bandOffset[i];
+    p = pow + melFb->bandStart[i] * lanes;
+    bandLen = melFb->bandLen[i];
+    for (c = 0; c < lanes; c++) {
+      acc[c] = 0.0f;
+    }
+    for (j = 0; j < bandLen; j++, p += lanes) {
+      for (c = 0; c < lanes; c++) {
+        acc[c] += (p[c] * coef[j]);
+      }
+    }
+    for (c = 0; c < n; c++) {
+      grp[c]->aivadInputFeatStack[grp[c]->aivadInputFeatIdx * AUP_AED_FEA_LEN +
+                                  i] = acc[c];
+    }
+  }
+  for (c = 0; c < n; c++) {
+    AUP_Aed_melNorm(grp[c], grp[c]->aivadInputFeatStack +
+                                grp[c]->aivadInputFeatIdx * AUP_AED_FEA_LEN);
+  }
+  AUP_AED_TOC(tMel);
 
-  // update pre-emphasis time signal FIFO
-  float* timeSigEphaPtr = stHdl->inputEmphTimeFIFO + stHdl->inputTimeFIFOIdx;
-  for (idx = 0; idx < pIn->hopSz; idx++) {
-    timeSigEphaPtr[idx] = pIn->timeSignal[idx] - 0.97f * stHdl->timeSignalPre;
-    stHdl->timeSignalPre = pIn->timeSignal[idx];
+  for (c = 0; c < n; c++) {
+    AUP_AED_STATS_ADD(grp[c], AUP_AED_STAGE_STFT, tStft / (uint64_t)n, 1);
+#if AUP_AED_STATS
+    grp[c]->frmLanesMelNs = tMel / (uint64_t)n;
+#endif
+    grp[c]->frmLanesDone = 1;
   }
 
-  memcpy(stHdl->inputTimeFIFO + stHdl->inputTimeFIFOIdx, pIn->timeSignal,
-         sizeof(float) * (pIn->hopSz));
-  stHdl->inputTimeFIFOIdx += pIn->hopSz;
+  return 0;
+}
 
-  if (stHdl->intAnalyFlag == 0) {  // directly use external spectra
-    if (stHdl->inputTimeFIFOIdx != (int)(stHdl->intHopSz) ||
-        (int)(stHdl->intNBins) != pIn->nBins) {
+// run AUP_Aed_prepFrmLanes over the handlers with a pending internal STFT
+// frame in groups of AUP_FFTW_lanes(); without SoA kernels, or for a single
+// such handler, everything is left to AUP_Aed_prepNextFrm
+static int AUP_Aed_prepLanes(void* const* stPtrs, int num,
+                             std::vector<float>* buf) {
+  const int lanes = AUP_FFTW_lanes();
+  Aed_St* grp[AUP_FFTW_MAX_LANES];
+  Aed_St* stHdl;
+  int i, n = 0;
+
+  if (lanes < 2) {
+    return 0;
+  }
+  for (i = 0; i < num; i++) {
+    stHdl = (Aed_St*)(stPtrs[i]);
+    if (stHdl->stCfg.enableFlag == 0 || stHdl->intAnalyFlag != 2 ||
+        stHdl->timeInAnalysis == NULL || stHdl->frmLanesDone ||
+        stHdl->inputTimeFIFOIdx - stHdl->inputTimeFIFORdIdx <
+            AUP_AED_INT_HOPSZ) {
+      continue;
+    }
+    grp[n++] = stHdl;
+    if (n == lanes) {
+      buf->resize((2 * AUP_AED_INT_FFTSZ + AUP_AED_INT_NBINS) * lanes);
+      if (AUP_Aed_prepFrmLanes(grp, n, lanes, buf->data()) < 0) {
+        return -1;
+      }
+      n = 0;
+    }
+  }
+  if (n > 1) {
+    buf->resize((2 * AUP_AED_INT_FFTSZ + AUP_AED_INT_NBINS) * lanes);
+    if (AUP_Aed_prepFrmLanes(grp, n, lanes, buf->data()) < 0) {
       return -1;
     }
+  }
 
-    // one-time processing ...
-    stHdl->aedProcFrmCnt = AUP_Aed_addOneCnter(stHdl->aedProcFrmCnt);
-    binPowPtr = pIn->binPower;
+  return 0;
+}
 
-    // update: stHdl->pitchFreq, stHdl->aivadScore
-    if (AUP_Aed_runOneFrm(stHdl, stHdl->inputTimeFIFO, (int)stHdl->intHopSz,
-                          binPowPtr, (int)stHdl->intNBins) < 0) {
+int AUP_Aed_procBatch(void* const* stPtrs, const Aed_InputData* pIns,
+                      Aed_OutputData* pOuts, int num) {
+  std::vector<Aed_St*> active;
+  std::vector<AUP_MODULE_AIVAD*> insts;
+  std::vector<float*> feats;
+  std::vector<float> frameEnergy;
+  std::vector<float> aivadScores;
+  std::vector<float> lanesBuf;
+  Aed_St* stHdl;
+  int i, n, ret;
+
+  if (stPtrs == NULL || pIns == NULL || pOuts == NULL || num <= 0) {
+    return -1;
+  }
+  for (i = 0; i < num; i++) {
+    if (stPtrs[i] == NULL) {
       return -1;
     }
+  }
 
-    // update the inputTimeFIFO
-    stHdl->inputTimeFIFOIdx = 0;
-  } else if (stHdl->intAnalyFlag ==
-             1) {  // do interpolation or extrapolation with external spectra
-    if (stHdl->inputTimeFIFOIdx != (int)(stHdl->intHopSz) ||
-        (int)(stHdl->extNBins) != pIn->nBins) {
+  AUP_AED_TIC(tHop);
+  frameEnergy.assign(num, 0.0f);
+  active.reserve(num);
+  for (i = 0; i < num; i++) {
+    stHdl = (Aed_St*)(stPtrs[i]);
+    if (stHdl->stCfg.enableFlag == 0) {  // this module is disabled
+      continue;
+    }
+    if (AUP_Aed_procInput(stHdl, &pIns[i], &frameEnergy[i]) < 0) {
       return -1;
     }
+  }
 
-    // one-time processing ....
-    stHdl->aedProcFrmCnt = AUP_Aed_addOneCnter(stHdl->aedProcFrmCnt);
-    AUP_Aed_binPowerConvert(pIn->binPower, stHdl->aivadInputBinPow,
-                            (int)stHdl->extNBins, (int)stHdl->intNBins);
-    binPowPtr = stHdl->aivadInputBinPow;
-
-    // update: stHdl->pitchFreq, stHdl->aivadScore
-    if (AUP_Aed_runOneFrm(stHdl, stHdl->inputTimeFIFO, (int)stHdl->intHopSz,
-                          binPowPtr, (int)stHdl->intNBins) < 0) {
+  // each round prepares at most one internal frame per handle, so that the
+  // recurrent state of every handle still advances frame by frame
+  insts.reserve(num);
+  feats.reserve(num);
+  aivadScores.reserve(num);
+  while (1) {
+    active.clear();
+    insts.clear();
+    feats.clear();
+    if (AUP_Aed_prepLanes(stPtrs, num, &lanesBuf) < 0) {
       return -1;
     }
+    for (i = 0; i < num; i++) {
+      stHdl = (Aed_St*)(stPtrs[i]);
+      if (stHdl->stCfg.enableFlag == 0) {
+        continue;
+      }
+      ret = AUP_Aed_prepNextFrm(stHdl, &pIns[i]);
+      if (ret < 0) {
+        return -1;
+      } else if (ret > 0) {
+        active.push_back(stHdl);
+        if (!AUP_Aed_skipInf(stHdl) && stHdl->aivadInf != NULL) {
+          insts.push_back(stHdl->aivadInf);
+          feats.push_back(stHdl->aivadInputFeat);
+        }
+      }
+    }
+    if (active.empty()) {
+      break;
+    }
 
-    // update the inputTimeFIFO
-    stHdl->inputTimeFIFOIdx = 0;
-  } else {  // we need to do STFT on the input time-signal
-    if (stHdl->timeInAnalysis == NULL) {
+    aivadScores.assign(insts.size(), -1.0f);
+    AUP_AED_TIC(tInf);
+    if (!insts.empty() &&
+        AUP_MODULE_AIVAD::ProcessBatch(insts.data(), feats.data(),
+                                       aivadScores.data(),
+                                       (int)insts.size()) != 0) {
       return -1;
     }
+    AUP_AED_TOC(tInf);
+    for (i = 0, n = 0; i < (int)active.size(); i++) {
+      stHdl = active[i];
+      if (stHdl->frmSkipInf) {
+        AUP_Aed_finishFrm(stHdl, AUP_Aed_skipScore(stHdl));
+      } else if (stHdl->aivadInf != NULL) {
+        // each frame of the batch takes an equal share of the run
+        AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_INFER,
+                          tInf / (uint64_t)insts.size(), 1);
+        AUP_Aed_finishFrm(stHdl, aivadScores[n++]);
+      } else {
+        AUP_Aed_finishFrm(stHdl, -1.0f);
+      }
+    }
+  }
 
-    // loop processing .....
-    while (stHdl->inputTimeFIFOIdx >= (int)stHdl->intHopSz) {
-      stHdl->aedProcFrmCnt = AUP_Aed_addOneCnter(stHdl->aedProcFrmCnt);
+  for (i = 0; i < num; i++) {
+    stHdl = (Aed_St*)(stPtrs[i]);
+    if (stHdl->stCfg.enableFlag == 0) {
+      continue;
+    }
+    AUP_Aed_writeOutput(stHdl, frameEnergy[i], &pOuts[i]);
+  }
+  AUP_AED_TOC(tHop);
+  for (i = 0; i < num; i++) {
+    stHdl = (Aed_St*)(stPtrs[i]);
+    if (stHdl->stCfg.enableFlag != 0) {
+      AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_HOP, tHop / (uint64_t)num, 1);
+    }
+  }
 
-      analyzerInput.input = stHdl->inputEmphTimeFIFO;
-      analyzerInput.iLength = (int)stHdl->intHopSz;
-      analyzerOutput.output = stHdl->aivadInputCmplxSptrm;
-      analyzerOutput.oLength = (int)stHdl->intFftSz;
-      if (AUP_Analyzer_proc(stHdl->timeInAnalysis, &analyzerInput,
-                            &analyzerOutput) < 0) {
-        return -1;
-      }
+  return 0;
+}
 
-      AUP_Aed_CalcBinPow((int)stHdl->intNBins, stHdl->aivadInputCmplxSptrm,
-                         stHdl->aivadInputBinPow);
-      binPowPtr = stHdl->aivadInputBinPow;
+int AUP_Aed_procBuffer(void* stPtr, const Aed_InputData* pIns,
+                       Aed_OutputData* pOuts, int num) {
+  Aed_St* stHdl = (Aed_St*)(stPtr);
+  std::vector<float> feats;    // [frames][algCtxtSz * feaSz]
+  std::vector<float> scores;   // [frames]
+  std::vector<char> gated;     // [frames], frmGated of each frame
+  std::vector<int> hopFrmEnd;  // [num], frames prepared up to each hop
+  float frameEnergy;
+  float hopScore;
+  size_t featLen;
+  int h, f, k, nFrm, blkLen, ret;
+
+  if (stPtr == NULL || pIns == NULL || pOuts == NULL || num <= 0) {
+    return -1;
+  }
+  if (stHdl->stCfg.enableFlag == 0) {  // this module is disabled
+    return 0;
+  }
+  featLen = stHdl->algCtxtSz * stHdl->feaSz;
+  AUP_AED_TIC(tHop);
 
-      // update: stHdl->pitchFreq, stHdl->aivadScore
-      if (AUP_Aed_runOneFrm(stHdl, stHdl->inputTimeFIFO, (int)stHdl->intHopSz,
-                            binPowPtr, (int)stHdl->intNBins) < 0) {
+  // pass 1: the whole front end, none of it depends on the model output;
+  // the feature window of every prepared frame is kept for pass 2
+  hopFrmEnd.resize(num);
+  for (h = 0; h < num; h++) {
+    if (AUP_Aed_procInput(stHdl, &pIns[h], &frameEnergy) < 0) {
+      return -1;
+    }
+    while ((ret = AUP_Aed_prepNextFrm(stHdl, &pIns[h])) > 0) {
+      feats.insert(feats.end(), stHdl->aivadInputFeat,
+                   stHdl->aivadInputFeat + featLen);
+      gated.push_back((char)stHdl->frmGated);
+      AUP_Aed_advanceFrm(stHdl);
+    }
+    if (ret < 0) {
+      return -1;
+    }
+    // voiceProb and vadRes are overwritten after pass 2
+    AUP_Aed_writeOutput(stHdl, frameEnergy, &pOuts[h]);
+    hopFrmEnd[h] = (int)(feats.size() / featLen);
+  }
+
+  // pass 2: the model over the frame sequence, split where the periodic
+  // reset of the recurrent state falls and around skipped frames
+  nFrm = (int)(feats.size() / featLen);
+  scores.assign(nFrm, -1.0f);
+  hopScore = stHdl->aivadScore;
+  for (f = 0; f < nFrm; f += blkLen) {
+    stHdl->frmGated = gated[f];
+    if (AUP_Aed_skipInf(stHdl)) {
+      scores[f] = AUP_Aed_skipScore(stHdl);
+      AUP_Aed_aivad_post(stHdl, scores[f]);
+      blkLen = 1;
+      continue;
+    }
+    blkLen = AUP_AED_MIN(nFrm - f, AUP_AED_MAX((int)stHdl->aivadResetFrmNum -
+                                                   (int)stHdl->aivadResetCnt,
+                                               1));
+    if (stHdl->infStride > 1) {
+      blkLen = 1;  // the next decision depends on this score
+    }
+    for (k = 1; k < blkLen && !gated[f + k]; k++) {
+    }
+    blkLen = k;
+    stHdl->inferFrmNum += blkLen - 1;  // the first one was counted above
+    AUP_AED_STATS_FRM(AUP_AED_STATS_FRM_INFER, blkLen - 1);
+    if (stHdl->aivadInf != NULL) {
+      AUP_AED_TIC(tInf);
+      if (stHdl->aivadInf->ProcessSeq(feats.data() + f * featLen, blkLen,
+                                      scores.data() + f) != 0) {
         return -1;
       }
+      AUP_AED_TOC(tInf);
+      AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_INFER, tInf, blkLen);
+    }
+    for (k = 0; k < blkLen; k++) {
+      AUP_Aed_aivad_post(stHdl, scores[f + k]);
+    }
+  }
 
-      // update the inputTimeFIFO & inputEmphTimeFIFO.....
-      if (stHdl->inputTimeFIFOIdx > (int)stHdl->intHopSz) {
-        memcpy(stHdl->inputTimeFIFO, stHdl->inputTimeFIFO + stHdl->intHopSz,
-               sizeof(float) * (stHdl->inputTimeFIFOIdx - stHdl->intHopSz));
-        memcpy(stHdl->inputEmphTimeFIFO,
-               stHdl->inputEmphTimeFIFO + stHdl->intHopSz,
-               sizeof(float) * (stHdl->inputTimeFIFOIdx - stHdl->intHopSz));
-      }
-      stHdl->inputTimeFIFOIdx -= (int)stHdl->intHopSz;
+  for (h = 0; h < num; h++) {
+    if (hopFrmEnd[h] > 0) {
+      hopScore = scores[hopFrmEnd[h] - 1];
     }
+    pOuts[h].voiceProb = hopScore;
+    pOuts[h].vadRes = AUP_Aed_vadDecision(stHdl, hopScore);
   }
+  AUP_AED_TOC(tHop);
+  AUP_AED_STATS_ADD(stHdl, AUP_AED_STAGE_HOP, tHop, num);
 
-  // write to output res.
-  pOut->frameEnergy = frameEnergy / powerNormal;
-  pOut->frameRms = stHdl->frameRmsBuff[0];
-  pOut->pitchFreq = stHdl->pitchFreq;
-  pOut->voiceProb = stHdl->aivadScore;
-  if (pOut->voiceProb < 0.0f) {
-    pOut->vadRes = -1;
-  } else if (pOut->voiceProb <= stHdl->voiceDecideThresh) {
-    pOut->vadRes = 0;
-  } else {
-    pOut->vadRes = 1;
+  return 0;
+}
+
+// copy sz bytes of var into buf + pos (save != 0) or back, return the next
+// position; buf == NULL only advances it
+static size_t AUP_Aed_stateVar(char* buf, size_t pos, void* var, size_t sz,
+                               int save) {
+  if (buf != NULL && sz > 0) {
+    if (save) {
+      memcpy(buf + pos, var, sz);
+    } else {
+      memcpy(var, buf + pos, sz);
+    }
+  }
+  return pos + sz;
+}
+
+// copy the Aed section of a snapshot into buf (save != 0) or back from it,
+// return its size; buf == NULL only returns the size. The queued samples of
+// the FIFOs are saved from their read position and restored to the head
+static size_t AUP_Aed_stateIo(Aed_St* stHdl, char* buf, int save) {
+  size_t fifoSz = sizeof(float) * stHdl->inputTimeFIFOLen;
+  size_t pos = 0;
+  int pendLen = stHdl->inputTimeFIFOIdx - stHdl->inputTimeFIFORdIdx;
+
+#define AUP_AED_STATE_VAR(v) \
+  pos = AUP_Aed_stateVar(buf, pos, &(v), sizeof(v), save)
+  AUP_AED_STATE_VAR(pendLen);
+  if (buf != NULL) {
+    if (save) {
+      memcpy(buf + pos,
+             stHdl->inputTimeFIFO + stHdl->inputTimeFIFORdIdx,
+             sizeof(float) * pendLen);
+      memcpy(buf + pos + fifoSz,
+             stHdl->inputEmphTimeFIFO + stHdl->inputTimeFIFORdIdx,
+             sizeof(float) * pendLen);
+    } else {
+      memcpy(stHdl->inputTimeFIFO, buf + pos, sizeof(float) * pendLen);
+      memcpy(stHdl->inputEmphTimeFIFO, buf + pos + fifoSz,
+             sizeof(float) * pendLen);
+      stHdl->inputTimeFIFORdIdx = 0;
+      stHdl->inputTimeFIFOIdx = pendLen;
+    }
+  }
+  pos += 2 * fifoSz;
+  pos = AUP_Aed_stateVar(
+      buf, pos, stHdl->aivadInputFeatStack,
+      sizeof(float) * 2 * stHdl->algCtxtSz * stHdl->feaSz, save);
+  pos = AUP_Aed_stateVar(buf, pos, stHdl->frameRmsBuff,
+                         sizeof(float) * stHdl->frmRmsBufLen, save);
+  pos = AUP_Aed_stateVar(buf, pos, stHdl->inputFloatBuff,
+                         sizeof(float) * stHdl->stCfg.hopSz, save);
+
+  AUP_AED_STATE_VAR(stHdl->aedProcFrmCnt);
+  AUP_AED_STATE_VAR(stHdl->chunkFill);
+  AUP_AED_STATE_VAR(stHdl->chunkEnergy);
+  AUP_AED_STATE_VAR(stHdl->aivadResetCnt);
+  AUP_AED_STATE_VAR(stHdl->timeSignalPre);
+  AUP_AED_STATE_VAR(stHdl->aivadScore);
+  AUP_AED_STATE_VAR(stHdl->aivadScorePre);
+  AUP_AED_STATE_VAR(stHdl->gateQuietFrmCnt);
+  AUP_AED_STATE_VAR(stHdl->frmGated);
+  AUP_AED_STATE_VAR(stHdl->pitchEstStale);
+  AUP_AED_STATE_VAR(stHdl->lazyPitchHangCnt);
+  AUP_AED_STATE_VAR(stHdl->infStrideCnt);
+  AUP_AED_STATE_VAR(stHdl->frmSkipInf);
+  AUP_AED_STATE_VAR(stHdl->procFrmNum);
+  AUP_AED_STATE_VAR(stHdl->gatedFrmNum);
+  AUP_AED_STATE_VAR(stHdl->inferFrmNum);
+  AUP_AED_STATE_VAR(stHdl->pitchFreq);
+  AUP_AED_STATE_VAR(stHdl->frameRmsBuffIdx);
+  AUP_AED_STATE_VAR(stHdl->aivadInputFeatIdx);
+#undef AUP_AED_STATE_VAR
+  if (buf != NULL && !save) {
+    stHdl->aivadInputFeat =
+        stHdl->aivadInputFeatStack + stHdl->aivadInputFeatIdx * stHdl->feaSz;
+  }
+
+  return pos;
+}
+
+// header of a snapshot of stHdl, with the size of each section
+static int AUP_Aed_snapshotHdr(const Aed_St* stHdl, Aed_SnapshotHdr* hdr,
+                               size_t* totalSize) {
+  size_t sz = 0;
+  int idx;
+
+  memset(hdr, 0, sizeof(Aed_SnapshotHdr));
+  hdr->magic = AUP_AED_SNAPSHOT_MAGIC;
+  hdr->version = AUP_AED_SNAPSHOT_VERSION;
+  hdr->inputFs = (uint32_t)stHdl->stCfg.inputFs;
+  hdr->hopSz = (uint32_t)stHdl->stCfg.hopSz;
+  hdr->fftSz = (uint32_t)stHdl->stCfg.fftSz;
+  hdr->frqInputAvailableFlag = (uint32_t)stHdl->stCfg.frqInputAvailableFlag;
+
+  hdr->sectSz[AUP_AED_SNAPSHOT_AED] =
+      (uint32_t)AUP_Aed_stateIo((Aed_St*)stHdl, NULL, 1);
+  if (stHdl->aivadInf != NULL) {
+    hdr->sectSz[AUP_AED_SNAPSHOT_AIVAD] =
+        (uint32_t)AUP_MODULE_AIVAD::StateSize();
+  }
+  if (AUP_PE_getStateSize(stHdl->pitchEstStPtr, &sz) < 0) {
+    return -1;
+  }
+  hdr->sectSz[AUP_AED_SNAPSHOT_PITCH] = (uint32_t)sz;
+  if (stHdl->timeInAnalysis != NULL) {
+    if (AUP_Analyzer_getStateSize(stHdl->timeInAnalysis, &sz) < 0) {
+      return -1;
+    }
+    hdr->sectSz[AUP_AED_SNAPSHOT_ANALYZER] = (uint32_t)sz;
+  }
+  if (stHdl->fsCvrtStPtr != NULL) {
+    if (AUP_Fscvrt_getStateSize(stHdl->fsCvrtStPtr, &sz) < 0) {
+      return -1;
+    }
+    hdr->sectSz[AUP_AED_SNAPSHOT_FSCVRT] = (uint32_t)sz;
+  }
+
+  (*totalSize) = sizeof(Aed_SnapshotHdr);
+  for (idx = 0; idx < AUP_AED_SNAPSHOT_SECT_NUM; idx++) {
+    (*totalSize) += hdr->sectSz[idx];
+  }
+  return 0;
+}
+
+int AUP_Aed_getSnapshotSize(const void* stPtr, size_t* snapshotSize) {
+  Aed_SnapshotHdr hdr;
+
+  if (stPtr == NULL || snapshotSize == NULL) {
+    return -1;
+  }
+  return AUP_Aed_snapshotHdr((const Aed_St*)stPtr, &hdr, snapshotSize);
+}
+
+int AUP_Aed_snapshot(const void* stPtr, void* buf, size_t bufSize) {
+  Aed_St* stHdl = (Aed_St*)(stPtr);  // only read
+  Aed_SnapshotHdr hdr;
+  size_t totalSize = 0;
+  char* ptr = (char*)buf;
+
+  if (stPtr == NULL || buf == NULL) {
+    return -1;
+  }
+  if (AUP_Aed_snapshotHdr(stHdl, &hdr, &totalSize) < 0 ||
+      bufSize < totalSize) {
+    return -1;
+  }
+
+  memcpy(ptr, &hdr, sizeof(Aed_SnapshotHdr));
+  ptr += sizeof(Aed_SnapshotHdr);
+  AUP_Aed_stateIo(stHdl, ptr, 1);
+  ptr += hdr.sectSz[AUP_AED_SNAPSHOT_AED];
+  if (stHdl->aivadInf != NULL) {
+    stHdl->aivadInf->SaveState((float*)ptr);
+  }
+  ptr += hdr.sectSz[AUP_AED_SNAPSHOT_AIVAD];
+  if (AUP_PE_saveState(stHdl->pitchEstStPtr, ptr,
+                       hdr.sectSz[AUP_AED_SNAPSHOT_PITCH]) < 0) {
+    return -1;
+  }
+  ptr += hdr.sectSz[AUP_AED_SNAPSHOT_PITCH];
+  if (stHdl->timeInAnalysis != NULL &&
+      AUP_Analyzer_saveState(stHdl->timeInAnalysis, ptr,
+                             hdr.sectSz[AUP_AED_SNAPSHOT_ANALYZER]) < 0) {
+    return -1;
+  }
+  ptr += hdr.sectSz[AUP_AED_SNAPSHOT_ANALYZER];
+  if (stHdl->fsCvrtStPtr != NULL &&
+      AUP_Fscvrt_saveState(stHdl->fsCvrtStPtr, ptr,
+                           hdr.sectSz[AUP_AED_SNAPSHOT_FSCVRT]) < 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+int AUP_Aed_restore(void* stPtr, const void* buf, size_t bufSize) {
+  Aed_St* stHdl = (Aed_St*)(stPtr);
+  Aed_SnapshotHdr hdr;
+  Aed_SnapshotHdr bufHdr;
+  size_t totalSize = 0;
+  const char* ptr = (const char*)buf;
+
+  if (stPtr == NULL || buf == NULL || bufSize < sizeof(Aed_SnapshotHdr)) {
+    return -1;
+  }
+  if (AUP_Aed_snapshotHdr(stHdl, &hdr, &totalSize) < 0) {
+    return -1;
+  }
+  // the whole layout has to match before anything is overwritten
+  memcpy(&bufHdr, ptr, sizeof(Aed_SnapshotHdr));
+  if (bufSize != totalSize ||
+      memcmp(&bufHdr, &hdr, sizeof(Aed_SnapshotHdr)) != 0) {
+    return -1;
+  }
+
+  ptr += sizeof(Aed_SnapshotHdr);
+  AUP_Aed_stateIo(stHdl, (char*)ptr, 0);  // only read when loading
+  ptr += hdr.sectSz[AUP_AED_SNAPSHOT_AED];
+  if (stHdl->aivadInf != NULL) {
+    // the blob may not be aligned for float
+    float state[AUP_AED_STATE_FLOATS];
+    memcpy(state, ptr, sizeof(state));
+    stHdl->aivadInf->LoadState(state);
+  }
+  ptr += hdr.sectSz[AUP_AED_SNAPSHOT_AIVAD];
+  if (AUP_PE_loadState(stHdl->pitchEstStPtr, ptr,
+                       hdr.sectSz[AUP_AED_SNAPSHOT_PITCH]) < 0) {
+    return -1;
+  }
+  ptr += hdr.sectSz[AUP_AED_SNAPSHOT_PITCH];
+  if (stHdl->timeInAnalysis != NULL &&
+      AUP_Analyzer_loadState(stHdl->timeInAnalysis, ptr,
+                             hdr.sectSz[AUP_AED_SNAPSHOT_ANALYZER]) < 0) {
+    return -1;
+  }
+  ptr += hdr.sectSz[AUP_AED_SNAPSHOT_ANALYZER];
+  if (stHdl->fsCvrtStPtr != NULL &&
+      AUP_Fscvrt_loadState(stHdl->fsCvrtStPtr, ptr,
+                           hdr.sectSz[AUP_AED_SNAPSHOT_FSCVRT]) < 0) {
+    return -1;
   }
 
   return 0;
@@ -15,48 +15,122 @@
 
 #define AUP_AED_FS (16000)  // assumed input freq.
 
+// processing stages timed by the latency counters, see AUP_Aed_getStats
+#define AUP_AED_STAGE_STFT (0)   // analysis window, FFT and bin power
+#define AUP_AED_STAGE_MEL (1)    // mel filter-bank and AIVAD feature stack
+#define AUP_AED_STAGE_PITCH (2)  // pitch-estimation
+#define AUP_AED_STAGE_INFER (3)  // AIVAD model inference
+#define AUP_AED_STAGE_HOP (4)    // the whole processing of one input hop
+#define AUP_AED_STAGE_NUM (5)
+
+// precision of the AIVAD model, Aed_StaticCfg::modelPrecision
+#define AUP_AED_MODEL_FP32 (0)  // float32, as the ONNX model
+#define AUP_AED_MODEL_INT8 (1)  // int8 LSTM / dense weights, native backend
+                                // only
+
 // Configuration Parameters, which impacts dynamic memory occupation, can only
 // be set during allocation
 typedef struct Aed_StaticCfg_ {
   int enableFlag;  // flag to enable or disable this module
   // 0: disable, o.w.: enable
   size_t fftSz;               // fft-size, only support: 128, 256, 512, 1024
-  size_t hopSz;               // fft-Hop Size, will be used to check
+  size_t hopSz;               // fft-Hop Size, number of samples @ inputFs
+                              // per proc., will be used to check
   size_t anaWindowSz;         // fft-window Size, will be used to calc rms
   int frqInputAvailableFlag;  // whether Aed_InputData will contain external
-                              // freq. power-sepctra
+                              // freq. power-sepctra of fftSz, used instead
+                              // of the internal STFT if hopSz @ AUP_AED_FS
+                              // matches the internal hop (256)
+  const char* modelPath;      // path of the AIVAD model file, only read in
+                              // memAllocate, NULL: AUP_AED_DEFAULT_MODEL_PATH
+  const void* modelData;      // caller-owned AIVAD model in memory, used
+                              // instead of modelPath if not NULL, must stay
+                              // valid while the handler exists
+  size_t modelDataLen;        // size of modelData in bytes
+  int inputFs;                // input sampling freq. 8/16/24/32/48 kHz, 0:
+                              // AUP_AED_FS; other than AUP_AED_FS, the input
+                              // is resampled to AUP_AED_FS in front of the
+                              // analysis, hopSz * AUP_AED_FS has to be a
+                              // multiple of inputFs and frqInputAvailableFlag
+                              // has to be 0
+  int modelPrecision;         // AUP_AED_MODEL_xxx, the ONNX Runtime backend
+                              // runs the model file as it is and only takes
+                              // AUP_AED_MODEL_FP32
+  int fastMath;               // 0: libm logf / log10f / powf in the feature
+                              // and pitch paths, 1: the polynomial
+                              // AUP_FFTW_fastLog / fastExp (fftw.h)
 } Aed_StaticCfg;
 
+// latency of one processing stage, in ns
+typedef struct Aed_StageTiming_ {
+  uint64_t cnt;  // number of timed runs
+  uint64_t minNs;
+  uint64_t avgNs;
+  uint64_t p99Ns;  // 99th percentile, within a quarter octave
+  uint64_t maxNs;
+} Aed_StageTiming;
+
+typedef struct Aed_Stats_ {
+  uint64_t procFrms;   // see AUP_Aed_getFrmCnts
+  uint64_t gatedFrms;
+  uint64_t inferFrms;
+  Aed_StageTiming stage[AUP_AED_STAGE_NUM];  // [AUP_AED_STAGE_xxx]
+} Aed_Stats;
+
 // Configuraiton parameters which can be modified/set every frames
 typedef struct Aed_DynamCfg_ {
   float extVoiceThr;        // threshold for ai based voice decision [0,1]
   float extMusicThr;        // threshold for ai based music decision [0,1]
-  float extEnergyThr;       // threshold for energy based vad decision [0, ---]
+  float extEnergyThr;       // threshold for energy based vad decision, on the
+                            // rms of int16 samples [0, ---]
   size_t resetFrameNum;     // frame number for aivad reset [1875, 75000]
   float pitchEstVoicedThr;  // threshold for pitch-estimator to output estimated
                             // pitch
+  int energyGateFlag;  // 1: skip pitch-est. and AIVAD inference on frames
+                       // below extEnergyThr, 0: always run them
+  size_t energyGateHangFrm;  // number of consecutive frames below extEnergyThr
+                             // before gating starts [0, ---]
+  size_t infStride;       // run AIVAD inference on every infStride-th frame
+                          // and hold its result in between [1, ---]
+  float infStrideMargin;  // run on every frame while the voice probability
+                          // is within this margin of extVoiceThr [0, 1]
+  int lazyPitchFlag;  // 1: run the pitch-estimator only on frames a zero-
+                      // crossing and low-band energy check finds possibly
+                      // voiced, and take a pitch of 0 on the others, 0: run
+                      // it on every frame
 } Aed_DynamCfg;
 
 // Spectrum are assumed to be generated with time-domain samples in [-32768,
-// 32767] with or without pre-emphasis operation
+// 32767] without pre-emphasis operation, which is applied to them as a
+// spectral tilt |1 - 0.97 * e^(-jw)|^2; unnormalized DFT power of a frame
+// ending with this hop, as the internal 768-point Hann window in a 1024-point
+// FFT, gives the levels the AIVAD model was trained on
+// sample formats of Aed_InputData.timeSignal; the int16 and normalized float
+// inputs are converted while the input FIFOs are written, a frame of
+// x / 32768 in AUP_AED_SAMPLE_F32 gives the same results as x itself
+#define AUP_AED_SAMPLE_FLT (0)  // float, in [-32768, 32767]
+#define AUP_AED_SAMPLE_S16 (1)  // int16
+#define AUP_AED_SAMPLE_F32 (2)  // float, in [-1.0, 1.0]
+
 typedef struct Aed_InputData_ {
   const float* binPower;  // [NBins], power spectrum of 16KHz samples
   int nBins;
-  const float*
-      timeSignal;  // [hopSz]   // this frame's input signal, in [-32768, 32767]
-  int hopSz;       // should be equal to StaticCfg->hopSz
+  const void* timeSignal;  // [hopSz]   // this frame's input signal
+  int sampleType;          // format of timeSignal, AUP_AED_SAMPLE_*
+  int hopSz;               // should be equal to StaticCfg->hopSz
 } Aed_InputData;
 
 // return data from statistical ns module
 typedef struct Aed_OutputData_ {
   float frameEnergy;  // frame energy for input normalized data
   float frameRms;     // rms for input int16 data
-  int energyVadRes;  // vad res 0/1 with extEnergyThreshold based on input frame
-                     // energy
+  int energyVadRes;  // vad res 0/1 with extEnergyThr based on frameRms
   float voiceProb;   // vad score [0,1]
   int vadRes;  // vad res 0/1 with extVoiceThr based on ai method, t + 16ms res
                // correspond to the t input
   float pitchFreq;  // estimated pitch freq.
+  uint64_t procFrmNum;  // frames processed since init, including the ones
+                        // completed by this input, see AUP_Aed_getFrmTiming
 } Aed_OutputData;
 
 #ifdef __cplusplus
@@ -79,6 +153,49 @@ extern "C" {
  */
 int AUP_Aed_create(void** stPtr);
 
+/****************************************************************************
+ * AUP_Aed_GetMemSize(...)
+ *
+ * This function returns the memory required by _createIn for a handler
+ * configured with pCfg, covering the state handler, its dynamic memory and
+ * all the submodules (AI-VAD inference state, pitch-estimator with its
+ * biquad filter, STFT analyzer)
+ *
+ * Input:
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - memSize       : required memory size in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_getMemSize(const Aed_StaticCfg* pCfg, size_t* memSize);
+
+/****************************************************************************
+ * AUP_Aed_CreateIn(...)
+ *
+ * This function creats a state handler inside caller provided memory, the
+ * handler and its submodules allocate no dynamic memory afterwards, only the
+ * shared model (and the few tensor descriptors of ONNX Runtime) live outside.
+ * _memAllocate has to be called with the same pCfg (or one requiring less
+ * memory); _destroy won't release mem
+ *
+ * Input:
+ *      - mem           : caller's memory, 8-byte aligned, which has to
+ *                        outlive the handler
+ *      - memSize       : size of mem, at least what _getMemSize returns
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - stPtr         : buffer to store the returned state handler
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_createIn(void** stPtr, void* mem, size_t memSize,
+                     const Aed_StaticCfg* pCfg);
+
 /****************************************************************************
  * AUP_Aed_Destroy(...)
  *
@@ -118,7 +235,9 @@ int AUP_Aed_memAllocate(void* stPtr, const Aed_StaticCfg* pCfg);
  * AUP_Aed_init(...)
  *
  * This function resets (initialize) the VAD module and gets it prepared for
- * processing
+ * processing. Only the signal state (FIFOs, pitch-estimator memory, STFT
+ * queue, AI-VAD hidden state) is cleared; the constant tables set up in
+ * memAllocate are kept, so this is cheap enough to recycle handlers.
  *
  * Input:
  *      - stPtr         : State Handler which has gone through create and
@@ -200,6 +319,28 @@ int AUP_Aed_getDynamCfg(const void* stPtr, Aed_DynamCfg* pCfg);
  */
 int AUP_Aed_getAlgDelay(const void* stPtr, int* delayInFrms);
 
+/****************************************************************************
+ * AUP_Aed_getFrmTiming(...)
+ *
+ * This function gets where the processed frames lie in the input signal:
+ * once procFrmNum frames are processed, voiceProb and vadRes describe the
+ * input samples [(procFrmNum - 1) * frmLen - delay, procFrmNum * frmLen -
+ * delay) since init, delay covering the algorithm delay of
+ * AUP_Aed_getAlgDelay and that of the sampling-rate converter
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *
+ * Output:
+ *      - frmLen        : length of a processing frame, in samples @ inputFs
+ *      - delay         : delay of the results, in samples @ inputFs
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_getFrmTiming(const void* stPtr, int* frmLen, int* delay);
+
 /****************************************************************************
  * AUP_Aed_proc(...)
  *
@@ -219,6 +360,184 @@ int AUP_Aed_getAlgDelay(const void* stPtr, int* delayInFrms);
  */
 int AUP_Aed_proc(void* stPtr, const Aed_InputData* pIn, Aed_OutputData* pOut);
 
+/****************************************************************************
+ * AUP_Aed_procChunk(...)
+ *
+ * process a chunk of any length, pIn->hopSz samples @ inputFs: the chunk is
+ * reframed into hops of StaticCfg->hopSz, a trailing partial hop is kept for
+ * the next call, and every completed hop gets the output AUP_Aed_proc would
+ * give it; the handler must not be passed to _proc, _procBatch or
+ * _procBuffer while a partial hop is pending. Only for handlers doing the
+ * internal STFT analysis
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate and reset
+ *      - pIn           : input data stream, binPower and nBins are unused
+ *      - maxOuts       : size of pOuts, at least (pending + pIn->hopSz) /
+ *                        StaticCfg->hopSz, pending < StaticCfg->hopSz
+ *
+ * Output:
+ *      - pOuts         : output data of the completed hops, in time order
+ *      - nOuts         : number of completed hops
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_procChunk(void* stPtr, const Aed_InputData* pIn,
+                      Aed_OutputData* pOuts, int maxOuts, int* nOuts);
+
+/****************************************************************************
+ * AUP_Aed_procBatch(...)
+ *
+ * process a single frame on each of num handlers, running the AI-VAD model
+ * of all handlers sharing one model in a single batched inference
+ *
+ * Input:
+ *      - stPtrs        : array of num State Handlers which have gone through
+ *                        create and memAllocate and reset
+ *      - pIns          : array of num input data streams
+ *      - num           : number of handlers
+ *
+ * Output:
+ *      - pOuts         : array of num output data
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_procBatch(void* const* stPtrs, const Aed_InputData* pIns,
+                      Aed_OutputData* pOuts, int num);
+
+/****************************************************************************
+ * AUP_Aed_procBuffer(...)
+ *
+ * process num consecutive frames of one handler, with the same results as
+ * num calls of AUP_Aed_proc; the front end of all frames runs first and the
+ * AI-VAD model then runs over the whole frame sequence, the features of all
+ * frames are buffered in between
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate and reset
+ *      - pIns          : array of num input data in time order
+ *      - num           : number of frames
+ *
+ * Output:
+ *      - pOuts         : array of num output data
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_procBuffer(void* stPtr, const Aed_InputData* pIns,
+                       Aed_OutputData* pOuts, int num);
+
+/****************************************************************************
+ * AUP_Aed_getFrmCnts(...)
+ *
+ * This function gets the number of internal frames processed since the last
+ * init, how many of them were gated by energyGateFlag, i.e. went without
+ * pitch-estimation and AIVAD inference, and on how many the AIVAD model ran
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *
+ * Output:
+ *      - procFrms      : number of processed frames
+ *      - gatedFrms     : number of gated frames
+ *      - inferFrms     : number of frames with AIVAD inference, NULL if not
+ *                        needed
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_getFrmCnts(const void* stPtr, uint64_t* procFrms,
+                       uint64_t* gatedFrms, uint64_t* inferFrms);
+
+/****************************************************************************
+ * AUP_Aed_getStats(...)
+ *
+ * This function gets the frame counters, see AUP_Aed_getFrmCnts, and the
+ * latency of each processing stage AUP_AED_STAGE_xxx since the last init,
+ * or the process-wide aggregate of all handlers since the process started;
+ * the latencies are 0 when built with AUP_AED_STATS 0. Runs timed as a group
+ * (batched or sequence inference, the hops of procBatch and procBuffer)
+ * count as that many runs of their average latency
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate, NULL for the process-wide aggregate
+ *
+ * Output:
+ *      - pStats        : frame counters and per-stage latencies
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error, or the aggregate is requested while
+ *                             built with AUP_AED_STATS 0
+ */
+int AUP_Aed_getStats(const void* stPtr, Aed_Stats* pStats);
+
+/****************************************************************************
+ * AUP_Aed_getSnapshotSize(...)
+ *
+ * This function returns the size of a snapshot of the handler, which only
+ * depends on the static config
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *
+ * Output:
+ *      - snapshotSize  : size of the snapshot in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_getSnapshotSize(const void* stPtr, size_t* snapshotSize);
+
+/****************************************************************************
+ * AUP_Aed_snapshot(...)
+ *
+ * This function writes the signal state of the handler and all submodules
+ * into buf: the queued input samples, feature stack, AI-VAD recurrent state,
+ * pitch-estimator memory, STFT queue, resampler and filter registers and the
+ * frame counters, behind a versioned header with the static config; the
+ * configs, constant tables and latency counters are not part of it
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate and init
+ *      - bufSize       : size of buf, at least what _getSnapshotSize returns
+ *
+ * Output:
+ *      - buf           : the snapshot, _getSnapshotSize bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_snapshot(const void* stPtr, void* buf, size_t bufSize);
+
+/****************************************************************************
+ * AUP_Aed_restore(...)
+ *
+ * This function replaces the signal state of the handler with a snapshot,
+ * afterwards it continues exactly where the snapshotted handler was; the
+ * static config has to be the same, the dynamic config of the handler is
+ * kept. Nothing is changed if the snapshot doesn't fit the handler
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate and init
+ *      - buf           : snapshot written by AUP_Aed_snapshot
+ *      - bufSize       : size of buf, has to equal the snapshot size
+ *
+ * Output:
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Aed_restore(void* stPtr, const void* buf, size_t bufSize);
+
 #ifdef __cplusplus
 }
 #endif
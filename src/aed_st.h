@@ -8,7 +8,19 @@
 #define __AED_ST_H__
 
 #include <stdio.h>
+#include <atomic>
+
+// 0: run the AI-VAD model with ONNX Runtime
+// 1: run the AI-VAD model with the compiled-in native network (aivad_net.h)
+#ifndef AUP_AED_NATIVE_AIVAD
+#define AUP_AED_NATIVE_AIVAD (0)
+#endif
+
+#if !AUP_AED_NATIVE_AIVAD
 #include <onnxruntime_c_api.h>
+#else
+#include "aivad_net.h"
+#endif
 
 #include "aed.h"
 
@@ -31,40 +43,179 @@
 #define AUP_AED_PITCH_EST_DEFAULT_VOICEDTHR (0.4f)
 #endif
 
+// resampler engine of the inputFs -> AUP_AED_FS front end for inputFs above
+// AUP_AED_FS; 8kHz input always goes through the biquad engine: its images
+// above 4kHz get the AIVAD closer to the wide-band scores than an anti-imaged
+// narrow-band signal does
+#ifndef AUP_AED_FSCVRT_DOWN_ENGINE
+#define AUP_AED_FSCVRT_DOWN_ENGINE AUP_FSCVRT_ENGINE_POLYPHASE
+#endif
+
+// per-stage latency counters, see AUP_Aed_getStats; 0 compiles them out
+#ifndef AUP_AED_STATS
+#define AUP_AED_STATS (1)
+#endif
+// latency histogram: one bucket per ns below AUP_AED_STATS_LIN_BUCKETS ns,
+// then 4 per octave up to 2^32 ns, later values land in the last bucket
+#define AUP_AED_STATS_LIN_BUCKETS (16)
+#define AUP_AED_STATS_NBUCKETS (128)
+
+// upper bound of the packed mel filter-bank weights: the triangles of
+// neighbouring bands overlap once, so every bin is covered at most twice
+#define AUP_AED_MEL_MAX_FFTSZ (1024)
+#define AUP_AED_MEL_MAX_COEF_NUM (2 * ((AUP_AED_MEL_MAX_FFTSZ >> 1) + 1))
+
 #define AUP_AED_MODEL_IO_NUM (5)
 #define AUP_AED_MODEL_NAME_LENGTH (32)
+#define AUP_AED_MODEL_PATH_LENGTH (512)
+#define AUP_AED_DEFAULT_MODEL_PATH "onnx_model/ten-vad.onnx"
 #define AUP_AED_MODEL_HIDDEN_DIM (64)
 
+// state snapshot, see AUP_Aed_snapshot: the header is followed by the
+// sections AUP_AED_SNAPSHOT_xxx in this order; the magic also tells a blob of
+// the other byte order apart
+#define AUP_AED_SNAPSHOT_MAGIC (0x44415654u)  // "TVAD"
+#define AUP_AED_SNAPSHOT_VERSION (2)
+#define AUP_AED_SNAPSHOT_AED (0)       // Aed variables, FIFOs, feature stack
+#define AUP_AED_SNAPSHOT_AIVAD (1)     // AI-VAD recurrent state
+#define AUP_AED_SNAPSHOT_PITCH (2)     // pitch-estimator
+#define AUP_AED_SNAPSHOT_ANALYZER (3)  // STFT analysis queue
+#define AUP_AED_SNAPSHOT_FSCVRT (4)    // resampler, empty @ AUP_AED_FS
+#define AUP_AED_SNAPSHOT_SECT_NUM (5)
+#define AUP_AED_STATE_FLOATS \
+  ((AUP_AED_MODEL_IO_NUM - 1) * AUP_AED_MODEL_HIDDEN_DIM)
+
+typedef struct Aed_SnapshotHdr_ {
+  uint32_t magic;    // AUP_AED_SNAPSHOT_MAGIC
+  uint32_t version;  // AUP_AED_SNAPSHOT_VERSION
+  // static config the snapshot can only be restored with
+  uint32_t inputFs;
+  uint32_t hopSz;
+  uint32_t fftSz;
+  uint32_t frqInputAvailableFlag;
+  uint32_t sectSz[AUP_AED_SNAPSHOT_SECT_NUM];  // bytes of each section
+} Aed_SnapshotHdr;
+
+// per-frame decay of the voice probability held while frames are gated
+#define AUP_AED_GATE_SCORE_DECAY (0.5f)
+#define AUP_AED_GATE_DEFAULT_HANG_FRM (8)  // 128ms
+// voicing check of the lazy pitch-estimator, see Aed_DynamCfg::lazyPitchFlag:
+// a frame may be voiced when at most AUP_AED_LAZY_PITCH_ZCR_THR of its sample
+// pairs cross zero and at least AUP_AED_LAZY_PITCH_BAND_RATIO of its power
+// lies in [AUP_AED_LAZY_PITCH_BAND_LO, AUP_AED_LAZY_PITCH_BAND_HI) Hz
+#define AUP_AED_LAZY_PITCH_ZCR_THR (0.25f)
+#define AUP_AED_LAZY_PITCH_BAND_RATIO (0.5f)
+#define AUP_AED_LAZY_PITCH_BAND_LO (60)
+#define AUP_AED_LAZY_PITCH_BAND_HI (1000)
+// frames the pitch-estimator keeps running after the last possibly voiced one
+#define AUP_AED_LAZY_PITCH_HANG_FRM (4)  // 64ms
+
+#if !AUP_AED_NATIVE_AIVAD
+// Parsed model shared by all AI-VAD instances loaded from the same path or
+// the same caller-owned model buffer.
+// Instances are reference counted in a process-wide registry, so the ORT
+// environment, session and weights are only created once per process.
+class AUP_AIVAD_MODEL {
+ public:
+  static AUP_AIVAD_MODEL* Acquire(const char* onnx_path, const void* model_data,
+                                  size_t model_data_len);
+  static void Release(AUP_AIVAD_MODEL* model);
+
+  const OrtApi* ort_api = NULL;
+  OrtSession* ort_session = NULL;
+  OrtMemoryInfo* memory_info = NULL;
+  const char* input_names[AUP_AED_MODEL_IO_NUM] = {NULL};
+  const char* output_names[AUP_AED_MODEL_IO_NUM] = {NULL};
+  // cleared once a batched Run has been rejected by the model
+  std::atomic<int> batch_supported{1};
+
+ private:
+  AUP_AIVAD_MODEL(const char* onnx_path, const void* model_data,
+                  size_t model_data_len);
+  ~AUP_AIVAD_MODEL();
+  int Load();
+
+  char model_path[AUP_AED_MODEL_PATH_LENGTH] = {0};
+  const void* model_data = NULL;  // if not NULL, used instead of model_path
+  size_t model_data_len = 0;
+  int ref_cnt = 0;
+  AUP_AIVAD_MODEL* next = NULL;
+
+  char input_names_buf[AUP_AED_MODEL_IO_NUM][AUP_AED_MODEL_NAME_LENGTH] = {{0}};
+  char output_names_buf[AUP_AED_MODEL_IO_NUM][AUP_AED_MODEL_NAME_LENGTH] = {
+      {0}};
+};
+
+#endif
+
+// Per-handle AI-VAD instance: only the recurrent state and the I/O tensors
+// bound to it live here, the model itself is shared. The native backend
+// ignores the model source and uses the compiled-in weights.
 class AUP_MODULE_AIVAD {
  public:
-  AUP_MODULE_AIVAD(char* onnx_path);
+  AUP_MODULE_AIVAD(const char* onnx_path, const void* model_data = NULL,
+                   size_t model_data_len = 0,
+                   int precision = AUP_AED_MODEL_FP32);
   ~AUP_MODULE_AIVAD();
   int Process(float* input, float* output);
+  // run num consecutive frames of this instance, inputs is [num][3 * 41]
+  int ProcessSeq(float* inputs, int num, float* outputs);
   int Reset();
+  int IsInited() const { return inited; }
+  // recurrent state fed to the next inference, see AUP_Aed_snapshot
+  static size_t StateSize() { return sizeof(float) * AUP_AED_STATE_FLOATS; }
+  void SaveState(float* state) const;
+  void LoadState(const float* state);
+  // run num instances sharing one model in a single batched inference
+  static int ProcessBatch(AUP_MODULE_AIVAD* const* insts, float* const* inputs,
+                          float* outputs, int num);
 
  private:
+#if !AUP_AED_NATIVE_AIVAD
+  AUP_AIVAD_MODEL* model = NULL;
   const OrtApi* ort_api = NULL;
-  OrtAllocator* ort_allocator = NULL;
-  OrtEnv* ort_env = NULL;
-  OrtSession* ort_session = NULL;
+#else
+  int net_precision = AUP_AIVAD_PREC_FP32;
+#endif
   int inited = 0;
   int clear_hidden = 0;
 
-  char input_names_buf[AUP_AED_MODEL_IO_NUM][AUP_AED_MODEL_NAME_LENGTH] = {{0}};
-  const char* input_names[AUP_AED_MODEL_IO_NUM] = {NULL};
   float input_data_buf_0[AUP_AED_CONTEXT_WINDOW_LEN * AUP_AED_FEA_LEN] = {0};
   float input_data_buf_1234[AUP_AED_MODEL_IO_NUM - 1]
-                           [AUP_AED_MODEL_HIDDEN_DIM] = {{0}};
-  OrtValue* ort_input_tensors[AUP_AED_MODEL_IO_NUM] = {NULL};
+                           [AUP_AED_MODEL_HIDDEN_DIM] = {{0}};  // state
 
-  char output_names_buf[AUP_AED_MODEL_IO_NUM][AUP_AED_MODEL_NAME_LENGTH] = {{0}};
-  const char* output_names[AUP_AED_MODEL_IO_NUM] = {NULL};
+  float output_data_buf_0[1] = {0};
+  float output_data_buf_1234[AUP_AED_MODEL_IO_NUM - 1]
+                            [AUP_AED_MODEL_HIDDEN_DIM] = {{0}};
+#if !AUP_AED_NATIVE_AIVAD
+  OrtValue* ort_input_tensors[AUP_AED_MODEL_IO_NUM] = {NULL};
   OrtValue* ort_output_tensors[AUP_AED_MODEL_IO_NUM] = {NULL};
+#endif
 };
 
+// Banded mel filter-bank, read-only and shared by all handlers once built
+typedef struct Aed_MelFilterBank_ {
+  size_t fftSz;
+  size_t melFbSz;
+  size_t bandStart[AUP_AED_MEL_FILTER_BANK_NUM];   // first non-zero bin
+  size_t bandLen[AUP_AED_MEL_FILTER_BANK_NUM];     // number of non-zero bins
+  size_t bandOffset[AUP_AED_MEL_FILTER_BANK_NUM];  // offset into coef
+  float coef[AUP_AED_MEL_MAX_COEF_NUM];            // packed band weights
+} Aed_MelFilterBank;
+
+// latency record of one processing stage, see AUP_AED_STAGE_xxx
+typedef struct Aed_StageStats_ {
+  uint64_t cnt;    // timed runs
+  uint64_t sumNs;  // their total time
+  uint64_t minNs;
+  uint64_t maxNs;
+  uint32_t hist[AUP_AED_STATS_NBUCKETS];  // runs per latency bucket
+} Aed_StageStats;
+
 typedef struct Aed_St_ {
   void* dynamMemPtr;    // memory pointer holding the dynamic memory
   size_t dynamMemSize;  // size of the buffer *dynamMemPtr
+  int extMemFlag;  // 1: handler and all submodules live in caller's memory
 
   Aed_StaticCfg stCfg;
 
@@ -72,7 +223,7 @@ typedef struct Aed_St_ {
 
   // Internal Static Config Registers, which are generated from stCfg
   size_t extFftSz;  // externally decided FFT-Sz
-  size_t extHopSz;  // externally decided FFT-Hop-Sz
+  size_t extHopSz;  // externally decided FFT-Hop-Sz, @ AUP_AED_FS
   size_t extNBins;  // (FFTSz/2) + 1
   size_t extWinSz;  // externally decided FFT-Window-Sz
 
@@ -85,7 +236,8 @@ typedef struct Aed_St_ {
   // 0: directly use external spectrum
   // 1: use external spectrum with interpolation / exterpolation
   // 2: need to redo analysis based on input time-domain signal
-  size_t inputTimeFIFOLen;  // length of input FIFO buffer
+  size_t inputTimeFIFOLen;  // max. number of samples queued in input FIFO
+  size_t inputTimeFIFOCap;  // allocated length of input FIFO buffer
   // if = 0: no need for input time-domain FIFO Queue
 
   // Internal static config registers for pitch-est module
@@ -98,20 +250,35 @@ typedef struct Aed_St_ {
   // Internal dynamic Config Registers, which are generated from dynamCfg
   size_t aivadResetFrmNum;
   float voiceDecideThresh;
+  float energyThresh;  // of frameRms, for energyVadRes and the energy gate
+  int energyGateFlag;
+  size_t energyGateHangFrm;
+  size_t infStride;
+  float infStrideMargin;
+  int lazyPitchFlag;
 
   // SubModules
   AUP_MODULE_AIVAD* aivadInf;
+  void* aivadInfMem;  // caller's memory reserved for *aivadInf, or NULL
 
   void* pitchEstStPtr;  // pitch-estimation module handler
   void* timeInAnalysis;
   // state handler of STFT analysis module
+  void* fsCvrtStPtr;  // sampling-rate converter inputFs -> AUP_AED_FS, only
+                      // used when stCfg.inputFs != AUP_AED_FS, may be NULL
 
   // Variables
   int aedProcFrmCnt;  // counter of consecutive AI-VAD processed frames
-  int inputTimeFIFOIdx;
-  float* inputTimeFIFO;  // [inputTimeFIFOLen]
-  // input fifo buffer of time-signal to adjust between extHopSz and intHopSz
-  float* inputEmphTimeFIFO;     // [inputTimeFIFOLen]
+  int inputTimeFIFOIdx;    // write position, end of the queued samples
+  int inputTimeFIFORdIdx;  // read position, start of the queued samples
+  size_t chunkFill;    // samples of the hop AUP_Aed_procChunk is reframing,
+                       // in the FIFOs @ AUP_AED_FS, else in inputFloatBuff
+  float chunkEnergy;   // energy of the chunkFill samples @ AUP_AED_FS
+  float* inputTimeFIFO;  // [inputTimeFIFOCap]
+  // input fifo buffer of time-signal to adjust between extHopSz and intHopSz,
+  // frames are read in place and the queue is only compacted when the write
+  // position would run past inputTimeFIFOCap
+  float* inputEmphTimeFIFO;     // [inputTimeFIFOCap]
   float* aivadInputCmplxSptrm;  // [intFftSz]
   float* aivadInputBinPow;      // [intNBins]  // AIVAD input power spectrum
   size_t aivadResetCnt;
@@ -119,14 +286,50 @@ typedef struct Aed_St_ {
   float aivadScore;
   float aivadScorePre;
 
+  // energy gate, see Aed_DynamCfg::energyGateFlag: while gated, the feature
+  // stack and the FIFOs are still updated, the AIVAD recurrent state is held
+  // and the pitch-estimator, whose memory goes stale, is re-initialized on
+  // the first frame after the gate
+  size_t gateQuietFrmCnt;  // consecutive frames below energyThresh
+  int frmGated;            // whether the prepared frame is gated
+  int pitchEstStale;       // pitch-estimator skipped since its last run
+  // lazy pitch-estimator, see Aed_DynamCfg::lazyPitchFlag: frames failing the
+  // voicing check skip it like gated ones
+  size_t lazyPitchHangCnt;  // frames left to run it after the last possibly
+                            // voiced one
+  // strided inference, see Aed_DynamCfg::infStride: the recurrent state is
+  // held over the skipped frames as well
+  size_t infStrideCnt;     // frames skipped since the last inference
+  int frmSkipInf;          // whether the model skips the prepared frame
+  // batch processing: the STFT, power spectrum and mel features of the
+  // pending frame are already done across handlers, see AUP_Aed_prepLanes
+  int frmLanesDone;
+  uint64_t frmLanesMelNs;  // share of the handler in that mel projection
+  uint64_t procFrmNum;     // frames processed since init
+  uint64_t gatedFrmNum;    // frames gated since init
+  uint64_t inferFrmNum;    // frames with AIVAD inference since init
+#if AUP_AED_STATS
+  Aed_StageStats stageStats[AUP_AED_STAGE_NUM];  // since init
+#endif
+
   float pitchFreq;      // input audio pitch in Hz
-  float* frameRmsBuff;  // [frmRmsBufLen], FIFO, to delay frmRms result so that
-                        // it aligns with AIVAD result
-  float* aivadInputFeatStack;  // [...] = [AUP_AED_CONTEXT_WINDOW_LEN *
-                               // AUP_AED_FEA_LEN]
-  float* melFilterBankCoef;    // [melFbSz][nBins]
-  size_t* melFilterBinBuff;    // [melFbSz + 2]
-  float* inputFloatBuff;       // [hopSz]
+  float* frameRmsBuff;  // [frmRmsBufLen], circular FIFO, to delay frmRms
+                        // result so that it aligns with AIVAD result
+  int frameRmsBuffIdx;  // position of the oldest value in frameRmsBuff
+  float* aivadInputFeatStack;  // [...] = [2 * AUP_AED_CONTEXT_WINDOW_LEN *
+                               // AUP_AED_FEA_LEN], mirrored
+  // every feature frame is written at row idx and idx + algCtxtSz, so that
+  // aivadInputFeat always points to algCtxtSz contiguous frames, oldest first
+  int aivadInputFeatIdx;   // row of the oldest feature frame
+  float* aivadInputFeat;   // = aivadInputFeatStack + idx * feaSz
+  const Aed_MelFilterBank* melFb;  // shared, see AUP_Aed_getMelFilterBank
+  const float* emphTilt;  // [intNBins], shared, see AUP_Aed_getEmphTilt
+  float* inputFloatBuff;       // [hopSz], @ inputFs, int16 / normalized
+                               // input or the hop being reframed by
+                               // AUP_Aed_procChunk, for the resampler
+  void* pushQueue;  // queues of ten_vad_push(), owned by ten_vad.cc, or NULL
+  void* segmenter;  // state of ten_vad_segmenter_start(), owned by
+                    // ten_vad.cc, or NULL
 } Aed_St;
 
 #endif
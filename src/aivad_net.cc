@@ -0,0 +1,542 @@
+//
+// Copyright © 2025 Agora
+// This file is part of TEN Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "aivad_net.h"
+#include "aivad_coeff.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define AUP_AIVAD_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AUP_AIVAD_SIMD_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUP_AIVAD_SIMD_NEON
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define AUP_AIVAD_SIMD_WASM
+#endif
+
+// matrix-vector products work on tiles of this many outputs
+#define AUP_AIVAD_MATVEC_TILE (32)
+
+#define AUP_AIVAD_MAX(x, y) (((x) > (y)) ? (x) : (y))
+
+// largest nIn of the quantized matrices (dense-0 on [h1, h0])
+#define AUP_AIVAD_QMAT_MAX_IN (2 * AUP_AIVAD_HIDDEN)
+
+// int8 weight matrix of AUP_AIVAD_PREC_INT8: q[nIn / 2][nOut][2] keeps the
+// weights of two consecutive inputs next to each other, so that one 16 x 16
+// bit multiply-add of a pair gives an int32 partial sum of one output
+typedef struct AivadNet_QMat_ {
+  const int8_t* q;
+  const float* scale;  // [nOut], weight = q * scale
+} AivadNet_QMat;
+
+// int8 copies of the four LSTM matrices (input and recurrent parts kept
+// apart) and of dense-0, built from the float32 weights on first use
+typedef struct AivadNet_Int8Model_ {
+  int8_t lstm0x[AUP_AIVAD_LSTM0_IN * AUP_AIVAD_GATES];
+  int8_t lstm0h[AUP_AIVAD_HIDDEN * AUP_AIVAD_GATES];
+  int8_t lstm1x[AUP_AIVAD_HIDDEN * AUP_AIVAD_GATES];
+  int8_t lstm1h[AUP_AIVAD_HIDDEN * AUP_AIVAD_GATES];
+  int8_t dense0[AUP_AIVAD_QMAT_MAX_IN * AUP_AIVAD_DENSE0_OUT];
+  float lstm0xScale[AUP_AIVAD_GATES];
+  float lstm0hScale[AUP_AIVAD_GATES];
+  float lstm1xScale[AUP_AIVAD_GATES];
+  float lstm1hScale[AUP_AIVAD_GATES];
+  float dense0Scale[AUP_AIVAD_DENSE0_OUT];
+} AivadNet_Int8Model;
+
+// the matrices of one network evaluation, q* are NULL for float32
+typedef struct AivadNet_Weights_ {
+  const AivadNet_QMat* lstm0x;
+  const AivadNet_QMat* lstm0h;
+  const AivadNet_QMat* lstm1x;
+  const AivadNet_QMat* lstm1h;
+  const AivadNet_QMat* dense0;
+} AivadNet_Weights;
+
+/// ///////////////////////////////////////////////////////////////////////
+/// Internal Utils
+/// ///////////////////////////////////////////////////////////////////////
+
+// y[nOut] += x[nIn] * wt[nIn][nOut], nOut has to be a multiple of
+// AUP_AIVAD_MATVEC_TILE; the transposed layout lets every input broadcast
+// against contiguous weights, no horizontal sums are needed
+static void AUP_AivadNet_matVecAcc(const float* wt, const float* x, int nIn,
+                                   int nOut, float* y) {
+  int o, k;
+  for (o = 0; o < nOut; o += AUP_AIVAD_MATVEC_TILE) {
+    const float* w = wt + o;
+#if defined(AUP_AIVAD_SIMD_AVX2)
+    __m256 acc0 = _mm256_loadu_ps(y + o);
+    __m256 acc1 = _mm256_loadu_ps(y + o + 8);
+    __m256 acc2 = _mm256_loadu_ps(y + o + 16);
+    __m256 acc3 = _mm256_loadu_ps(y + o + 24);
+    for (k = 0; k < nIn; k++, w += nOut) {
+      __m256 xb = _mm256_set1_ps(x[k]);
+#if defined(__FMA__)
+      acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w), xb, acc0);
+      acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(w + 8), xb, acc1);
+      acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(w + 16), xb, acc2);
+      acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(w + 24), xb, acc3);
+#else
+      acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(w), xb));
+      acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(w + 8), xb));
+      acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_loadu_ps(w + 16), xb));
+      acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_loadu_ps(w + 24), xb));
+#endif
+    }
+    _mm256_storeu_ps(y + o, acc0);
+    _mm256_storeu_ps(y + o + 8, acc1);
+    _mm256_storeu_ps(y + o + 16, acc2);
+    _mm256_storeu_ps(y + o + 24, acc3);
+#elif defined(AUP_AIVAD_SIMD_SSE) || defined(AUP_AIVAD_SIMD_NEON) || \
+    defined(AUP_AIVAD_SIMD_WASM)
+#if defined(AUP_AIVAD_SIMD_SSE)
+#define AIVAD_V4 __m128
+#define AIVAD_LD(p) _mm_loadu_ps(p)
+#define AIVAD_ST(p, v) _mm_storeu_ps(p, v)
+#define AIVAD_DUP(s) _mm_set1_ps(s)
+#define AIVAD_MLA(a, b, c) _mm_add_ps(a, _mm_mul_ps(b, c))
+#elif defined(AUP_AIVAD_SIMD_NEON)
+#define AIVAD_V4 float32x4_t
+#define AIVAD_LD(p) vld1q_f32(p)
+#define AIVAD_ST(p, v) vst1q_f32(p, v)
+#define AIVAD_DUP(s) vdupq_n_f32(s)
+#define AIVAD_MLA(a, b, c) vmlaq_f32(a, b, c)
+#else
+#define AIVAD_V4 v128_t
+#define AIVAD_LD(p) wasm_v128_load(p)
+#define AIVAD_ST(p, v) wasm_v128_store(p, v)
+#define AIVAD_DUP(s) wasm_f32x4_splat(s)
+#define AIVAD_MLA(a, b, c) wasm_f32x4_add(a, wasm_f32x4_mul(b, c))
+#endif
+    AIVAD_V4 acc[AUP_AIVAD_MATVEC_TILE / 4];
+    int j;
+    for (j = 0; j < AUP_AIVAD_MATVEC_TILE / 4; j++) {
+      acc[j] = AIVAD_LD(y + o + 4 * j);
+    }
+    for (k = 0; k < nIn; k++, w += nOut) {
+      AIVAD_V4 xb = AIVAD_DUP(x[k]);
+      for (j = 0; j < AUP_AIVAD_MATVEC_TILE / 4; j++) {
+        acc[j] = AIVAD_MLA(acc[j], AIVAD_LD(w + 4 * j), xb);
+      }
+    }
+    for (j = 0; j < AUP_AIVAD_MATVEC_TILE / 4; j++) {
+      AIVAD_ST(y + o + 4 * j, acc[j]);
+    }
+#undef AIVAD_V4
+#undef AIVAD_LD
+#undef AIVAD_ST
+#undef AIVAD_DUP
+#undef AIVAD_MLA
+#else
+    float acc[AUP_AIVAD_MATVEC_TILE];
+    int j;
+    memcpy(acc, y + o, sizeof(acc));
+    for (k = 0; k < nIn; k++, w += nOut) {
+      for (j = 0; j < AUP_AIVAD_MATVEC_TILE; j++) {
+        acc[j] += w[j] * x[k];
+      }
+    }
+    memcpy(y + o, acc, sizeof(acc));
+#endif
+  }
+}
+
+// y[nOut] += x[nIn] * W[nIn][nOut] with W of AUP_AivadNet_quantize, nIn has
+// to be even and at most AUP_AIVAD_QMAT_MAX_IN, nOut a multiple of
+// AUP_AIVAD_MATVEC_TILE; x is scaled to int16 by its max. magnitude, the
+// int32 accumulation is exact and gives the same sums on every ISA, NEON and
+// WASM are left to the compiler
+static void AUP_AivadNet_matVecAccQ(const AivadNet_QMat* wt, const float* x,
+                                    int nIn, int nOut, float* y) {
+  int16_t xq[AUP_AIVAD_QMAT_MAX_IN];
+  int32_t acc[AUP_AIVAD_MATVEC_TILE];
+  float xMax = 0.0f;
+  float xScale;
+  int o, k, j;
+
+  for (k = 0; k < nIn; k++) {
+    xMax = AUP_AIVAD_MAX(xMax, fabsf(x[k]));
+  }
+  if (xMax == 0.0f) {
+    return;
+  }
+  xScale = 32767.0f / xMax;
+  for (k = 0; k < nIn; k++) {
+    xq[k] = (int16_t)lrintf(x[k] * xScale);
+  }
+  xScale = xMax / 32767.0f;
+
+  for (o = 0; o < nOut; o += AUP_AIVAD_MATVEC_TILE) {
+    const int8_t* w = wt->q + 2 * o;
+#if defined(AUP_AIVAD_SIMD_AVX2)
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256();
+    __m256i acc3 = _mm256_setzero_si256();
+    for (k = 0; k < nIn; k += 2, w += 2 * nOut) {
+      __m256i xb = _mm256_set1_epi32((int32_t)((uint32_t)(uint16_t)xq[k] |
+                                               ((uint32_t)(uint16_t)xq[k + 1]
+                                                << 16)));
+      acc0 = _mm256_add_epi32(
+          acc0, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128(
+                                      (const __m128i*)(w))),
+                                  xb));
+      acc1 = _mm256_add_epi32(
+          acc1, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128(
+                                      (const __m128i*)(w + 16))),
+                                  xb));
+      acc2 = _mm256_add_epi32(
+          acc2, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128(
+                                      (const __m128i*)(w + 32))),
+                                  xb));
+      acc3 = _mm256_add_epi32(
+          acc3, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128(
+                                      (const __m128i*)(w + 48))),
+                                  xb));
+    }
+    _mm256_storeu_si256((__m256i*)(acc), acc0);
+    _mm256_storeu_si256((__m256i*)(acc + 8), acc1);
+    _mm256_storeu_si256((__m256i*)(acc + 16), acc2);
+    _mm256_storeu_si256((__m256i*)(acc + 24), acc3);
+#elif defined(AUP_AIVAD_SIMD_SSE)
+    __m128i accV[AUP_AIVAD_MATVEC_TILE / 4];
+    for (j = 0; j < AUP_AIVAD_MATVEC_TILE / 4; j++) {
+      accV[j] = _mm_setzero_si128();
+    }
+    for (k = 0; k < nIn; k += 2, w += 2 * nOut) {
+      __m128i xb = _mm_set1_epi32((int32_t)((uint32_t)(uint16_t)xq[k] |
+                                            ((uint32_t)(uint16_t)xq[k + 1]
+                                             << 16)));
+      for (j = 0; j < AUP_AIVAD_MATVEC_TILE / 8; j++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(w + 16 * j));
+        // sign extension of the int8 pairs to int16
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+        accV[2 * j] = _mm_add_epi32(accV[2 * j], _mm_madd_epi16(lo, xb));
+        accV[2 * j + 1] =
+            _mm_add_epi32(accV[2 * j + 1], _mm_madd_epi16(hi, xb));
+      }
+    }
+    for (j = 0; j < AUP_AIVAD_MATVEC_TILE / 4; j++) {
+      _mm_storeu_si128((__m128i*)(acc + 4 * j), accV[j]);
+    }
+#else
+    for (j = 0; j < AUP_AIVAD_MATVEC_TILE; j++) {
+      acc[j] = 0;
+    }
+    for (k = 0; k < nIn; k += 2, w += 2 * nOut) {
+      for (j = 0; j < AUP_AIVAD_MATVEC_TILE; j++) {
+        acc[j] += (int32_t)w[2 * j] * xq[k] + (int32_t)w[2 * j + 1] * xq[k + 1];
+      }
+    }
+#endif
+    for (j = 0; j < AUP_AIVAD_MATVEC_TILE; j++) {
+      y[o + j] += (float)acc[j] * (xScale * wt->scale[o + j]);
+    }
+  }
+}
+
+// rows [0, nIn) of wt[][ld] into q / scale of AUP_AivadNet_matVecAccQ, one
+// symmetric scale per output
+static void AUP_AivadNet_quantize(const float* wt, int ld, int nIn, int nOut,
+                                  int8_t* q, float* scale) {
+  float m, inv;
+  int o, k;
+
+  for (o = 0; o < nOut; o++) {
+    m = 0.0f;
+    for (k = 0; k < nIn; k++) {
+      m = AUP_AIVAD_MAX(m, fabsf(wt[k * ld + o]));
+    }
+    scale[o] = m / 127.0f;
+    inv = (m > 0.0f) ? 127.0f / m : 0.0f;
+    for (k = 0; k < nIn; k++) {
+      q[(k >> 1) * 2 * nOut + 2 * o + (k & 1)] =
+          (int8_t)lrintf(wt[k * ld + o] * inv);
+    }
+  }
+}
+
+static int AUP_AivadNet_buildInt8Model(AivadNet_Int8Model* m) {
+  const float* lstm0h = AUP_AIVAD_LSTM0_W + AUP_AIVAD_LSTM0_IN * AUP_AIVAD_GATES;
+  const float* lstm1h = AUP_AIVAD_LSTM1_W + AUP_AIVAD_HIDDEN * AUP_AIVAD_GATES;
+
+  AUP_AivadNet_quantize(AUP_AIVAD_LSTM0_W, AUP_AIVAD_GATES, AUP_AIVAD_LSTM0_IN,
+                        AUP_AIVAD_GATES, m->lstm0x, m->lstm0xScale);
+  AUP_AivadNet_quantize(lstm0h, AUP_AIVAD_GATES, AUP_AIVAD_HIDDEN,
+                        AUP_AIVAD_GATES, m->lstm0h, m->lstm0hScale);
+  AUP_AivadNet_quantize(AUP_AIVAD_LSTM1_W, AUP_AIVAD_GATES, AUP_AIVAD_HIDDEN,
+                        AUP_AIVAD_GATES, m->lstm1x, m->lstm1xScale);
+  AUP_AivadNet_quantize(lstm1h, AUP_AIVAD_GATES, AUP_AIVAD_HIDDEN,
+                        AUP_AIVAD_GATES, m->lstm1h, m->lstm1hScale);
+  AUP_AivadNet_quantize(AUP_AIVAD_DENSE0_W, AUP_AIVAD_DENSE0_OUT,
+                        2 * AUP_AIVAD_HIDDEN, AUP_AIVAD_DENSE0_OUT, m->dense0,
+                        m->dense0Scale);
+  return 0;
+}
+
+// int8 tables are built on first use and shared read-only by all instances
+static const AivadNet_Weights* AUP_AivadNet_getInt8Weights(void) {
+  static AivadNet_Int8Model int8Model;
+  static const int int8Ret = AUP_AivadNet_buildInt8Model(&int8Model);
+  static const AivadNet_QMat int8Mat[5] = {
+      {int8Model.lstm0x, int8Model.lstm0xScale},
+      {int8Model.lstm0h, int8Model.lstm0hScale},
+      {int8Model.lstm1x, int8Model.lstm1xScale},
+      {int8Model.lstm1h, int8Model.lstm1hScale},
+      {int8Model.dense0, int8Model.dense0Scale}};
+  static const AivadNet_Weights int8W = {&int8Mat[0], &int8Mat[1],
+                                         &int8Mat[2], &int8Mat[3],
+                                         &int8Mat[4]};
+
+  return int8Ret == 0 ? &int8W : NULL;
+}
+
+static const AivadNet_Weights* AUP_AivadNet_getWeights(int precision) {
+  static const AivadNet_Weights fp32W = {NULL, NULL, NULL, NULL, NULL};
+
+  if (precision == AUP_AIVAD_PREC_FP32) {
+    return &fp32W;
+  }
+  if (precision == AUP_AIVAD_PREC_INT8) {
+    return AUP_AivadNet_getInt8Weights();
+  }
+  return NULL;
+}
+
+static float AUP_AivadNet_sigmoid(float x) { return 1.0f / (1.0f + expf(-x)); }
+
+// input part of the LSTM gates: gates = bias + x * W_x, with qWt instead of
+// wt if not NULL
+static void AUP_AivadNet_lstmIn(const float* wt, const AivadNet_QMat* qWt,
+                                const float* bias, int nIn, const float* x,
+                                float* gates) {
+  memcpy(gates, bias, sizeof(float) * AUP_AIVAD_GATES);
+  if (qWt != NULL) {
+    AUP_AivadNet_matVecAccQ(qWt, x, nIn, AUP_AIVAD_GATES, gates);
+  } else {
+    AUP_AivadNet_matVecAcc(wt, x, nIn, AUP_AIVAD_GATES, gates);
+  }
+}
+
+// recurrent part of one LSTM step on gates from AUP_AivadNet_lstmIn, gate
+// order of the weights: input, output, forget, cell; qWt as in
+// AUP_AivadNet_lstmIn, covering the recurrent rows only
+static void AUP_AivadNet_lstmRec(const float* wt, const AivadNet_QMat* qWt,
+                                 int nIn, float* gates, const float* hIn,
+                                 const float* cIn, float* hOut, float* cOut) {
+  const float* gi = gates;
+  const float* go = gates + AUP_AIVAD_HIDDEN;
+  const float* gf = gates + 2 * AUP_AIVAD_HIDDEN;
+  const float* gc = gates + 3 * AUP_AIVAD_HIDDEN;
+  float c;
+  int k;
+
+  if (qWt != NULL) {
+    AUP_AivadNet_matVecAccQ(qWt, hIn, AUP_AIVAD_HIDDEN, AUP_AIVAD_GATES, gates);
+  } else {
+    AUP_AivadNet_matVecAcc(wt + nIn * AUP_AIVAD_GATES, hIn, AUP_AIVAD_HIDDEN,
+                           AUP_AIVAD_GATES, gates);
+  }
+
+  for (k = 0; k < AUP_AIVAD_HIDDEN; k++) {
+    c = AUP_AivadNet_sigmoid(gf[k]) * cIn[k] +
+        AUP_AivadNet_sigmoid(gi[k]) * tanhf(gc[k]);
+    cOut[k] = c;
+    hOut[k] = AUP_AivadNet_sigmoid(go[k]) * tanhf(c);
+  }
+}
+
+// depthwise 1x3 conv. with stride 2 and padLeft zero samples in front,
+// followed by pointwise 16->16 conv., bias and ReLU; in / out are [ch][width]
+static void AUP_AivadNet_sepConv(const float* in, int inW, int outW,
+                                 int padLeft, const float* dw, const float* pw,
+                                 const float* bias, float* out) {
+  float depth[AUP_AIVAD_CONV_CH][AUP_AIVAD_CONV1_OUT];
+  float s;
+  int c, o, j, k, idx;
+
+  for (c = 0; c < AUP_AIVAD_CONV_CH; c++) {
+    for (j = 0; j < outW; j++) {
+      s = 0.0f;
+      for (k = 0; k < 3; k++) {
+        idx = 2 * j + k - padLeft;
+        if (idx >= 0 && idx < inW) {
+          s += in[c * inW + idx] * dw[c * 3 + k];
+        }
+      }
+      depth[c][j] = s;
+    }
+  }
+
+  for (o = 0; o < AUP_AIVAD_CONV_CH; o++) {
+    for (j = 0; j < outW; j++) {
+      s = bias[o];
+      for (c = 0; c < AUP_AIVAD_CONV_CH; c++) {
+        s += pw[o * AUP_AIVAD_CONV_CH + c] * depth[c][j];
+      }
+      out[o * outW + j] = AUP_AIVAD_MAX(s, 0.0f);
+    }
+  }
+}
+
+// the part of the network not depending on the recurrent state: conv. front
+// end and the input part of the LSTM-0 gates
+static void AUP_AivadNet_front(const AivadNet_Weights* wts, const float* input,
+                               float* gates0) {
+  float conv0[AUP_AIVAD_CONV0_OUT];
+  float pool[AUP_AIVAD_CONV_CH * AUP_AIVAD_POOL_OUT];
+  float conv1[AUP_AIVAD_CONV_CH * AUP_AIVAD_CONV1_OUT];
+  float conv2[AUP_AIVAD_CONV_CH * AUP_AIVAD_CONV2_OUT];
+  float lstmIn[AUP_AIVAD_LSTM0_IN];
+  float s, v, m;
+  int c, j, a, b;
+
+  // conv-0: depthwise 3x3 (valid) on the single input channel
+  for (j = 0; j < AUP_AIVAD_CONV0_OUT; j++) {
+    s = 0.0f;
+    for (a = 0; a < AUP_AIVAD_CTXT_LEN; a++) {
+      for (b = 0; b < 3; b++) {
+        s += input[a * AUP_AIVAD_FEA_LEN + j + b] * AUP_AIVAD_CONV0_DW[a * 3 + b];
+      }
+    }
+    conv0[j] = s;
+  }
+
+  // pointwise 1->16, bias, ReLU and max-pool 1x3 / stride 2
+  for (c = 0; c < AUP_AIVAD_CONV_CH; c++) {
+    for (j = 0; j < AUP_AIVAD_POOL_OUT; j++) {
+      m = 0.0f;  // ReLU outputs are >= 0
+      for (b = 0; b < 3; b++) {
+        v = AUP_AIVAD_CONV0_PW[c] * conv0[2 * j + b] + AUP_AIVAD_CONV0_BIAS[c];
+        m = AUP_AIVAD_MAX(m, v);
+      }
+      pool[c * AUP_AIVAD_POOL_OUT + j] = m;
+    }
+  }
+
+  AUP_AivadNet_sepConv(pool, AUP_AIVAD_POOL_OUT, AUP_AIVAD_CONV1_OUT, 1,
+                       AUP_AIVAD_CONV1_DW, AUP_AIVAD_CONV1_PW,
+                       AUP_AIVAD_CONV1_BIAS, conv1);
+  AUP_AivadNet_sepConv(conv1, AUP_AIVAD_CONV1_OUT, AUP_AIVAD_CONV2_OUT, 0,
+                       AUP_AIVAD_CONV2_DW, AUP_AIVAD_CONV2_PW,
+                       AUP_AIVAD_CONV2_BIAS, conv2);
+
+  // [ch][time] -> [time][ch]
+  for (j = 0; j < AUP_AIVAD_CONV2_OUT; j++) {
+    for (c = 0; c < AUP_AIVAD_CONV_CH; c++) {
+      lstmIn[j * AUP_AIVAD_CONV_CH + c] = conv2[c * AUP_AIVAD_CONV2_OUT + j];
+    }
+  }
+
+  AUP_AivadNet_lstmIn(AUP_AIVAD_LSTM0_W, wts->lstm0x, AUP_AIVAD_LSTM0_BIAS,
+                      AUP_AIVAD_LSTM0_IN, lstmIn, gates0);
+}
+
+// the recurrent part of the network on the gates of AUP_AivadNet_front
+static void AUP_AivadNet_step(const AivadNet_Weights* wts, float* gates0,
+                              const float* stateIn, float* stateOut,
+                              float* prob) {
+  float gates1[AUP_AIVAD_GATES];
+  float hidCat[2 * AUP_AIVAD_HIDDEN];
+  float dense0[AUP_AIVAD_DENSE0_OUT];
+  const float* hIn0 = stateIn;
+  const float* cIn0 = stateIn + AUP_AIVAD_HIDDEN;
+  const float* hIn1 = stateIn + 2 * AUP_AIVAD_HIDDEN;
+  const float* cIn1 = stateIn + 3 * AUP_AIVAD_HIDDEN;
+  float* hOut0 = stateOut;
+  float* cOut0 = stateOut + AUP_AIVAD_HIDDEN;
+  float* hOut1 = stateOut + 2 * AUP_AIVAD_HIDDEN;
+  float* cOut1 = stateOut + 3 * AUP_AIVAD_HIDDEN;
+  float s;
+  int j;
+
+  AUP_AivadNet_lstmRec(AUP_AIVAD_LSTM0_W, wts->lstm0h, AUP_AIVAD_LSTM0_IN,
+                       gates0, hIn0, cIn0, hOut0, cOut0);
+  AUP_AivadNet_lstmIn(AUP_AIVAD_LSTM1_W, wts->lstm1x, AUP_AIVAD_LSTM1_BIAS,
+                      AUP_AIVAD_HIDDEN, hOut0, gates1);
+  AUP_AivadNet_lstmRec(AUP_AIVAD_LSTM1_W, wts->lstm1h, AUP_AIVAD_HIDDEN, gates1,
+                       hIn1, cIn1, hOut1, cOut1);
+
+  // head: dense 128->32 + ReLU on [h1, h0], dense 32->1 + sigmoid
+  memcpy(hidCat, hOut1, sizeof(float) * AUP_AIVAD_HIDDEN);
+  memcpy(hidCat + AUP_AIVAD_HIDDEN, hOut0, sizeof(float) * AUP_AIVAD_HIDDEN);
+  memcpy(dense0, AUP_AIVAD_DENSE0_BIAS, sizeof(dense0));
+  if (wts->dense0 != NULL) {
+    AUP_AivadNet_matVecAccQ(wts->dense0, hidCat, 2 * AUP_AIVAD_HIDDEN,
+                            AUP_AIVAD_DENSE0_OUT, dense0);
+  } else {
+    AUP_AivadNet_matVecAcc(AUP_AIVAD_DENSE0_W, hidCat, 2 * AUP_AIVAD_HIDDEN,
+                           AUP_AIVAD_DENSE0_OUT, dense0);
+  }
+  s = AUP_AIVAD_DENSE1_BIAS[0];
+  for (j = 0; j < AUP_AIVAD_DENSE0_OUT; j++) {
+    s += AUP_AIVAD_MAX(dense0[j], 0.0f) * AUP_AIVAD_DENSE1_W[j];
+  }
+  (*prob) = AUP_AivadNet_sigmoid(s);
+}
+
+/// ///////////////////////////////////////////////////////////////////////
+/// Public API
+/// ///////////////////////////////////////////////////////////////////////
+
+int AUP_AivadNet_proc(int precision, const float* input, const float* stateIn,
+                      float* stateOut, float* prob) {
+  const AivadNet_Weights* wts = AUP_AivadNet_getWeights(precision);
+  float gates0[AUP_AIVAD_GATES];
+
+  if (wts == NULL || input == NULL || stateIn == NULL || stateOut == NULL ||
+      prob == NULL || stateIn == stateOut) {
+    return -1;
+  }
+
+  AUP_AivadNet_front(wts, input, gates0);
+  AUP_AivadNet_step(wts, gates0, stateIn, stateOut, prob);
+
+  return 0;
+}
+
+int AUP_AivadNet_procSeq(int precision, const float* inputs, int num,
+                         float* state, float* probs) {
+  const AivadNet_Weights* wts = AUP_AivadNet_getWeights(precision);
+  float gates0[AUP_AIVAD_SEQ_BLOCK][AUP_AIVAD_GATES];
+  float stateTmp[AUP_AIVAD_STATE_NUM * AUP_AIVAD_HIDDEN];
+  const int inLen = AUP_AIVAD_CTXT_LEN * AUP_AIVAD_FEA_LEN;
+  int t, k, blkLen;
+
+  if (wts == NULL || inputs == NULL || state == NULL || probs == NULL ||
+      num < 0) {
+    return -1;
+  }
+
+  for (t = 0; t < num; t += blkLen) {
+    blkLen = num - t;
+    if (blkLen > AUP_AIVAD_SEQ_BLOCK) {
+      blkLen = AUP_AIVAD_SEQ_BLOCK;
+    }
+    // the state independent part of a whole block first, so that its
+    // weights are streamed once per block instead of once per frame
+    for (k = 0; k < blkLen; k++) {
+      AUP_AivadNet_front(wts, inputs + (t + k) * inLen, gates0[k]);
+    }
+    for (k = 0; k < blkLen; k++) {
+      AUP_AivadNet_step(wts, gates0[k], state, stateTmp, &probs[t + k]);
+      memcpy(state, stateTmp, sizeof(stateTmp));
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+//
+// Copyright © 2025 Agora
+// This file is part of TEN Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#ifndef __AIVAD_NET_H__
+#define __AIVAD_NET_H__
+
+#include <stddef.h>
+
+// topology of onnx_model/ten-vad.onnx
+#define AUP_AIVAD_CTXT_LEN (3)   // context window length
+#define AUP_AIVAD_FEA_LEN (41)   // feature length per frame
+#define AUP_AIVAD_CONV0_DW_LEN (9)
+#define AUP_AIVAD_CONV_CH (16)   // channels of the conv. front end
+#define AUP_AIVAD_CONV0_OUT (39)  // width after conv-0 (3x3, valid)
+#define AUP_AIVAD_POOL_OUT (19)   // width after max-pool (1x3, stride 2)
+#define AUP_AIVAD_CONV1_OUT (10)  // width after conv-1 (1x3, stride 2, pad 1/1)
+#define AUP_AIVAD_CONV2_OUT (5)   // width after conv-2 (1x3, stride 2, pad 0/1)
+#define AUP_AIVAD_LSTM0_IN (AUP_AIVAD_CONV_CH * AUP_AIVAD_CONV2_OUT)
+#define AUP_AIVAD_HIDDEN (64)
+#define AUP_AIVAD_GATES (4 * AUP_AIVAD_HIDDEN)
+#define AUP_AIVAD_DENSE0_OUT (32)
+#define AUP_AIVAD_STATE_NUM (4)  // h0, c0, h1, c1 of the two LSTM layers
+
+// frames per block of AUP_AivadNet_procSeq
+#define AUP_AIVAD_SEQ_BLOCK (16)
+
+// Tolerance of the native backend against the ONNX Runtime backend on the
+// output probability and states: both evaluate the same float32 graph, the
+// differences only come from summation order and FMA contraction.
+#define AUP_AIVAD_NATIVE_TOLERANCE (1e-5f)
+
+// precision of the LSTM and dense-0 weights, which hold nearly all of the
+// parameters; the conv. front end and the output layer stay float32
+#define AUP_AIVAD_PREC_FP32 (0)  // float32, the graph of the ONNX model
+#define AUP_AIVAD_PREC_INT8 (1)  // int8 with one scale per output, int16
+                                 // activations scaled per vector, int32
+                                 // accumulation
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************************
+ * AUP_AivadNet_proc(...)
+ *
+ * run one inference of the AI-VAD network with the compiled-in weights
+ *
+ * Input:
+ *      - precision     : AUP_AIVAD_PREC_xxx
+ *      - input         : [AUP_AIVAD_CTXT_LEN * AUP_AIVAD_FEA_LEN] normalized
+ *                        feature context window
+ *      - stateIn       : [AUP_AIVAD_STATE_NUM * AUP_AIVAD_HIDDEN] recurrent
+ *                        state of the previous inference
+ *
+ * Output:
+ *      - stateOut      : [AUP_AIVAD_STATE_NUM * AUP_AIVAD_HIDDEN] updated
+ *                        recurrent state, may not alias stateIn
+ *      - prob          : voice probability [0, 1]
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_AivadNet_proc(int precision, const float* input, const float* stateIn,
+                      float* stateOut, float* prob);
+
+/****************************************************************************
+ * AUP_AivadNet_procSeq(...)
+ *
+ * run the AI-VAD network over a sequence of frames, which gives the same
+ * results as calling AUP_AivadNet_proc frame by frame
+ *
+ * Input:
+ *      - precision     : AUP_AIVAD_PREC_xxx
+ *      - inputs        : [num][AUP_AIVAD_CTXT_LEN * AUP_AIVAD_FEA_LEN]
+ *                        feature context windows in time order
+ *      - num           : number of frames
+ *      - state         : [AUP_AIVAD_STATE_NUM * AUP_AIVAD_HIDDEN] recurrent
+ *                        state before the first frame
+ *
+ * Output:
+ *      - state         : recurrent state after the last frame
+ *      - probs         : [num] voice probability of each frame
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_AivadNet_procSeq(int precision, const float* inputs, int num,
+                         float* state, float* probs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,9 +12,11 @@
 #include <stdio.h>
 
 #include "biquad_st.h"
+#include "fftw.h"
 
 #define AUP_BIQUAD_NUM_DUMP_FILES (20)
 #define AUP_BIQUAD_DUMP_FILENAMES (200)
+#define AUP_BIQUAD_MULTI_BLOCK (64)  // samples interleaved per kernel call
 
 // ==========================================================================================
 // internal tools
@@ -101,6 +103,66 @@ static int AUP_Biquad_publishStaticCfg(Biquad_St* stHdl) {
   return 0;
 }
 
+// size of the dynamic memory required by the published static config, only
+// the float conversion buffer of short I/O: the sections run fused in place
+static int AUP_Biquad_dynamMemSize(const Biquad_St* stHdl) {
+  return AGORA_UAP_BIQUAD_ALIGN8(sizeof(float) * stHdl->maxNSample);
+}
+
+// fused cascade: every sample runs through all the sections before the next
+// one, the same arithmetic per sample as one section after the other over
+// the whole block. src and tgt may be the same buffer
+static void AUP_Biquad_cascade(Biquad_St* stHdl, const float* src,
+                               float* tgt, int nSamples) {
+  // section coefficients and registers copied to locals, so that they can
+  // stay in registers despite tgt possibly aliasing the handler
+  float a1[AGORA_UAP_BIQUAD_MAX_SECTION], a2[AGORA_UAP_BIQUAD_MAX_SECTION];
+  float b0[AGORA_UAP_BIQUAD_MAX_SECTION], b1[AGORA_UAP_BIQUAD_MAX_SECTION];
+  float b2[AGORA_UAP_BIQUAD_MAX_SECTION], g[AGORA_UAP_BIQUAD_MAX_SECTION];
+  float w0[AGORA_UAP_BIQUAD_MAX_SECTION], w1[AGORA_UAP_BIQUAD_MAX_SECTION];
+  const int nSect = stHdl->nsect;
+  int sectIdx, smplIdx;
+  float x, tmp1;
+
+  for (sectIdx = 0; sectIdx < nSect; sectIdx++) {
+    a1[sectIdx] = stHdl->ACoeff[sectIdx][1];
+    a2[sectIdx] = stHdl->ACoeff[sectIdx][2];
+    b0[sectIdx] = stHdl->BCoeff[sectIdx][0];
+    b1[sectIdx] = stHdl->BCoeff[sectIdx][1];
+    b2[sectIdx] = stHdl->BCoeff[sectIdx][2];
+    g[sectIdx] = stHdl->GCoeff[sectIdx];
+    w0[sectIdx] = stHdl->sectW[sectIdx][0];
+    w1[sectIdx] = stHdl->sectW[sectIdx][1];
+  }
+
+  for (smplIdx = 0; smplIdx < nSamples; smplIdx++) {
+    x = src[smplIdx];
+    for (sectIdx = 0; sectIdx < nSect; sectIdx++) {
+      tmp1 = x - a1[sectIdx] * w0[sectIdx] - a2[sectIdx] * w1[sectIdx];
+      x = g[sectIdx] * (b0[sectIdx] * tmp1 + b1[sectIdx] * w0[sectIdx] +
+                        b2[sectIdx] * w1[sectIdx]);
+      w1[sectIdx] = w0[sectIdx];
+      w0[sectIdx] = tmp1;
+    }
+    tgt[smplIdx] = x;
+  }
+
+  for (sectIdx = 0; sectIdx < nSect; sectIdx++) {
+    stHdl->sectW[sectIdx][0] = w0[sectIdx];
+    stHdl->sectW[sectIdx][1] = w1[sectIdx];
+  }
+}
+
+static void AUP_Biquad_setDefaultCfg(Biquad_St* stHdl) {
+  stHdl->stCfg.maxNSample = 768;
+  stHdl->stCfg.nsect = 0;
+  for (int idx = 0; idx < AGORA_UAP_BIQUAD_MAX_SECTION; idx++) {
+    stHdl->stCfg.A[idx] = NULL;
+    stHdl->stCfg.B[idx] = NULL;
+  }
+  stHdl->stCfg.G = NULL;
+}
+
 static int AUP_Biquad_resetVariables(Biquad_St* stHdl) {
   memset(stHdl->dynamMemPtr, 0, stHdl->dynamMemSize);
   memset(stHdl->sectW, 0, sizeof(stHdl->sectW));
@@ -129,13 +191,56 @@ int AUP_Biquad_create(void** stPtr) {
   tmpPtr->dynamMemPtr = NULL;
   tmpPtr->dynamMemSize = 0;
 
-  tmpPtr->stCfg.maxNSample = 768;
-  tmpPtr->stCfg.nsect = 0;
-  for (int idx = 0; idx < AGORA_UAP_BIQUAD_MAX_SECTION; idx++) {
-    tmpPtr->stCfg.A[idx] = NULL;
-    tmpPtr->stCfg.B[idx] = NULL;
+  AUP_Biquad_setDefaultCfg(tmpPtr);
+
+  return 0;
+}
+
+int AUP_Biquad_getMemSize(const Biquad_StaticCfg* pCfg, size_t* memSize) {
+  Biquad_St tmpSt;
+
+  if (pCfg == NULL || memSize == NULL) {
+    return -1;
+  }
+  if (AUP_Biquad_checkStatCfg(pCfg) < 0) {
+    return -1;
+  }
+  memset(&tmpSt, 0, sizeof(Biquad_St));
+  memcpy(&(tmpSt.stCfg), pCfg, sizeof(Biquad_StaticCfg));
+  if (AUP_Biquad_publishStaticCfg(&tmpSt) < 0) {
+    return -1;
   }
-  tmpPtr->stCfg.G = NULL;
+
+  (*memSize) = AGORA_UAP_BIQUAD_ALIGN8(sizeof(Biquad_St)) +
+               AUP_Biquad_dynamMemSize(&tmpSt);
+
+  return 0;
+}
+
+int AUP_Biquad_createIn(void** stPtr, void* mem, size_t memSize,
+                        const Biquad_StaticCfg* pCfg) {
+  Biquad_St* tmpPtr;
+  size_t reqMemSize = 0;
+
+  if (stPtr == NULL || mem == NULL || ((size_t)mem & 7) != 0) {
+    return -1;
+  }
+  if (AUP_Biquad_getMemSize(pCfg, &reqMemSize) < 0 || reqMemSize > memSize) {
+    return -1;
+  }
+
+  tmpPtr = (Biquad_St*)mem;
+  memset(tmpPtr, 0, sizeof(Biquad_St));
+
+  tmpPtr->extMemFlag = 1;
+  tmpPtr->dynamMemPtr =
+      (char*)mem + AGORA_UAP_BIQUAD_ALIGN8(sizeof(Biquad_St));
+  tmpPtr->dynamMemSize =
+      reqMemSize - AGORA_UAP_BIQUAD_ALIGN8(sizeof(Biquad_St));
+
+  AUP_Biquad_setDefaultCfg(tmpPtr);
+
+  (*stPtr) = (void*)tmpPtr;
 
   return 0;
 }
@@ -152,6 +257,11 @@ int AUP_Biquad_destroy(void** stPtr) {
     return 0;
   }
 
+  if (stHdl->extMemFlag) {  // memory is owned by the caller
+    (*stPtr) = NULL;
+    return 0;
+  }
+
   if (stHdl->dynamMemPtr != NULL) {
     free(stHdl->dynamMemPtr);
   }
@@ -166,11 +276,6 @@ int AUP_Biquad_destroy(void** stPtr) {
 
 int AUP_Biquad_memAllocate(void* stPtr, const Biquad_StaticCfg* pCfg) {
   Biquad_St* stHdl = NULL;
-  char* memPtr = NULL;
-  int maxNSample, nsect, idx;
-
-  int inputTempBufMemSize = 0;
-  int sectOutputBufMemSize_EACH = 0;
   int totalMemSize = 0;
 
   if (stPtr == NULL || pCfg == NULL) {
@@ -186,19 +291,15 @@ int AUP_Biquad_memAllocate(void* stPtr, const Biquad_StaticCfg* pCfg) {
   if (AUP_Biquad_publishStaticCfg(stHdl) < 0) {
     return -1;
   }
-  maxNSample = stHdl->maxNSample;
-  nsect = stHdl->nsect;
 
   // check memory requirement
-  inputTempBufMemSize = AGORA_UAP_BIQUAD_ALIGN8(sizeof(float) * maxNSample);
-  totalMemSize += inputTempBufMemSize;
-
-  sectOutputBufMemSize_EACH =
-      AGORA_UAP_BIQUAD_ALIGN8(sizeof(float) * maxNSample);
-  totalMemSize += sectOutputBufMemSize_EACH * nsect;
+  totalMemSize = AUP_Biquad_dynamMemSize(stHdl);
 
   // allocate dynamic memory
   if ((size_t)totalMemSize > stHdl->dynamMemSize) {
+    if (stHdl->extMemFlag) {  // caller's memory can not grow
+      return -1;
+    }
     if (stHdl->dynamMemPtr != NULL) {
       free(stHdl->dynamMemPtr);
       stHdl->dynamMemSize = 0;
@@ -212,37 +313,76 @@ int AUP_Biquad_memAllocate(void* stPtr, const Biquad_StaticCfg* pCfg) {
   memset(stHdl->dynamMemPtr, 0, stHdl->dynamMemSize);
 
   // setup the pointers/variable
-  memPtr = (char*)(stHdl->dynamMemPtr);
+  stHdl->inputTempBuf = (float*)(stHdl->dynamMemPtr);
 
-  stHdl->inputTempBuf = (float*)memPtr;
-  memPtr += inputTempBufMemSize;
+  return 0;
+}
+
+int AUP_Biquad_init(void* stPtr) {
+  Biquad_St* stHdl;
 
-  for (idx = 0; idx < nsect; idx++) {
-    stHdl->sectOutputBuf[idx] = (float*)memPtr;
-    memPtr += sectOutputBufMemSize_EACH;
+  if (stPtr == NULL) {
+    return -1;
   }
-  for (; idx < AGORA_UAP_BIQUAD_MAX_SECTION; idx++) {
-    stHdl->sectOutputBuf[idx] = NULL;
+  stHdl = (Biquad_St*)(stPtr);
+
+  if (AUP_Biquad_resetVariables(stHdl) < 0) {
+    return -1;
   }
 
-  if (((int)(memPtr - (char*)(stHdl->dynamMemPtr))) > totalMemSize) {
+  return 0;
+}
+
+// copy the section registers into buf (save != 0) or back from it, return
+// their size; buf == NULL only returns the size
+static size_t AUP_Biquad_stateIo(Biquad_St* stHdl, char* buf, int save) {
+  size_t len = sizeof(float) * 2 * stHdl->nsect;
+
+  if (buf != NULL) {
+    if (save) {
+      memcpy(buf, stHdl->sectW, len);
+    } else {
+      memcpy(stHdl->sectW, buf, len);
+    }
+  }
+  return len;
+}
+
+int AUP_Biquad_getStateSize(const void* stPtr, size_t* stateSize) {
+  if (stPtr == NULL || stateSize == NULL) {
     return -1;
   }
+  (*stateSize) = AUP_Biquad_stateIo((Biquad_St*)stPtr, NULL, 1);
 
   return 0;
 }
 
-int AUP_Biquad_init(void* stPtr) {
+int AUP_Biquad_saveState(const void* stPtr, void* buf, size_t bufSize) {
   Biquad_St* stHdl;
 
-  if (stPtr == NULL) {
+  if (stPtr == NULL || buf == NULL) {
     return -1;
   }
-  stHdl = (Biquad_St*)(stPtr);
+  stHdl = (Biquad_St*)(stPtr);  // only read when saving
+  if (bufSize < AUP_Biquad_stateIo(stHdl, NULL, 1)) {
+    return -1;
+  }
+  AUP_Biquad_stateIo(stHdl, (char*)buf, 1);
 
-  if (AUP_Biquad_resetVariables(stHdl) < 0) {
+  return 0;
+}
+
+int AUP_Biquad_loadState(void* stPtr, const void* buf, size_t bufSize) {
+  Biquad_St* stHdl;
+
+  if (stPtr == NULL || buf == NULL) {
     return -1;
   }
+  stHdl = (Biquad_St*)(stPtr);
+  if (bufSize != AUP_Biquad_stateIo(stHdl, NULL, 0)) {
+    return -1;
+  }
+  AUP_Biquad_stateIo(stHdl, (char*)buf, 0);  // only read when loading
 
   return 0;
 }
@@ -277,12 +417,9 @@ int AUP_Biquad_proc(void* stPtr, const Biquad_InputData* pIn,
                     Biquad_OutputData* pOut) {
   Biquad_St* stHdl = NULL;
   int isFloatIO = 0;
-  int inputNSamples, nSect;
-  int sectIdx, smplIdx;
-  float tmp1;
+  int inputNSamples;
+  int smplIdx;
   const short* pShortTemp;
-  float* src;
-  float* tgt;
 
   if (stPtr == NULL || pIn == NULL || pOut == NULL) {  //  pCtrl == NULL
     return -1;
@@ -303,51 +440,118 @@ int AUP_Biquad_proc(void* stPtr, const Biquad_InputData* pIn,
   }
 
   inputNSamples = (int)pIn->nsamples;
-  nSect = stHdl->nsect;
 
-  // special handle for input
-  if (isFloatIO == 0) {
+  if (isFloatIO == 0) {  // convert, filter in place and convert back
     pShortTemp = (const short*)pIn->samplesPtr;
     for (smplIdx = 0; smplIdx < inputNSamples; smplIdx++) {
       stHdl->inputTempBuf[smplIdx] = (float)pShortTemp[smplIdx];
     }
+    AUP_Biquad_cascade(stHdl, stHdl->inputTempBuf, stHdl->inputTempBuf,
+                       inputNSamples);
+    for (smplIdx = 0; smplIdx < inputNSamples; smplIdx++) {
+      ((short*)pOut->outputBuff)[smplIdx] =
+          (short)_BIQUAD_FLOAT2SHORT(stHdl->inputTempBuf[smplIdx]);
+    }
   } else {
-    memcpy(stHdl->inputTempBuf, (const float*)pIn->samplesPtr,
-           sizeof(float) * inputNSamples);
+    AUP_Biquad_cascade(stHdl, (const float*)pIn->samplesPtr,
+                       (float*)pOut->outputBuff, inputNSamples);
   }
 
-  for (sectIdx = 0; sectIdx < nSect; sectIdx++) {
-    if (sectIdx == 0) {
-      src = stHdl->inputTempBuf;
-    } else {
-      src = stHdl->sectOutputBuf[sectIdx - 1];
+  return 0;
+}
+
+int AUP_Biquad_procMulti(void* const* stPtrs, const Biquad_InputData* pIns,
+                         Biquad_OutputData* pOuts, int num) {
+  float coef[6 * AGORA_UAP_BIQUAD_MAX_SECTION];
+  float w[2 * AGORA_UAP_BIQUAD_MAX_SECTION * AGORA_UAP_BIQUAD_MAX_LANES];
+  float blk[AUP_BIQUAD_MULTI_BLOCK * AGORA_UAP_BIQUAD_MAX_LANES];
+  const Biquad_St* refHdl = NULL;
+  Biquad_St* stHdl = NULL;
+  int isFloatIO, nSamples, nSect;
+  int idx, base, lanes, c, s, off, cnt, n;
+
+  if (stPtrs == NULL || pIns == NULL || pOuts == NULL || num <= 0) {
+    return -1;
+  }
+  if (stPtrs[0] == NULL) {
+    return -1;
+  }
+  refHdl = (const Biquad_St*)stPtrs[0];
+  nSamples = (int)pIns[0].nsamples;
+  isFloatIO = (pIns[0].sampleType != 0) ? 1 : 0;
+  nSect = refHdl->nsect;
+
+  // every handler has to run the very same filter on the same frame shape
+  for (idx = 0; idx < num; idx++) {
+    stHdl = (Biquad_St*)stPtrs[idx];
+    if (stHdl == NULL || pIns[idx].samplesPtr == NULL ||
+        pOuts[idx].outputBuff == NULL) {
+      return -1;
     }
-    tgt = stHdl->sectOutputBuf[sectIdx];
+    if ((int)pIns[idx].nsamples != nSamples || nSamples > stHdl->maxNSample ||
+        ((pIns[idx].sampleType != 0) ? 1 : 0) != isFloatIO) {
+      return -1;
+    }
+    if (stHdl->nsect != nSect ||
+        memcmp(stHdl->ACoeff, refHdl->ACoeff, sizeof(refHdl->ACoeff)) != 0 ||
+        memcmp(stHdl->BCoeff, refHdl->BCoeff, sizeof(refHdl->BCoeff)) != 0 ||
+        memcmp(stHdl->GCoeff, refHdl->GCoeff, sizeof(refHdl->GCoeff)) != 0) {
+      return -1;
+    }
+  }
 
-    for (smplIdx = 0; smplIdx < inputNSamples; smplIdx++) {
-      tmp1 = src[smplIdx] -
-             stHdl->ACoeff[sectIdx][1] * stHdl->sectW[sectIdx][0] -
-             stHdl->ACoeff[sectIdx][2] * stHdl->sectW[sectIdx][1];
+  for (s = 0; s < nSect; s++) {
+    coef[6 * s] = refHdl->ACoeff[s][1];
+    coef[6 * s + 1] = refHdl->ACoeff[s][2];
+    coef[6 * s + 2] = refHdl->BCoeff[s][0];
+    coef[6 * s + 3] = refHdl->BCoeff[s][1];
+    coef[6 * s + 4] = refHdl->BCoeff[s][2];
+    coef[6 * s + 5] = refHdl->GCoeff[s];
+  }
 
-      tgt[smplIdx] = stHdl->GCoeff[sectIdx] *
-                     (stHdl->BCoeff[sectIdx][0] * tmp1 +
-                      stHdl->BCoeff[sectIdx][1] * stHdl->sectW[sectIdx][0] +
-                      stHdl->BCoeff[sectIdx][2] * stHdl->sectW[sectIdx][1]);
+  for (base = 0; base < num; base += lanes) {
+    lanes = _BIQUAD_MIN(AGORA_UAP_BIQUAD_MAX_LANES, num - base);
 
-      stHdl->sectW[sectIdx][1] = stHdl->sectW[sectIdx][0];
-      stHdl->sectW[sectIdx][0] = tmp1;
+    for (c = 0; c < lanes; c++) {
+      stHdl = (Biquad_St*)stPtrs[base + c];
+      for (s = 0; s < nSect; s++) {
+        w[2 * s * lanes + c] = stHdl->sectW[s][0];
+        w[(2 * s + 1) * lanes + c] = stHdl->sectW[s][1];
+      }
     }
-  }
 
-  // prepare output buffer
-  if (isFloatIO == 0) {
-    for (smplIdx = 0; smplIdx < inputNSamples; smplIdx++) {
-      ((short*)pOut->outputBuff)[smplIdx] =
-          (short)_BIQUAD_FLOAT2SHORT(stHdl->sectOutputBuf[nSect - 1][smplIdx]);
+    for (off = 0; off < nSamples; off += AUP_BIQUAD_MULTI_BLOCK) {
+      cnt = _BIQUAD_MIN(AUP_BIQUAD_MULTI_BLOCK, nSamples - off);
+      for (c = 0; c < lanes; c++) {
+        if (isFloatIO) {
+          const float* pIn = (const float*)pIns[base + c].samplesPtr + off;
+          for (n = 0; n < cnt; n++) blk[n * lanes + c] = pIn[n];
+        } else {
+          const short* pIn = (const short*)pIns[base + c].samplesPtr + off;
+          for (n = 0; n < cnt; n++) blk[n * lanes + c] = (float)pIn[n];
+        }
+      }
+      AUP_FFTW_biquadLanes(blk, cnt, lanes, coef, nSect, w);
+      for (c = 0; c < lanes; c++) {
+        if (isFloatIO) {
+          float* pOut = (float*)pOuts[base + c].outputBuff + off;
+          for (n = 0; n < cnt; n++) pOut[n] = blk[n * lanes + c];
+        } else {
+          short* pOut = (short*)pOuts[base + c].outputBuff + off;
+          for (n = 0; n < cnt; n++) {
+            pOut[n] = (short)_BIQUAD_FLOAT2SHORT(blk[n * lanes + c]);
+          }
+        }
+      }
+    }
+
+    for (c = 0; c < lanes; c++) {
+      stHdl = (Biquad_St*)stPtrs[base + c];
+      for (s = 0; s < nSect; s++) {
+        stHdl->sectW[s][0] = w[2 * s * lanes + c];
+        stHdl->sectW[s][1] = w[(2 * s + 1) * lanes + c];
+      }
     }
-  } else {
-    memcpy(pOut->outputBuff, stHdl->sectOutputBuf[nSect - 1],
-           sizeof(float) * inputNSamples);
   }
 
   return 0;
@@ -15,7 +15,11 @@
 #define AGORA_UAP_BIQUAD_MAX_INPUT_LEN (3840)
 // max. number of samples each time can be fed in
 
+#define AGORA_UAP_BIQUAD_MAX_LANES (8)
+// max. number of streams filtered together in SIMD lanes by _procMulti
+
 #define AGORA_UAP_BIQUAD_ALIGN8(o) (((o) + 7) & (~7))
+#define _BIQUAD_MIN(x, y) (((x) > (y)) ? (y) : (x))
 #define _BIQUAD_FLOAT2SHORT(x) \
   ((x) < -32767.5f ? -32768 : ((x) > 32766.5f ? 32767 : (short)floor(.5 + (x))))
 
@@ -80,6 +84,46 @@ extern "C" {
  */
 int AUP_Biquad_create(void** stPtr);
 
+/****************************************************************************
+ * AUP_Biquad_getMemSize(...)
+ *
+ * This function returns the memory required by _createIn for a handler
+ * configured with pCfg, covering the state handler and its dynamic memory
+ *
+ * Input:
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - memSize       : required memory size in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Biquad_getMemSize(const Biquad_StaticCfg* pCfg, size_t* memSize);
+
+/****************************************************************************
+ * AUP_Biquad_createIn(...)
+ *
+ * This function creats a state handler inside caller provided memory, no
+ * memory is allocated by this handler afterwards. _memAllocate has to be
+ * called with the same pCfg (or one requiring less memory); _destroy won't
+ * release mem
+ *
+ * Input:
+ *      - mem           : caller's memory, 8-byte aligned, which has to
+ *                        outlive the handler
+ *      - memSize       : size of mem, at least what _getMemSize returns
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - stPtr         : buffer to store the returned state handler
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Biquad_createIn(void** stPtr, void* mem, size_t memSize,
+                        const Biquad_StaticCfg* pCfg);
+
 /****************************************************************************
  * AUP_Biquad_destroy(...)
  *
@@ -130,6 +174,62 @@ int AUP_Biquad_memAllocate(void* stPtr, const Biquad_StaticCfg* pCfg);
  */
 int AUP_Biquad_init(void* stPtr);
 
+/****************************************************************************
+ * AUP_Biquad_getStateSize(...)
+ *
+ * This function returns the size of the signal state written by _saveState,
+ * the section registers; it only depends on the static config
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *
+ * Output:
+ *      - stateSize     : size of the state in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Biquad_getStateSize(const void* stPtr, size_t* stateSize);
+
+/****************************************************************************
+ * AUP_Biquad_saveState(...)
+ *
+ * This function copies the signal state of the handler into buf
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate and init
+ *      - bufSize       : size of buf, at least what _getStateSize returns
+ *
+ * Output:
+ *      - buf           : the state, _getStateSize bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Biquad_saveState(const void* stPtr, void* buf, size_t bufSize);
+
+/****************************************************************************
+ * AUP_Biquad_loadState(...)
+ *
+ * This function replaces the signal state of the handler with one written by
+ * _saveState of a handler with the same static config; the coefficient set
+ * of the handler is kept
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *      - buf           : the state
+ *      - bufSize       : size of buf, has to equal what _getStateSize returns
+ *
+ * Output:
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Biquad_loadState(void* stPtr, const void* buf, size_t bufSize);
+
 /****************************************************************************
  * AUP_Biquad_getStaticCfg(...)
  *
@@ -184,6 +284,30 @@ int AUP_Biquad_getAlgDelay(const void* stPtr, int* delayInSamples);
 int AUP_Biquad_proc(void* stPtr, const Biquad_InputData* pIn,
                     Biquad_OutputData* pOut);
 
+/****************************************************************************
+ * AUP_Biquad_procMulti(...)
+ *
+ * process a single frame on each of num handlers with identical filter
+ * coefficients, e.g. the same module of many streams; the streams are
+ * filtered together, up to AGORA_UAP_BIQUAD_MAX_LANES in SIMD lanes, with
+ * the same results as _proc on every handler
+ *
+ * Input:
+ *      - stPtrs        : [num] State Handlers which have gone through create
+ *                        and memAllocate
+ *      - pIns          : [num] input data streams, all of the same nsamples
+ *                        and sampleType
+ *      - num           : number of handlers
+ *
+ * Output:
+ *      - pOuts         : [num] output data
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Biquad_procMulti(void* const* stPtrs, const Biquad_InputData* pIns,
+                         Biquad_OutputData* pOuts, int num);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,7 @@
 typedef struct Biquad_St_ {
   void* dynamMemPtr;    // memory pointer holding the dynamic memory
   size_t dynamMemSize;  // size of the buffer *dynamMemPtr
+  int extMemFlag;  // 1: handler and dynamic memory live in caller's memory
 
   // Static Configuration
   Biquad_StaticCfg stCfg;
@@ -26,12 +27,9 @@ typedef struct Biquad_St_ {
   float GCoeff[AGORA_UAP_BIQUAD_MAX_SECTION];  // gain for each section
 
   // Variables
-  float* inputTempBuf;  // [maxNSample]
+  float* inputTempBuf;  // [maxNSample], float copy of short I/O
   float sectW[AGORA_UAP_BIQUAD_MAX_SECTION][2];
   // each section's register
-  float* sectOutputBuf
-      [AGORA_UAP_BIQUAD_MAX_SECTION];  //[AGORA_UAP_BIQUAD_MAX_SECTION][maxNSample]
-                                       // each section's output buffer
 } Biquad_St;
 
 #endif  // __BIQUAD_ST_H__
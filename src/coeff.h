@@ -14,6 +14,7 @@
 #define AUP_AED_ASSUMED_HOPSZ (256)
 #define AUP_AED_ASSUMED_WINDOWSZ (768)
 #define AUP_AED_ASSUMED_FFTSZ (1024)
+#define AUP_AED_PRE_EMPH_COEF (0.97f)  // x[n] - a * x[n - 1] ahead of the STFT
 
 // means of inpu-mel-filterbank
 const float AUP_AED_FEATURE_MEANS[AUP_AED_MEAN_STD_NBINS] = {
@@ -40,6 +40,61 @@ void AUP_FFTW_InplaceTransf(int direction, int fftSz, float* inplaceTranfBuf);
 void AUP_FFTW_RescaleFFTOut(int fftSz, float* inplaceBuf);
 void AUP_FFTW_RescaleIFFTOut(int fftSz, float* inplaceBuf);
 
+// SIMD kernels (fftw_simd.cc), dispatched at runtime on x86 (SSE2 / AVX2) and
+// at compile time on NEON / WASM SIMD128; build with AUP_FFTW_SIMD=0 to use
+// the scalar reference above everywhere
+// 1024-point real FFT, output in format1 without the 1/N scaling, i.e. the
+// same as AUP_FFTW_r2c_1024 + AUP_FFTW_InplaceTransf(1) +
+// AUP_FFTW_RescaleFFTOut within float rounding
+void AUP_FFTW_r2c_1024_fmt1(const float* in, float* out);
+// out[i] = in[i] * win[i], i < len
+void AUP_FFTW_mulWindow(const float* in, const float* win, int len,
+                        float* out);
+// power of the (fftSz / 2 + 1) bins of a format1 spectrum
+void AUP_FFTW_binPower(int fftSz, const float* in, float* binPow);
+// cross-correlation at lags [0, lags): xcorr[i] = sum_j x[j] * y[i + j],
+// j < len; y holds len + lags - 1 samples
+void AUP_FFTW_xcorrLags(const float* x, const float* y, int len, int lags,
+                        float* xcorr);
+// direct-form FIR with a unit leading tap:
+// out[n] = in[n] + sum_k coef[k] * in[n - 1 - k], k < order, n < len;
+// in[-order .. -1] holds the history
+void AUP_FFTW_firBlock(const float* in, const float* coef, int order, int len,
+                       float* out);
+// cascade of nSect biquad sections over lanes independent streams sharing
+// the filter, interleaved as x[n * lanes + c], n < len, in place; section s
+// has coef[6 * s .. 6 * s + 5] = {a1, a2, b0, b1, b2, g} and the registers
+// w[2 * s * lanes + c] (w0) and w[(2 * s + 1) * lanes + c] (w1):
+// t = x - a1 * w0 - a2 * w1, x = g * (b0 * t + b1 * w0 + b2 * w1)
+void AUP_FFTW_biquadLanes(float* x, int len, int lanes, const float* coef,
+                          int nSect, float* w);
+// SoA kernels over AUP_FFTW_lanes() streams, one stream per SIMD lane,
+// interleaved as x[n * lanes + c]; per lane bit-identical to the kernels
+// above
+#define AUP_FFTW_MAX_LANES (8)
+// streams of the SoA kernels: 8 with AVX2, 4 with SSE2 / NEON / WASM
+// SIMD128, 0 in scalar builds, which have no SoA kernels
+int AUP_FFTW_lanes(void);
+// x[n * lanes + c] = in[c][n] and its inverse out[c][n] = x[n * lanes + c],
+// n < len; in / out hold lanes stream pointers
+void AUP_FFTW_interleaveLanes(const float* const* in, int len, float* x);
+void AUP_FFTW_deinterleaveLanes(const float* x, int len, float* const* out);
+// AUP_FFTW_r2c_1024_fmt1 of lanes streams in place, x holds 1024 * lanes
+// floats, the format1 spectra are interleaved the same way; work is scratch
+// of 1024 * lanes floats
+void AUP_FFTW_r2c_1024_fmt1Lanes(float* x, float* work);
+// AUP_FFTW_binPower of lanes interleaved format1 spectra, binPow[k * lanes +
+// c], k <= fftSz / 2
+void AUP_FFTW_binPowerLanes(int fftSz, const float* in, float* binPow);
+// polynomial approximations of ln and exp for the fast math mode of the
+// feature paths, the same bits on every instruction set: out[i] = ln(in[i]),
+// in[i] > 0 and normal, within 5e-8 absolute for |out[i]| <= 1 and 1 ulp
+// beyond; out[i] = exp(in[i]) within 1 ulp, in[i] clamped to [-87, 88]
+void AUP_FFTW_fastLog(const float* in, int len, float* out);
+void AUP_FFTW_fastExp(const float* in, int len, float* out);
+// 0: scalar, 1: SSE2 / NEON / WASM SIMD128, 2: AVX2
+int AUP_FFTW_simdLevel(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,762 @@
+//
+// Copyright © 2025 Agora
+// This file is part of TEN Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fftw.h"
+
+#ifndef AUP_FFTW_SIMD
+#define AUP_FFTW_SIMD (1)
+#endif
+
+#if AUP_FFTW_SIMD && (defined(__SSE2__) || defined(_M_X64) || \
+                      (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define AUP_FFTW_HAS_SSE (1)
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__) || defined(__AVX2__)
+#define AUP_FFTW_HAS_AVX2 (1)
+#endif
+#elif AUP_FFTW_SIMD && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define AUP_FFTW_HAS_NEON (1)
+#include <arm_neon.h>
+#elif AUP_FFTW_SIMD && defined(__wasm_simd128__)
+#define AUP_FFTW_HAS_WASM (1)
+#include <wasm_simd128.h>
+#endif
+
+#define AUP_FFTW_SIMD_CPLXSZ (512)  // complex FFT size behind the 1024 rFFT
+#define AUP_FFTW_SIMD_PAD (8)
+
+// twiddles of the Stockham stages, per stage: [w1r, w1i, w2r, w2i, w3r, w3i]
+// with n / 4 entries each; post-processing twiddles W^k = exp(-j*2*pi*k/1024)
+typedef struct AUP_FFTW_SimdTab_ {
+  float tw512[6 * 128];
+  float tw128[6 * 32];
+  float tw32[6 * 8];
+  float tw8[6 * 2];
+  float postR[AUP_FFTW_SIMD_CPLXSZ];
+  float postI[AUP_FFTW_SIMD_CPLXSZ];
+} AUP_FFTW_SimdTab;
+
+#if defined(AUP_FFTW_HAS_SSE) || defined(AUP_FFTW_HAS_NEON) || \
+    defined(AUP_FFTW_HAS_WASM)
+static void AUP_FFTW_fillStageTw(int n, float* tw) {
+  const double pi = 3.14159265358979323846;
+  const int m = n >> 2;
+  int p, k;
+  for (k = 1; k <= 3; k++) {
+    for (p = 0; p < m; p++) {
+      double arg = -2.0 * pi * (double)(k * p) / (double)n;
+      tw[(2 * k - 2) * m + p] = (float)cos(arg);
+      tw[(2 * k - 1) * m + p] = (float)sin(arg);
+    }
+  }
+}
+
+static AUP_FFTW_SimdTab AUP_FFTW_makeSimdTab() {
+  const double pi = 3.14159265358979323846;
+  AUP_FFTW_SimdTab tab;
+  int k;
+  AUP_FFTW_fillStageTw(512, tab.tw512);
+  AUP_FFTW_fillStageTw(128, tab.tw128);
+  AUP_FFTW_fillStageTw(32, tab.tw32);
+  AUP_FFTW_fillStageTw(8, tab.tw8);
+  for (k = 0; k < AUP_FFTW_SIMD_CPLXSZ; k++) {
+    double arg = -2.0 * pi * (double)k / 1024.0;
+    tab.postR[k] = (float)cos(arg);
+    tab.postI[k] = (float)sin(arg);
+  }
+  return tab;
+}
+
+static const AUP_FFTW_SimdTab* AUP_FFTW_simdTab() {
+  static const AUP_FFTW_SimdTab tab = AUP_FFTW_makeSimdTab();
+  return &tab;
+}
+#endif
+
+// polynomial ln / exp of AUP_FFTW_fastLog / AUP_FFTW_fastExp, after Cephes
+// logf / expf: ln(x) = ln(m) + e * ln2 with x = m * 2^e, m in [sqrt(0.5),
+// sqrt(2)), ln(1 + r) = r - r^2 / 2 + r^3 * P(r); exp(x) = 2^n * exp(r) with
+// n = round(x / ln2), exp(r) = 1 + r + r^2 * Q(r); ln2 is split in two
+// parts for the reduction. The SIMD kernels run the same steps per lane.
+static const float AUP_FFTW_LOG_POLY[9] = {
+    7.0376836292e-2f,  -1.1514610310e-1f, 1.1676998740e-1f,
+    -1.2420140846e-1f, 1.4249322787e-1f,  -1.6668057665e-1f,
+    2.0000714765e-1f,  -2.4999993993e-1f, 3.3333331174e-1f};
+static const float AUP_FFTW_EXP_POLY[6] = {
+    1.9875691500e-4f, 1.3981999507e-3f, 8.3334519073e-3f,
+    4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f};
+#define AUP_FFTW_LN2_HI (0.693359375f)
+#define AUP_FFTW_LN2_LO (-2.12194440e-4f)
+#define AUP_FFTW_LOG2E (1.44269504089f)
+#define AUP_FFTW_EXP_MIN (-87.0f)  // keeps 2^n a normal float
+#define AUP_FFTW_EXP_MAX (88.0f)
+// (x + 1.5 * 2^23) - 1.5 * 2^23 rounds x to the nearest integer, |x| < 2^22
+#define AUP_FFTW_ROUND_MAGIC (12582912.0f)
+#define AUP_FFTW_SQRTHALF_BITS (0x3f3504f3)  // sqrt(0.5)
+
+static inline float AUP_FFTW_fastLog1(float x) {
+  int32_t i, e;
+  float m, z, y;
+  int k;
+  memcpy(&i, &x, sizeof(i));
+  e = (i - AUP_FFTW_SQRTHALF_BITS) >> 23;
+  i -= (int32_t)((uint32_t)e << 23);
+  memcpy(&m, &i, sizeof(m));
+  m = m - 1.0f;
+  z = m * m;
+  y = AUP_FFTW_LOG_POLY[0];
+  for (k = 1; k < 9; k++) {
+    y = y * m + AUP_FFTW_LOG_POLY[k];
+  }
+  y = (y * m) * z;
+  y = y + (float)e * AUP_FFTW_LN2_LO;
+  y = y + z * -0.5f;
+  m = m + y;
+  return m + (float)e * AUP_FFTW_LN2_HI;
+}
+
+static inline float AUP_FFTW_fastExp1(float x) {
+  int32_t i;
+  float n, z, y;
+  int k;
+  x = x < AUP_FFTW_EXP_MIN ? AUP_FFTW_EXP_MIN : x;
+  x = x > AUP_FFTW_EXP_MAX ? AUP_FFTW_EXP_MAX : x;
+  n = (x * AUP_FFTW_LOG2E + AUP_FFTW_ROUND_MAGIC) - AUP_FFTW_ROUND_MAGIC;
+  x = x - n * AUP_FFTW_LN2_HI;
+  x = x - n * AUP_FFTW_LN2_LO;
+  z = x * x;
+  y = AUP_FFTW_EXP_POLY[0];
+  for (k = 1; k < 6; k++) {
+    y = y * x + AUP_FFTW_EXP_POLY[k];
+  }
+  y = y * z + x + 1.0f;
+  i = (int32_t)((uint32_t)((int32_t)n + 127) << 23);
+  memcpy(&z, &i, sizeof(z));
+  return y * z;
+}
+
+#if defined(AUP_FFTW_HAS_SSE)
+#define AUP_FFTW_VW 4
+#define AUP_FFTW_SFX(name) AUP_FFTW_##name##_sse
+#define VT __m128
+#define V_LD(p) _mm_loadu_ps(p)
+#define V_ST(p, v) _mm_storeu_ps((p), (v))
+#define V_ADD(a, b) _mm_add_ps((a), (b))
+#define V_SUB(a, b) _mm_sub_ps((a), (b))
+#define V_MUL(a, b) _mm_mul_ps((a), (b))
+#define V_DUP(s) _mm_set1_ps(s)
+#define V_REV(v) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(0, 1, 2, 3))
+#define V_LD2(p, a, b)                                \
+  do {                                                \
+    __m128 ld2x0 = _mm_loadu_ps(p);                   \
+    __m128 ld2x1 = _mm_loadu_ps((p) + 4);             \
+    a = _mm_shuffle_ps(ld2x0, ld2x1, _MM_SHUFFLE(2, 0, 2, 0)); \
+    b = _mm_shuffle_ps(ld2x0, ld2x1, _MM_SHUFFLE(3, 1, 3, 1)); \
+  } while (0)
+#define V_ST2(p, a, b)                                \
+  do {                                                \
+    __m128 st2a = (a), st2b = (b);                    \
+    _mm_storeu_ps((p), _mm_unpacklo_ps(st2a, st2b));  \
+    _mm_storeu_ps((p) + 4, _mm_unpackhi_ps(st2a, st2b)); \
+  } while (0)
+#define V_ST4(p, a, b, c, d)                          \
+  do {                                                \
+    __m128 st4a = (a), st4b = (b), st4c = (c), st4d = (d); \
+    _MM_TRANSPOSE4_PS(st4a, st4b, st4c, st4d);        \
+    _mm_storeu_ps((p), st4a);                         \
+    _mm_storeu_ps((p) + 4, st4b);                     \
+    _mm_storeu_ps((p) + 8, st4c);                     \
+    _mm_storeu_ps((p) + 12, st4d);                    \
+  } while (0)
+#define V_TR(r) _MM_TRANSPOSE4_PS((r)[0], (r)[1], (r)[2], (r)[3])
+#define V_MIN(a, b) _mm_min_ps((a), (b))
+#define V_MAX(a, b) _mm_max_ps((a), (b))
+#define V_LOGSPLIT(v, m, e)                                          \
+  do {                                                               \
+    __m128i lsi = _mm_castps_si128(v);                               \
+    __m128i lse = _mm_srai_epi32(                                    \
+        _mm_sub_epi32(lsi, _mm_set1_epi32(AUP_FFTW_SQRTHALF_BITS)), 23); \
+    m = _mm_castsi128_ps(_mm_sub_epi32(lsi, _mm_slli_epi32(lse, 23))); \
+    e = _mm_cvtepi32_ps(lse);                                        \
+  } while (0)
+#define V_POW2N(n) \
+  _mm_castsi128_ps(_mm_slli_epi32( \
+      _mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23))
+#include "fftw_simd_impl.h"
+#undef AUP_FFTW_VW
+#undef AUP_FFTW_SFX
+#undef VT
+#undef V_LD
+#undef V_ST
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DUP
+#undef V_REV
+#undef V_LD2
+#undef V_ST2
+#undef V_ST4
+#undef V_TR
+#undef V_MIN
+#undef V_MAX
+#undef V_LOGSPLIT
+#undef V_POW2N
+#endif
+
+#if defined(AUP_FFTW_HAS_AVX2)
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), \
+                             apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+#define AUP_FFTW_VW 8
+#define AUP_FFTW_SFX(name) AUP_FFTW_##name##_avx2
+#define VT __m256
+#define V_LD(p) _mm256_loadu_ps(p)
+#define V_ST(p, v) _mm256_storeu_ps((p), (v))
+#define V_ADD(a, b) _mm256_add_ps((a), (b))
+#define V_SUB(a, b) _mm256_sub_ps((a), (b))
+#define V_MUL(a, b) _mm256_mul_ps((a), (b))
+#define V_DUP(s) _mm256_set1_ps(s)
+#define V_REV(v) \
+  _mm256_permutevar8x32_ps((v), _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0))
+#define V_LD2(p, a, b)                                                    \
+  do {                                                                    \
+    __m256 ld2x0 = _mm256_loadu_ps(p);                                    \
+    __m256 ld2x1 = _mm256_loadu_ps((p) + 8);                              \
+    a = _mm256_castpd_ps(_mm256_permute4x64_pd(                           \
+        _mm256_castps_pd(                                                 \
+            _mm256_shuffle_ps(ld2x0, ld2x1, _MM_SHUFFLE(2, 0, 2, 0))),    \
+        _MM_SHUFFLE(3, 1, 2, 0)));                                        \
+    b = _mm256_castpd_ps(_mm256_permute4x64_pd(                           \
+        _mm256_castps_pd(                                                 \
+            _mm256_shuffle_ps(ld2x0, ld2x1, _MM_SHUFFLE(3, 1, 3, 1))),    \
+        _MM_SHUFFLE(3, 1, 2, 0)));                                        \
+  } while (0)
+#define V_ST2(p, a, b)                                                    \
+  do {                                                                    \
+    __m256 st2lo = _mm256_unpacklo_ps((a), (b));                          \
+    __m256 st2hi = _mm256_unpackhi_ps((a), (b));                          \
+    _mm256_storeu_ps((p), _mm256_permute2f128_ps(st2lo, st2hi, 0x20));    \
+    _mm256_storeu_ps((p) + 8, _mm256_permute2f128_ps(st2lo, st2hi, 0x31)); \
+  } while (0)
+#define V_TR(r)                                                           \
+  do {                                                                    \
+    __m256 trt0 = _mm256_unpacklo_ps((r)[0], (r)[1]);                     \
+    __m256 trt1 = _mm256_unpackhi_ps((r)[0], (r)[1]);                     \
+    __m256 trt2 = _mm256_unpacklo_ps((r)[2], (r)[3]);                     \
+    __m256 trt3 = _mm256_unpackhi_ps((r)[2], (r)[3]);                     \
+    __m256 trt4 = _mm256_unpacklo_ps((r)[4], (r)[5]);                     \
+    __m256 trt5 = _mm256_unpackhi_ps((r)[4], (r)[5]);                     \
+    __m256 trt6 = _mm256_unpacklo_ps((r)[6], (r)[7]);                     \
+    __m256 trt7 = _mm256_unpackhi_ps((r)[6], (r)[7]);                     \
+    __m256 trs0 = _mm256_shuffle_ps(trt0, trt2, _MM_SHUFFLE(1, 0, 1, 0)); \
+    __m256 trs1 = _mm256_shuffle_ps(trt0, trt2, _MM_SHUFFLE(3, 2, 3, 2)); \
+    __m256 trs2 = _mm256_shuffle_ps(trt1, trt3, _MM_SHUFFLE(1, 0, 1, 0)); \
+    __m256 trs3 = _mm256_shuffle_ps(trt1, trt3, _MM_SHUFFLE(3, 2, 3, 2)); \
+    __m256 trs4 = _mm256_shuffle_ps(trt4, trt6, _MM_SHUFFLE(1, 0, 1, 0)); \
+    __m256 trs5 = _mm256_shuffle_ps(trt4, trt6, _MM_SHUFFLE(3, 2, 3, 2)); \
+    __m256 trs6 = _mm256_shuffle_ps(trt5, trt7, _MM_SHUFFLE(1, 0, 1, 0)); \
+    __m256 trs7 = _mm256_shuffle_ps(trt5, trt7, _MM_SHUFFLE(3, 2, 3, 2)); \
+    (r)[0] = _mm256_permute2f128_ps(trs0, trs4, 0x20);                    \
+    (r)[1] = _mm256_permute2f128_ps(trs1, trs5, 0x20);                    \
+    (r)[2] = _mm256_permute2f128_ps(trs2, trs6, 0x20);                    \
+    (r)[3] = _mm256_permute2f128_ps(trs3, trs7, 0x20);                    \
+    (r)[4] = _mm256_permute2f128_ps(trs0, trs4, 0x31);                    \
+    (r)[5] = _mm256_permute2f128_ps(trs1, trs5, 0x31);                    \
+    (r)[6] = _mm256_permute2f128_ps(trs2, trs6, 0x31);                    \
+    (r)[7] = _mm256_permute2f128_ps(trs3, trs7, 0x31);                    \
+  } while (0)
+#define V_MIN(a, b) _mm256_min_ps((a), (b))
+#define V_MAX(a, b) _mm256_max_ps((a), (b))
+#define V_LOGSPLIT(v, m, e)                                               \
+  do {                                                                    \
+    __m256i lsi = _mm256_castps_si256(v);                                 \
+    __m256i lse = _mm256_srai_epi32(                                      \
+        _mm256_sub_epi32(lsi, _mm256_set1_epi32(AUP_FFTW_SQRTHALF_BITS)), \
+        23);                                                              \
+    m = _mm256_castsi256_ps(                                              \
+        _mm256_sub_epi32(lsi, _mm256_slli_epi32(lse, 23)));               \
+    e = _mm256_cvtepi32_ps(lse);                                          \
+  } while (0)
+#define V_POW2N(n)                                                  \
+  _mm256_castsi256_ps(_mm256_slli_epi32(                            \
+      _mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127)), \
+      23))
+// the stride 1 and 4 stages are narrower than a vector, reuse the SSE ones
+#define AUP_FFTW_NARROW_STAGE4FIRST AUP_FFTW_stage4First_sse
+#define AUP_FFTW_NARROW_STAGE4 AUP_FFTW_stage4_sse
+#include "fftw_simd_impl.h"
+#undef AUP_FFTW_NARROW_STAGE4FIRST
+#undef AUP_FFTW_NARROW_STAGE4
+#undef AUP_FFTW_VW
+#undef AUP_FFTW_SFX
+#undef VT
+#undef V_LD
+#undef V_ST
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DUP
+#undef V_REV
+#undef V_LD2
+#undef V_ST2
+#undef V_TR
+#undef V_MIN
+#undef V_MAX
+#undef V_LOGSPLIT
+#undef V_POW2N
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+
+#if defined(AUP_FFTW_HAS_NEON)
+#define AUP_FFTW_VW 4
+#define AUP_FFTW_SFX(name) AUP_FFTW_##name##_neon
+#define VT float32x4_t
+#define V_LD(p) vld1q_f32(p)
+#define V_ST(p, v) vst1q_f32((p), (v))
+#define V_ADD(a, b) vaddq_f32((a), (b))
+#define V_SUB(a, b) vsubq_f32((a), (b))
+#define V_MUL(a, b) vmulq_f32((a), (b))
+#define V_DUP(s) vdupq_n_f32(s)
+#define V_REV(v) \
+  vcombine_f32(vget_high_f32(vrev64q_f32(v)), vget_low_f32(vrev64q_f32(v)))
+#define V_LD2(p, a, b)                  \
+  do {                                  \
+    float32x4x2_t ld2v = vld2q_f32(p);  \
+    a = ld2v.val[0];                    \
+    b = ld2v.val[1];                    \
+  } while (0)
+#define V_ST2(p, a, b)                  \
+  do {                                  \
+    float32x4x2_t st2v;                 \
+    st2v.val[0] = (a);                  \
+    st2v.val[1] = (b);                  \
+    vst2q_f32((p), st2v);               \
+  } while (0)
+#define V_ST4(p, a, b, c, d)            \
+  do {                                  \
+    float32x4x4_t st4v;                 \
+    st4v.val[0] = (a);                  \
+    st4v.val[1] = (b);                  \
+    st4v.val[2] = (c);                  \
+    st4v.val[3] = (d);                  \
+    vst4q_f32((p), st4v);               \
+  } while (0)
+#define V_TR(r)                                                       \
+  do {                                                                \
+    float32x4x2_t trt01 = vtrnq_f32((r)[0], (r)[1]);                  \
+    float32x4x2_t trt23 = vtrnq_f32((r)[2], (r)[3]);                  \
+    (r)[0] = vcombine_f32(vget_low_f32(trt01.val[0]),                 \
+                          vget_low_f32(trt23.val[0]));                \
+    (r)[1] = vcombine_f32(vget_low_f32(trt01.val[1]),                 \
+                          vget_low_f32(trt23.val[1]));                \
+    (r)[2] = vcombine_f32(vget_high_f32(trt01.val[0]),                \
+                          vget_high_f32(trt23.val[0]));               \
+    (r)[3] = vcombine_f32(vget_high_f32(trt01.val[1]),                \
+                          vget_high_f32(trt23.val[1]));               \
+  } while (0)
+#define V_MIN(a, b) vminq_f32((a), (b))
+#define V_MAX(a, b) vmaxq_f32((a), (b))
+#define V_LOGSPLIT(v, m, e)                                               \
+  do {                                                                    \
+    int32x4_t lsi = vreinterpretq_s32_f32(v);                             \
+    int32x4_t lse = vshrq_n_s32(                                          \
+        vsubq_s32(lsi, vdupq_n_s32(AUP_FFTW_SQRTHALF_BITS)), 23);         \
+    m = vreinterpretq_f32_s32(vsubq_s32(lsi, vshlq_n_s32(lse, 23)));      \
+    e = vcvtq_f32_s32(lse);                                               \
+  } while (0)
+#define V_POW2N(n)                                                        \
+  vreinterpretq_f32_s32(                                                  \
+      vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23))
+#include "fftw_simd_impl.h"
+#endif
+
+#if defined(AUP_FFTW_HAS_WASM)
+#define AUP_FFTW_VW 4
+#define AUP_FFTW_SFX(name) AUP_FFTW_##name##_wasm
+#define VT v128_t
+#define V_LD(p) wasm_v128_load(p)
+#define V_ST(p, v) wasm_v128_store((p), (v))
+#define V_ADD(a, b) wasm_f32x4_add((a), (b))
+#define V_SUB(a, b) wasm_f32x4_sub((a), (b))
+#define V_MUL(a, b) wasm_f32x4_mul((a), (b))
+#define V_DUP(s) wasm_f32x4_splat(s)
+#define V_REV(v) wasm_i32x4_shuffle((v), (v), 3, 2, 1, 0)
+#define V_LD2(p, a, b)                                 \
+  do {                                                 \
+    v128_t ld2x0 = wasm_v128_load(p);                  \
+    v128_t ld2x1 = wasm_v128_load((p) + 4);            \
+    a = wasm_i32x4_shuffle(ld2x0, ld2x1, 0, 2, 4, 6);  \
+    b = wasm_i32x4_shuffle(ld2x0, ld2x1, 1, 3, 5, 7);  \
+  } while (0)
+#define V_ST2(p, a, b)                                               \
+  do {                                                               \
+    v128_t st2a = (a), st2b = (b);                                   \
+    wasm_v128_store((p), wasm_i32x4_shuffle(st2a, st2b, 0, 4, 1, 5)); \
+    wasm_v128_store((p) + 4,                                         \
+                    wasm_i32x4_shuffle(st2a, st2b, 2, 6, 3, 7));     \
+  } while (0)
+#define V_ST4(p, a, b, c, d)                                    \
+  do {                                                          \
+    v128_t st4t0 = wasm_i32x4_shuffle((a), (b), 0, 4, 1, 5);    \
+    v128_t st4t1 = wasm_i32x4_shuffle((c), (d), 0, 4, 1, 5);    \
+    v128_t st4t2 = wasm_i32x4_shuffle((a), (b), 2, 6, 3, 7);    \
+    v128_t st4t3 = wasm_i32x4_shuffle((c), (d), 2, 6, 3, 7);    \
+    wasm_v128_store((p), wasm_i32x4_shuffle(st4t0, st4t1, 0, 1, 4, 5));  \
+    wasm_v128_store((p) + 4,                                    \
+                    wasm_i32x4_shuffle(st4t0, st4t1, 2, 3, 6, 7)); \
+    wasm_v128_store((p) + 8,                                    \
+                    wasm_i32x4_shuffle(st4t2, st4t3, 0, 1, 4, 5)); \
+    wasm_v128_store((p) + 12,                                   \
+                    wasm_i32x4_shuffle(st4t2, st4t3, 2, 3, 6, 7)); \
+  } while (0)
+#define V_TR(r)                                                    \
+  do {                                                             \
+    v128_t trt0 = wasm_i32x4_shuffle((r)[0], (r)[1], 0, 4, 1, 5);  \
+    v128_t trt1 = wasm_i32x4_shuffle((r)[0], (r)[1], 2, 6, 3, 7);  \
+    v128_t trt2 = wasm_i32x4_shuffle((r)[2], (r)[3], 0, 4, 1, 5);  \
+    v128_t trt3 = wasm_i32x4_shuffle((r)[2], (r)[3], 2, 6, 3, 7);  \
+    (r)[0] = wasm_i32x4_shuffle(trt0, trt2, 0, 1, 4, 5);           \
+    (r)[1] = wasm_i32x4_shuffle(trt0, trt2, 2, 3, 6, 7);           \
+    (r)[2] = wasm_i32x4_shuffle(trt1, trt3, 0, 1, 4, 5);           \
+    (r)[3] = wasm_i32x4_shuffle(trt1, trt3, 2, 3, 6, 7);           \
+  } while (0)
+#define V_MIN(a, b) wasm_f32x4_min((a), (b))
+#define V_MAX(a, b) wasm_f32x4_max((a), (b))
+#define V_LOGSPLIT(v, m, e)                                               \
+  do {                                                                    \
+    v128_t lse = wasm_i32x4_shr(                                          \
+        wasm_i32x4_sub((v), wasm_i32x4_splat(AUP_FFTW_SQRTHALF_BITS)), 23); \
+    m = wasm_i32x4_sub((v), wasm_i32x4_shl(lse, 23));                     \
+    e = wasm_f32x4_convert_i32x4(lse);                                    \
+  } while (0)
+#define V_POW2N(n)                                                        \
+  wasm_i32x4_shl(                                                         \
+      wasm_i32x4_add(wasm_i32x4_trunc_sat_f32x4(n), wasm_i32x4_splat(127)), \
+      23)
+#include "fftw_simd_impl.h"
+#endif
+
+// 0: scalar reference, 1: SSE2 / NEON / WASM SIMD128, 2: AVX2
+static int AUP_FFTW_detectSimdLevel() {
+#if defined(AUP_FFTW_HAS_AVX2) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? 2 : 1;
+#elif defined(AUP_FFTW_HAS_AVX2)
+  return 2;  // MSVC: only built in when the compiler targets AVX2
+#elif defined(AUP_FFTW_HAS_SSE) || defined(AUP_FFTW_HAS_NEON) || \
+    defined(AUP_FFTW_HAS_WASM)
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+extern "C" {
+
+int AUP_FFTW_simdLevel(void) {
+  static const int level = AUP_FFTW_detectSimdLevel();
+  return level;
+}
+
+void AUP_FFTW_r2c_1024_fmt1(const float* in, float* out) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_r2c1024_avx2(in, out, AUP_FFTW_simdTab());
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_r2c1024_sse(in, out, AUP_FFTW_simdTab());
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_r2c1024_neon(in, out, AUP_FFTW_simdTab());
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_r2c1024_wasm(in, out, AUP_FFTW_simdTab());
+#else
+  AUP_FFTW_r2c_1024((float*)in, out);
+  AUP_FFTW_InplaceTransf(1, 1024, out);
+  AUP_FFTW_RescaleFFTOut(1024, out);
+#endif
+}
+
+void AUP_FFTW_mulWindow(const float* in, const float* win, int len,
+                        float* out) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_mulWindow_avx2(in, win, len, out);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_mulWindow_sse(in, win, len, out);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_mulWindow_neon(in, win, len, out);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_mulWindow_wasm(in, win, len, out);
+#else
+  int idx;
+  for (idx = 0; idx < len; idx++) {
+    out[idx] = in[idx] * win[idx];
+  }
+#endif
+}
+
+void AUP_FFTW_binPower(int fftSz, const float* in, float* binPow) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_binPower_avx2(fftSz, in, binPow);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_binPower_sse(fftSz, in, binPow);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_binPower_neon(fftSz, in, binPow);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_binPower_wasm(fftSz, in, binPow);
+#else
+  const int halfSz = fftSz >> 1;
+  int idx;
+  binPow[0] = in[0] * in[0];
+  binPow[halfSz] = in[1] * in[1];
+  for (idx = 1; idx < halfSz; idx++) {
+    binPow[idx] =
+        in[2 * idx] * in[2 * idx] + in[2 * idx + 1] * in[2 * idx + 1];
+  }
+#endif
+}
+
+void AUP_FFTW_xcorrLags(const float* x, const float* y, int len, int lags,
+                        float* xcorr) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_xcorrLags_avx2(x, y, len, lags, xcorr);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_xcorrLags_sse(x, y, len, lags, xcorr);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_xcorrLags_neon(x, y, len, lags, xcorr);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_xcorrLags_wasm(x, y, len, lags, xcorr);
+#else
+  int i, j;
+  for (i = 0; i < lags; i++) {
+    float acc = 0.0f;
+    for (j = 0; j < len; j++) {
+      acc += x[j] * y[i + j];
+    }
+    xcorr[i] = acc;
+  }
+#endif
+}
+
+void AUP_FFTW_firBlock(const float* in, const float* coef, int order, int len,
+                       float* out) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_firBlock_avx2(in, coef, order, len, out);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_firBlock_sse(in, coef, order, len, out);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_firBlock_neon(in, coef, order, len, out);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_firBlock_wasm(in, coef, order, len, out);
+#else
+  int n, k;
+  for (n = 0; n < len; n++) {
+    float acc = in[n];
+    for (k = 0; k < order; k++) {
+      acc += coef[k] * in[n - 1 - k];
+    }
+    out[n] = acc;
+  }
+#endif
+}
+
+int AUP_FFTW_lanes(void) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    return 8;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE) || defined(AUP_FFTW_HAS_NEON) || \
+    defined(AUP_FFTW_HAS_WASM)
+  return 4;
+#else
+  return 0;
+#endif
+}
+
+void AUP_FFTW_interleaveLanes(const float* const* in, int len, float* x) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_interleaveLanes_avx2(in, len, x);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_interleaveLanes_sse(in, len, x);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_interleaveLanes_neon(in, len, x);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_interleaveLanes_wasm(in, len, x);
+#else
+  (void)in;
+  (void)len;
+  (void)x;
+#endif
+}
+
+void AUP_FFTW_deinterleaveLanes(const float* x, int len, float* const* out) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_deinterleaveLanes_avx2(x, len, out);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_deinterleaveLanes_sse(x, len, out);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_deinterleaveLanes_neon(x, len, out);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_deinterleaveLanes_wasm(x, len, out);
+#else
+  (void)x;
+  (void)len;
+  (void)out;
+#endif
+}
+
+void AUP_FFTW_r2c_1024_fmt1Lanes(float* x, float* work) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_r2c1024Lanes_avx2(x, work, AUP_FFTW_simdTab());
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_r2c1024Lanes_sse(x, work, AUP_FFTW_simdTab());
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_r2c1024Lanes_neon(x, work, AUP_FFTW_simdTab());
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_r2c1024Lanes_wasm(x, work, AUP_FFTW_simdTab());
+#else
+  (void)x;
+  (void)work;
+#endif
+}
+
+void AUP_FFTW_binPowerLanes(int fftSz, const float* in, float* binPow) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_binPowerLanes_avx2(fftSz, in, binPow);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_binPowerLanes_sse(fftSz, in, binPow);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_binPowerLanes_neon(fftSz, in, binPow);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_binPowerLanes_wasm(fftSz, in, binPow);
+#else
+  (void)fftSz;
+  (void)in;
+  (void)binPow;
+#endif
+}
+
+void AUP_FFTW_fastLog(const float* in, int len, float* out) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_fastLog_avx2(in, len, out);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_fastLog_sse(in, len, out);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_fastLog_neon(in, len, out);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_fastLog_wasm(in, len, out);
+#else
+  int idx;
+  for (idx = 0; idx < len; idx++) {
+    out[idx] = AUP_FFTW_fastLog1(in[idx]);
+  }
+#endif
+}
+
+void AUP_FFTW_fastExp(const float* in, int len, float* out) {
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    AUP_FFTW_fastExp_avx2(in, len, out);
+    return;
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  AUP_FFTW_fastExp_sse(in, len, out);
+#elif defined(AUP_FFTW_HAS_NEON)
+  AUP_FFTW_fastExp_neon(in, len, out);
+#elif defined(AUP_FFTW_HAS_WASM)
+  AUP_FFTW_fastExp_wasm(in, len, out);
+#else
+  int idx;
+  for (idx = 0; idx < len; idx++) {
+    out[idx] = AUP_FFTW_fastExp1(in[idx]);
+  }
+#endif
+}
+
+void AUP_FFTW_biquadLanes(float* x, int len, int lanes, const float* coef,
+                          int nSect, float* w) {
+  int c = 0, n, s;
+#if defined(AUP_FFTW_HAS_AVX2)
+  if (AUP_FFTW_simdLevel() == 2) {
+    c = AUP_FFTW_biquadLanes_avx2(x, len, lanes, c, coef, nSect, w);
+  }
+#endif
+#if defined(AUP_FFTW_HAS_SSE)
+  c = AUP_FFTW_biquadLanes_sse(x, len, lanes, c, coef, nSect, w);
+#elif defined(AUP_FFTW_HAS_NEON)
+  c = AUP_FFTW_biquadLanes_neon(x, len, lanes, c, coef, nSect, w);
+#elif defined(AUP_FFTW_HAS_WASM)
+  c = AUP_FFTW_biquadLanes_wasm(x, len, lanes, c, coef, nSect, w);
+#endif
+  for (; c < lanes; c++) {  // lanes left over by whole vectors
+    for (n = 0; n < len; n++) {
+      float v = x[n * lanes + c];
+      for (s = 0; s < nSect; s++) {
+        const float* cs = coef + 6 * s;
+        float* ws = w + 2 * s * lanes + c;
+        const float w0 = ws[0], w1 = ws[lanes];
+        const float t = v - cs[0] * w0 - cs[1] * w1;
+        v = cs[5] * (cs[2] * t + cs[3] * w0 + cs[4] * w1);
+        ws[lanes] = w0;
+        ws[0] = t;
+      }
+      x[n * lanes + c] = v;
+    }
+  }
+}
+
+}  // extern "C"
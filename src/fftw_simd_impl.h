@@ -0,0 +1,499 @@
+//
+// Copyright © 2025 Agora
+// This file is part of TEN Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// SIMD kernels of fftw_simd.cc, included once per instruction set with the
+// following macros defined by the includer:
+//   AUP_FFTW_VW              : vector width in floats (4 or 8)
+//   AUP_FFTW_SFX(name)       : suffixes the kernel names
+//   VT                       : vector type
+//   V_LD(p) / V_ST(p, v)     : unaligned load / store
+//   V_ADD, V_SUB, V_MUL      : lane-wise arithmetic
+//   V_DUP(s)                 : broadcast a scalar
+//   V_REV(v)                 : reverse the lanes
+//   V_LD2(p, a, b)           : de-interleave 2 * VW floats into even / odd
+//   V_ST2(p, a, b)           : interleave a / b into 2 * VW floats
+//   V_ST4(p, a, b, c, d)     : interleave 4 vectors, only needed if VW == 4
+//   V_TR(r)                  : transpose the VW x VW floats of VT r[VW]
+//   V_MIN, V_MAX             : lane-wise minimum / maximum
+//   V_LOGSPLIT(v, m, e)      : v = m * 2^e, m in [sqrt(0.5), sqrt(2)), e as
+//                              float, v > 0 and normal
+//   V_POW2N(n)               : 2^n of integral n in [-126, 127]
+// No fused multiply-add is used, so the kernels give identical results for
+// every instruction set.
+
+// radix-4 butterfly of the forward transform, output k is multiplied by w_k
+#define AUP_FFTW_BFLY4(ar, ai, br, bi, cr, ci, dr, di, w1r, w1i, w2r, w2i, \
+                       w3r, w3i, y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i)    \
+  do {                                                                      \
+    VT apcr = V_ADD(ar, cr), apci = V_ADD(ai, ci);                          \
+    VT amcr = V_SUB(ar, cr), amci = V_SUB(ai, ci);                          \
+    VT bpdr = V_ADD(br, dr), bpdi = V_ADD(bi, di);                          \
+    VT bmdr = V_SUB(br, dr), bmdi = V_SUB(bi, di);                          \
+    VT t1r = V_ADD(amcr, bmdi), t1i = V_SUB(amci, bmdr);                    \
+    VT t2r = V_SUB(apcr, bpdr), t2i = V_SUB(apci, bpdi);                    \
+    VT t3r = V_SUB(amcr, bmdi), t3i = V_ADD(amci, bmdr);                    \
+    y0r = V_ADD(apcr, bpdr);                                                \
+    y0i = V_ADD(apci, bpdi);                                                \
+    y1r = V_SUB(V_MUL(t1r, w1r), V_MUL(t1i, w1i));                          \
+    y1i = V_ADD(V_MUL(t1r, w1i), V_MUL(t1i, w1r));                          \
+    y2r = V_SUB(V_MUL(t2r, w2r), V_MUL(t2i, w2i));                          \
+    y2i = V_ADD(V_MUL(t2r, w2i), V_MUL(t2i, w2r));                          \
+    y3r = V_SUB(V_MUL(t3r, w3r), V_MUL(t3i, w3i));                          \
+    y3i = V_ADD(V_MUL(t3r, w3i), V_MUL(t3i, w3r));                          \
+  } while (0)
+
+#if AUP_FFTW_VW == 4
+// first Stockham radix-4 stage (stride 1): vectorized over the butterflies,
+// the four outputs of a butterfly are adjacent and get interleaved on store
+static void AUP_FFTW_SFX(stage4First)(int n, const float* xr, const float* xi,
+                                      float* yr, float* yi, const float* tw) {
+  const int m = n >> 2;
+  int p;
+  for (p = 0; p < m; p += 4) {
+    VT y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i;
+    AUP_FFTW_BFLY4(V_LD(xr + p), V_LD(xi + p), V_LD(xr + p + m),
+                   V_LD(xi + p + m), V_LD(xr + p + 2 * m),
+                   V_LD(xi + p + 2 * m), V_LD(xr + p + 3 * m),
+                   V_LD(xi + p + 3 * m), V_LD(tw + p), V_LD(tw + m + p),
+                   V_LD(tw + 2 * m + p), V_LD(tw + 3 * m + p),
+                   V_LD(tw + 4 * m + p), V_LD(tw + 5 * m + p), y0r, y0i, y1r,
+                   y1i, y2r, y2i, y3r, y3i);
+    V_ST4(yr + 4 * p, y0r, y1r, y2r, y3r);
+    V_ST4(yi + 4 * p, y0i, y1i, y2i, y3i);
+  }
+}
+#endif
+
+// Stockham radix-4 stage with stride s (a multiple of AUP_FFTW_VW),
+// vectorized over the s interleaved sub-transforms
+static void AUP_FFTW_SFX(stage4)(int n, int s, const float* xr,
+                                 const float* xi, float* yr, float* yi,
+                                 const float* tw) {
+  const int m = n >> 2;
+  const int sm = s * m;
+  int p, q;
+  for (p = 0; p < m; p++) {
+    const VT w1r = V_DUP(tw[p]), w1i = V_DUP(tw[m + p]);
+    const VT w2r = V_DUP(tw[2 * m + p]), w2i = V_DUP(tw[3 * m + p]);
+    const VT w3r = V_DUP(tw[4 * m + p]), w3i = V_DUP(tw[5 * m + p]);
+    const float* xrp = xr + s * p;
+    const float* xip = xi + s * p;
+    float* yrp = yr + 4 * s * p;
+    float* yip = yi + 4 * s * p;
+    for (q = 0; q < s; q += AUP_FFTW_VW) {
+      VT y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i;
+      AUP_FFTW_BFLY4(V_LD(xrp + q), V_LD(xip + q), V_LD(xrp + q + sm),
+                     V_LD(xip + q + sm), V_LD(xrp + q + 2 * sm),
+                     V_LD(xip + q + 2 * sm), V_LD(xrp + q + 3 * sm),
+                     V_LD(xip + q + 3 * sm), w1r, w1i, w2r, w2i, w3r, w3i, y0r,
+                     y0i, y1r, y1i, y2r, y2i, y3r, y3i);
+      V_ST(yrp + q, y0r);
+      V_ST(yip + q, y0i);
+      V_ST(yrp + q + s, y1r);
+      V_ST(yip + q + s, y1i);
+      V_ST(yrp + q + 2 * s, y2r);
+      V_ST(yip + q + 2 * s, y2i);
+      V_ST(yrp + q + 3 * s, y3r);
+      V_ST(yip + q + 3 * s, y3i);
+    }
+  }
+}
+
+// last Stockham stage: radix-2 without twiddles, stride s
+static void AUP_FFTW_SFX(stage2Last)(int s, const float* xr, const float* xi,
+                                     float* yr, float* yi) {
+  int q;
+  for (q = 0; q < s; q += AUP_FFTW_VW) {
+    VT ar = V_LD(xr + q), ai = V_LD(xi + q);
+    VT br = V_LD(xr + q + s), bi = V_LD(xi + q + s);
+    V_ST(yr + q, V_ADD(ar, br));
+    V_ST(yi + q, V_ADD(ai, bi));
+    V_ST(yr + q + s, V_SUB(ar, br));
+    V_ST(yi + q + s, V_SUB(ai, bi));
+  }
+}
+
+// 1024-point real FFT through a 512-point complex FFT of the even / odd
+// samples, output in format1 without scaling
+static void AUP_FFTW_SFX(r2c1024)(const float* in, float* out,
+                                  const AUP_FFTW_SimdTab* tab) {
+  float bufR[2][AUP_FFTW_SIMD_CPLXSZ + AUP_FFTW_SIMD_PAD];
+  float bufI[2][AUP_FFTW_SIMD_CPLXSZ + AUP_FFTW_SIMD_PAD];
+  const VT half = V_DUP(0.5f);
+  const float* zr;
+  const float* zi;
+  int k;
+
+  // z[k] = in[2k] + j * in[2k + 1]
+  for (k = 0; k < AUP_FFTW_SIMD_CPLXSZ; k += AUP_FFTW_VW) {
+    VT re, im;
+    V_LD2(in + 2 * k, re, im);
+    V_ST(bufR[0] + k, re);
+    V_ST(bufI[0] + k, im);
+  }
+
+  // 512 = 4 * 4 * 4 * 4 * 2, Stockham auto-sort, ping-pong between buffers
+#if AUP_FFTW_VW == 4
+  AUP_FFTW_SFX(stage4First)(512, bufR[0], bufI[0], bufR[1], bufI[1],
+                            tab->tw512);
+  AUP_FFTW_SFX(stage4)(128, 4, bufR[1], bufI[1], bufR[0], bufI[0],
+                       tab->tw128);
+#else
+  AUP_FFTW_NARROW_STAGE4FIRST(512, bufR[0], bufI[0], bufR[1], bufI[1],
+                              tab->tw512);
+  AUP_FFTW_NARROW_STAGE4(128, 4, bufR[1], bufI[1], bufR[0], bufI[0],
+                         tab->tw128);
+#endif
+  AUP_FFTW_SFX(stage4)(32, 16, bufR[0], bufI[0], bufR[1], bufI[1], tab->tw32);
+  AUP_FFTW_SFX(stage4)(8, 64, bufR[1], bufI[1], bufR[0], bufI[0], tab->tw8);
+  AUP_FFTW_SFX(stage2Last)(256, bufR[0], bufI[0], bufR[1], bufI[1]);
+  zr = bufR[1];
+  zi = bufI[1];
+  bufR[1][AUP_FFTW_SIMD_CPLXSZ] = zr[0];  // Z[512] = Z[0] for the mirror
+  bufI[1][AUP_FFTW_SIMD_CPLXSZ] = zi[0];
+
+  // split: X[k] = (Z[k] + Z*[N-k]) / 2 - j * W^k * (Z[k] - Z*[N-k]) / 2
+  for (k = 0; k < AUP_FFTW_SIMD_CPLXSZ; k += AUP_FFTW_VW) {
+    const int mk = AUP_FFTW_SIMD_CPLXSZ - k - (AUP_FFTW_VW - 1);
+    VT zkr = V_LD(zr + k), zki = V_LD(zi + k);
+    VT zmr = V_REV(V_LD(zr + mk)), zmi = V_REV(V_LD(zi + mk));
+    VT er = V_MUL(V_ADD(zkr, zmr), half);
+    VT ei = V_MUL(V_SUB(zki, zmi), half);
+    VT orr = V_MUL(V_ADD(zki, zmi), half);
+    VT oi = V_MUL(V_SUB(zmr, zkr), half);
+    VT wr = V_LD(tab->postR + k), wi = V_LD(tab->postI + k);
+    VT xr = V_ADD(er, V_SUB(V_MUL(orr, wr), V_MUL(oi, wi)));
+    VT xi = V_ADD(ei, V_ADD(V_MUL(orr, wi), V_MUL(oi, wr)));
+    // format1 stores the conjugate, as the reference rdft
+    V_ST2(out + 2 * k, xr, V_SUB(V_DUP(0.0f), xi));
+  }
+  out[1] = zr[0] - zi[0];  // Nyquist bin
+}
+
+// out[idx] = in[idx] * win[idx]
+static void AUP_FFTW_SFX(mulWindow)(const float* in, const float* win, int len,
+                                    float* out) {
+  int idx;
+  for (idx = 0; idx + AUP_FFTW_VW <= len; idx += AUP_FFTW_VW) {
+    V_ST(out + idx, V_MUL(V_LD(in + idx), V_LD(win + idx)));
+  }
+  for (; idx < len; idx++) {
+    out[idx] = in[idx] * win[idx];
+  }
+}
+
+// power spectrum of a format1 spectrum of fftSz points
+static void AUP_FFTW_SFX(binPower)(int fftSz, const float* in,
+                                   float* binPow) {
+  const int halfSz = fftSz >> 1;
+  int idx;
+  for (idx = 0; idx + AUP_FFTW_VW <= halfSz; idx += AUP_FFTW_VW) {
+    VT re, im;
+    V_LD2(in + 2 * idx, re, im);
+    V_ST(binPow + idx, V_ADD(V_MUL(re, re), V_MUL(im, im)));
+  }
+  for (; idx < halfSz; idx++) {
+    binPow[idx] = in[2 * idx] * in[2 * idx] + in[2 * idx + 1] * in[2 * idx + 1];
+  }
+  binPow[0] = in[0] * in[0];
+  binPow[halfSz] = in[1] * in[1];
+}
+
+// xcorr[i] = sum_j x[j] * y[i + j], j < len, i < lags: vectorized across
+// the lags, each lane accumulates in the order of the scalar reference
+static void AUP_FFTW_SFX(xcorrLags)(const float* x, const float* y, int len,
+                                    int lags, float* xcorr) {
+  int i, j;
+  for (i = 0; i + 4 * AUP_FFTW_VW <= lags; i += 4 * AUP_FFTW_VW) {
+    const float* yi = y + i;
+    VT acc0 = V_DUP(0.0f), acc1 = V_DUP(0.0f);
+    VT acc2 = V_DUP(0.0f), acc3 = V_DUP(0.0f);
+    for (j = 0; j < len; j++) {
+      const VT xj = V_DUP(x[j]);
+      acc0 = V_ADD(acc0, V_MUL(xj, V_LD(yi + j)));
+      acc1 = V_ADD(acc1, V_MUL(xj, V_LD(yi + j + AUP_FFTW_VW)));
+      acc2 = V_ADD(acc2, V_MUL(xj, V_LD(yi + j + 2 * AUP_FFTW_VW)));
+      acc3 = V_ADD(acc3, V_MUL(xj, V_LD(yi + j + 3 * AUP_FFTW_VW)));
+    }
+    V_ST(xcorr + i, acc0);
+    V_ST(xcorr + i + AUP_FFTW_VW, acc1);
+    V_ST(xcorr + i + 2 * AUP_FFTW_VW, acc2);
+    V_ST(xcorr + i + 3 * AUP_FFTW_VW, acc3);
+  }
+  for (; i + AUP_FFTW_VW <= lags; i += AUP_FFTW_VW) {
+    VT acc = V_DUP(0.0f);
+    for (j = 0; j < len; j++) {
+      acc = V_ADD(acc, V_MUL(V_DUP(x[j]), V_LD(y + i + j)));
+    }
+    V_ST(xcorr + i, acc);
+  }
+  for (; i < lags; i++) {
+    float acc = 0.0f;
+    for (j = 0; j < len; j++) {
+      acc += x[j] * y[i + j];
+    }
+    xcorr[i] = acc;
+  }
+}
+
+// out[n] = in[n] + sum_k coef[k] * in[n - 1 - k], k < order, n < len: in is
+// preceded by order history samples, vectorized across the outputs
+static void AUP_FFTW_SFX(firBlock)(const float* in, const float* coef,
+                                   int order, int len, float* out) {
+  int n, k;
+  for (n = 0; n + AUP_FFTW_VW <= len; n += AUP_FFTW_VW) {
+    VT acc = V_LD(in + n);
+    for (k = 0; k < order; k++) {
+      acc = V_ADD(acc, V_MUL(V_DUP(coef[k]), V_LD(in + n - 1 - k)));
+    }
+    V_ST(out + n, acc);
+  }
+  for (; n < len; n++) {
+    float acc = in[n];
+    for (k = 0; k < order; k++) {
+      acc += coef[k] * in[n - 1 - k];
+    }
+    out[n] = acc;
+  }
+}
+
+// cascaded biquad sections over the lanes [c0, lanes) of x[n * lanes + c],
+// in place and vectorized across the lanes, see AUP_FFTW_biquadLanes; the
+// lanes left over by whole vectors are not touched, the end of the
+// processed lanes is returned
+static int AUP_FFTW_SFX(biquadLanes)(float* x, int len, int lanes, int c0,
+                                     const float* coef, int nSect, float* w) {
+  int c, n, s;
+  for (c = c0; c + AUP_FFTW_VW <= lanes; c += AUP_FFTW_VW) {
+    for (n = 0; n < len; n++) {
+      VT v = V_LD(x + n * lanes + c);
+      for (s = 0; s < nSect; s++) {
+        const float* cs = coef + 6 * s;
+        float* ws = w + 2 * s * lanes + c;
+        const VT w0 = V_LD(ws), w1 = V_LD(ws + lanes);
+        const VT t = V_SUB(V_SUB(v, V_MUL(V_DUP(cs[0]), w0)),
+                           V_MUL(V_DUP(cs[1]), w1));
+        v = V_MUL(V_DUP(cs[5]), V_ADD(V_ADD(V_MUL(V_DUP(cs[2]), t),
+                                            V_MUL(V_DUP(cs[3]), w0)),
+                                      V_MUL(V_DUP(cs[4]), w1)));
+        V_ST(ws + lanes, w0);
+        V_ST(ws, t);
+      }
+      V_ST(x + n * lanes + c, v);
+    }
+  }
+  return c;
+}
+
+// SoA layout of the lane kernels: AUP_FFTW_VW streams interleaved, complex
+// element e of a buffer has its real parts at 2 * e * AUP_FFTW_VW and its
+// imaginary parts right behind
+#define AUP_FFTW_LRE(b, e) ((b) + 2 * (e) * AUP_FFTW_VW)
+#define AUP_FFTW_LIM(b, e) ((b) + (2 * (e) + 1) * AUP_FFTW_VW)
+
+// Stockham radix-4 stage with stride s of AUP_FFTW_VW streams, one stream per
+// lane; element by element the arithmetic of stage4First / stage4
+static void AUP_FFTW_SFX(stage4Lanes)(int n, int s, const float* x, float* y,
+                                      const float* tw) {
+  const int m = n >> 2;
+  const int sm = s * m;
+  int p, q, e, o;
+  for (p = 0; p < m; p++) {
+    const VT w1r = V_DUP(tw[p]), w1i = V_DUP(tw[m + p]);
+    const VT w2r = V_DUP(tw[2 * m + p]), w2i = V_DUP(tw[3 * m + p]);
+    const VT w3r = V_DUP(tw[4 * m + p]), w3i = V_DUP(tw[5 * m + p]);
+    for (q = 0; q < s; q++) {
+      VT y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i;
+      e = q + s * p;
+      o = q + 4 * s * p;
+      AUP_FFTW_BFLY4(V_LD(AUP_FFTW_LRE(x, e)), V_LD(AUP_FFTW_LIM(x, e)),
+                     V_LD(AUP_FFTW_LRE(x, e + sm)),
+                     V_LD(AUP_FFTW_LIM(x, e + sm)),
+                     V_LD(AUP_FFTW_LRE(x, e + 2 * sm)),
+                     V_LD(AUP_FFTW_LIM(x, e + 2 * sm)),
+                     V_LD(AUP_FFTW_LRE(x, e + 3 * sm)),
+                     V_LD(AUP_FFTW_LIM(x, e + 3 * sm)), w1r, w1i, w2r, w2i,
+                     w3r, w3i, y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i);
+      V_ST(AUP_FFTW_LRE(y, o), y0r);
+      V_ST(AUP_FFTW_LIM(y, o), y0i);
+      V_ST(AUP_FFTW_LRE(y, o + s), y1r);
+      V_ST(AUP_FFTW_LIM(y, o + s), y1i);
+      V_ST(AUP_FFTW_LRE(y, o + 2 * s), y2r);
+      V_ST(AUP_FFTW_LIM(y, o + 2 * s), y2i);
+      V_ST(AUP_FFTW_LRE(y, o + 3 * s), y3r);
+      V_ST(AUP_FFTW_LIM(y, o + 3 * s), y3i);
+    }
+  }
+}
+
+// AUP_FFTW_VW streams of r2c1024 at once, x[n * AUP_FFTW_VW + c] in place,
+// work holds 1024 * AUP_FFTW_VW floats; the even / odd samples already are
+// the real / imaginary parts of the SoA complex input
+static void AUP_FFTW_SFX(r2c1024Lanes)(float* x, float* work,
+                                       const AUP_FFTW_SimdTab* tab) {
+  const VT half = V_DUP(0.5f);
+  int k, q;
+
+  AUP_FFTW_SFX(stage4Lanes)(512, 1, x, work, tab->tw512);
+  AUP_FFTW_SFX(stage4Lanes)(128, 4, work, x, tab->tw128);
+  AUP_FFTW_SFX(stage4Lanes)(32, 16, x, work, tab->tw32);
+  AUP_FFTW_SFX(stage4Lanes)(8, 64, work, x, tab->tw8);
+  for (q = 0; q < 256; q++) {
+    VT ar = V_LD(AUP_FFTW_LRE(x, q)), ai = V_LD(AUP_FFTW_LIM(x, q));
+    VT br = V_LD(AUP_FFTW_LRE(x, q + 256)), bi = V_LD(AUP_FFTW_LIM(x, q + 256));
+    V_ST(AUP_FFTW_LRE(work, q), V_ADD(ar, br));
+    V_ST(AUP_FFTW_LIM(work, q), V_ADD(ai, bi));
+    V_ST(AUP_FFTW_LRE(work, q + 256), V_SUB(ar, br));
+    V_ST(AUP_FFTW_LIM(work, q + 256), V_SUB(ai, bi));
+  }
+
+  // split of r2c1024, Z[512] = Z[0]
+  for (k = 0; k < AUP_FFTW_SIMD_CPLXSZ; k++) {
+    const int mk = (AUP_FFTW_SIMD_CPLXSZ - k) & (AUP_FFTW_SIMD_CPLXSZ - 1);
+    VT zkr = V_LD(AUP_FFTW_LRE(work, k)), zki = V_LD(AUP_FFTW_LIM(work, k));
+    VT zmr = V_LD(AUP_FFTW_LRE(work, mk)), zmi = V_LD(AUP_FFTW_LIM(work, mk));
+    VT er = V_MUL(V_ADD(zkr, zmr), half);
+    VT ei = V_MUL(V_SUB(zki, zmi), half);
+    VT orr = V_MUL(V_ADD(zki, zmi), half);
+    VT oi = V_MUL(V_SUB(zmr, zkr), half);
+    VT wr = V_DUP(tab->postR[k]), wi = V_DUP(tab->postI[k]);
+    VT xr = V_ADD(er, V_SUB(V_MUL(orr, wr), V_MUL(oi, wi)));
+    VT xi = V_ADD(ei, V_ADD(V_MUL(orr, wi), V_MUL(oi, wr)));
+    V_ST(AUP_FFTW_LRE(x, k), xr);
+    V_ST(AUP_FFTW_LIM(x, k), V_SUB(V_DUP(0.0f), xi));
+  }
+  // Nyquist bin
+  V_ST(AUP_FFTW_LIM(x, 0), V_SUB(V_LD(AUP_FFTW_LRE(work, 0)),
+                                 V_LD(AUP_FFTW_LIM(work, 0))));
+}
+
+// unrolled over the lanes, so that the vectors of a transpose block and the
+// stream pointers stay in registers
+#if AUP_FFTW_VW == 4
+#define AUP_FFTW_EACH_LANE(op) op(0) op(1) op(2) op(3)
+#else
+#define AUP_FFTW_EACH_LANE(op) \
+  op(0) op(1) op(2) op(3) op(4) op(5) op(6) op(7)
+#endif
+
+// x[n * AUP_FFTW_VW + c] = in[c][n], n < len, c < AUP_FFTW_VW
+static void AUP_FFTW_SFX(interleaveLanes)(const float* const* in, int len,
+                                          float* x) {
+#define AUP_FFTW_PTR(c) ptr[c] = in[c];
+#define AUP_FFTW_LD(c) r[c] = V_LD(ptr[c] + n);
+#define AUP_FFTW_ST(c) V_ST(x + (n + c) * AUP_FFTW_VW, r[c]);
+  const float* ptr[AUP_FFTW_VW];
+  VT r[AUP_FFTW_VW];
+  int n, c;
+  AUP_FFTW_EACH_LANE(AUP_FFTW_PTR)
+  for (n = 0; n + AUP_FFTW_VW <= len; n += AUP_FFTW_VW) {
+    AUP_FFTW_EACH_LANE(AUP_FFTW_LD)
+    V_TR(r);
+    AUP_FFTW_EACH_LANE(AUP_FFTW_ST)
+  }
+  for (; n < len; n++) {
+    for (c = 0; c < AUP_FFTW_VW; c++) {
+      x[n * AUP_FFTW_VW + c] = ptr[c][n];
+    }
+  }
+#undef AUP_FFTW_PTR
+#undef AUP_FFTW_LD
+#undef AUP_FFTW_ST
+}
+
+// out[c][n] = x[n * AUP_FFTW_VW + c], the inverse of interleaveLanes
+static void AUP_FFTW_SFX(deinterleaveLanes)(const float* x, int len,
+                                            float* const* out) {
+#define AUP_FFTW_PTR(c) ptr[c] = out[c];
+#define AUP_FFTW_LD(c) r[c] = V_LD(x + (n + c) * AUP_FFTW_VW);
+#define AUP_FFTW_ST(c) V_ST(ptr[c] + n, r[c]);
+  float* ptr[AUP_FFTW_VW];
+  VT r[AUP_FFTW_VW];
+  int n, c;
+  AUP_FFTW_EACH_LANE(AUP_FFTW_PTR)
+  for (n = 0; n + AUP_FFTW_VW <= len; n += AUP_FFTW_VW) {
+    AUP_FFTW_EACH_LANE(AUP_FFTW_LD)
+    V_TR(r);
+    AUP_FFTW_EACH_LANE(AUP_FFTW_ST)
+  }
+  for (; n < len; n++) {
+    for (c = 0; c < AUP_FFTW_VW; c++) {
+      ptr[c][n] = x[n * AUP_FFTW_VW + c];
+    }
+  }
+#undef AUP_FFTW_PTR
+#undef AUP_FFTW_LD
+#undef AUP_FFTW_ST
+}
+#undef AUP_FFTW_EACH_LANE
+
+// binPower of AUP_FFTW_VW interleaved format1 spectra
+static void AUP_FFTW_SFX(binPowerLanes)(int fftSz, const float* in,
+                                        float* binPow) {
+  const int halfSz = fftSz >> 1;
+  int idx;
+  VT re, im;
+  for (idx = 1; idx < halfSz; idx++) {
+    re = V_LD(AUP_FFTW_LRE(in, idx));
+    im = V_LD(AUP_FFTW_LIM(in, idx));
+    V_ST(binPow + idx * AUP_FFTW_VW, V_ADD(V_MUL(re, re), V_MUL(im, im)));
+  }
+  re = V_LD(in);
+  im = V_LD(in + AUP_FFTW_VW);
+  V_ST(binPow, V_MUL(re, re));
+  V_ST(binPow + halfSz * AUP_FFTW_VW, V_MUL(im, im));
+}
+
+// AUP_FFTW_fastLog1 per lane
+static void AUP_FFTW_SFX(fastLog)(const float* in, int len, float* out) {
+  int idx, k;
+  for (idx = 0; idx + AUP_FFTW_VW <= len; idx += AUP_FFTW_VW) {
+    VT m, e, z, y;
+    V_LOGSPLIT(V_LD(in + idx), m, e);
+    m = V_SUB(m, V_DUP(1.0f));
+    z = V_MUL(m, m);
+    y = V_DUP(AUP_FFTW_LOG_POLY[0]);
+    for (k = 1; k < 9; k++) {
+      y = V_ADD(V_MUL(y, m), V_DUP(AUP_FFTW_LOG_POLY[k]));
+    }
+    y = V_MUL(V_MUL(y, m), z);
+    y = V_ADD(y, V_MUL(e, V_DUP(AUP_FFTW_LN2_LO)));
+    y = V_ADD(y, V_MUL(z, V_DUP(-0.5f)));
+    m = V_ADD(m, y);
+    V_ST(out + idx, V_ADD(m, V_MUL(e, V_DUP(AUP_FFTW_LN2_HI))));
+  }
+  for (; idx < len; idx++) {
+    out[idx] = AUP_FFTW_fastLog1(in[idx]);
+  }
+}
+
+// AUP_FFTW_fastExp1 per lane
+static void AUP_FFTW_SFX(fastExp)(const float* in, int len, float* out) {
+  const VT magic = V_DUP(AUP_FFTW_ROUND_MAGIC);
+  int idx, k;
+  for (idx = 0; idx + AUP_FFTW_VW <= len; idx += AUP_FFTW_VW) {
+    VT x, n, z, y;
+    x = V_MAX(V_LD(in + idx), V_DUP(AUP_FFTW_EXP_MIN));
+    x = V_MIN(x, V_DUP(AUP_FFTW_EXP_MAX));
+    n = V_SUB(V_ADD(V_MUL(x, V_DUP(AUP_FFTW_LOG2E)), magic), magic);
+    x = V_SUB(x, V_MUL(n, V_DUP(AUP_FFTW_LN2_HI)));
+    x = V_SUB(x, V_MUL(n, V_DUP(AUP_FFTW_LN2_LO)));
+    z = V_MUL(x, x);
+    y = V_DUP(AUP_FFTW_EXP_POLY[0]);
+    for (k = 1; k < 6; k++) {
+      y = V_ADD(V_MUL(y, x), V_DUP(AUP_FFTW_EXP_POLY[k]));
+    }
+    y = V_ADD(V_ADD(V_MUL(y, z), x), V_DUP(1.0f));
+    V_ST(out + idx, V_MUL(y, V_POW2N(n)));
+  }
+  for (; idx < len; idx++) {
+    out[idx] = AUP_FFTW_fastExp1(in[idx]);
+  }
+}
+
+#undef AUP_FFTW_LRE
+#undef AUP_FFTW_LIM
+#undef AUP_FFTW_BFLY4
@@ -62,6 +62,8 @@ static int AUP_Fscvrt_dynamMemPrepare(FscvrtSt* stHdl, void* memPtrExt,
   char* memPtr = NULL;
   int biquadInBufMemSize = 0;
   int biquadOutBufMemSize = 0;
+  int polyCoefMemSize = 0;
+  int polyInBufMemSize = 0;
   int totalMemSize = 0;
 
   if (stHdl == NULL) {
@@ -74,6 +76,13 @@ static int AUP_Fscvrt_dynamMemPrepare(FscvrtSt* stHdl, void* memPtrExt,
   biquadOutBufMemSize = _FSCVRT_ALIGN8(sizeof(float) * stHdl->biquadOutBufLen);
   totalMemSize += biquadOutBufMemSize;
 
+  polyCoefMemSize = _FSCVRT_ALIGN8(sizeof(float) * stHdl->upSmplRate *
+                                   stHdl->polyPhaseLen);
+  totalMemSize += polyCoefMemSize;
+
+  polyInBufMemSize = _FSCVRT_ALIGN8(sizeof(float) * stHdl->polyInBufLen);
+  totalMemSize += polyInBufMemSize;
+
   totalMemSize = _FSCVRT_MAX(totalMemSize, 80);
 
   // if no external memory provided, we are only profiling the memory
@@ -100,6 +109,15 @@ static int AUP_Fscvrt_dynamMemPrepare(FscvrtSt* stHdl, void* memPtrExt,
     memPtr += biquadOutBufMemSize;
   }
 
+  stHdl->polyCoef = NULL;
+  stHdl->polyInBuf = NULL;
+  if (stHdl->polyTapsLen != 0) {
+    stHdl->polyCoef = (float*)memPtr;
+    memPtr += polyCoefMemSize;
+    stHdl->polyInBuf = (float*)memPtr;
+    memPtr += polyInBufMemSize;
+  }
+
   if (((int)(memPtr - (char*)memPtrExt)) > totalMemSize) {
     return -1;
   }
@@ -112,13 +130,15 @@ static int AUP_Fscvrt_checkStatCfg(FscvrtStaticCfg* pCfg) {
     return -1;
   }
 
-  if (pCfg->inputFs != 16000 && pCfg->inputFs != 24000 &&
-      pCfg->inputFs != 32000 && pCfg->inputFs != 48000) {
+  if (pCfg->inputFs != 8000 && pCfg->inputFs != 16000 &&
+      pCfg->inputFs != 24000 && pCfg->inputFs != 32000 &&
+      pCfg->inputFs != 48000) {
     return -1;
   }
 
-  if (pCfg->outputFs != 16000 && pCfg->outputFs != 24000 &&
-      pCfg->outputFs != 32000 && pCfg->outputFs != 48000) {
+  if (pCfg->outputFs != 8000 && pCfg->outputFs != 16000 &&
+      pCfg->outputFs != 24000 && pCfg->outputFs != 32000 &&
+      pCfg->outputFs != 48000) {
     return -1;
   }
 
@@ -134,6 +154,11 @@ static int AUP_Fscvrt_checkStatCfg(FscvrtStaticCfg* pCfg) {
     pCfg->outputType = 1;
   }
 
+  if (pCfg->engine != AUP_FSCVRT_ENGINE_BIQUAD &&
+      pCfg->engine != AUP_FSCVRT_ENGINE_POLYPHASE) {
+    return -1;
+  }
+
   return 0;
 }
 
@@ -171,7 +196,20 @@ static int AUP_Fscvrt_publishStaticCfg(FscvrtSt* stHdl) {
     }
   }
 
-  if (stHdl->mode == 0) {
+  maxResmplRate = _FSCVRT_MAX(stHdl->upSmplRate, stHdl->downSmplRate);
+
+  stHdl->polyTapsLen = 0;
+  stHdl->polyPhaseLen = 0;
+  stHdl->polyInBufLen = 0;
+  if (stHdl->mode != 0 &&
+      stHdl->stCfg.engine == AUP_FSCVRT_ENGINE_POLYPHASE) {
+    stHdl->polyTapsLen = 2 * _FSCVRT_POLY_HALF_LEN * maxResmplRate + 1;
+    stHdl->polyPhaseLen =
+        (stHdl->polyTapsLen + stHdl->upSmplRate - 1) / stHdl->upSmplRate;
+    stHdl->polyInBufLen = stHdl->polyPhaseLen - 1 + stHdl->stCfg.stepSz;
+  }
+
+  if (stHdl->mode == 0 || stHdl->polyTapsLen != 0) {
     stHdl->biquadInBufLen = 0;
     stHdl->biquadOutBufLen = 0;
   } else {
@@ -179,14 +217,12 @@ static int AUP_Fscvrt_publishStaticCfg(FscvrtSt* stHdl) {
     stHdl->biquadOutBufLen = 2 * (stHdl->stCfg.stepSz * stHdl->upSmplRate);
   }
 
-  maxResmplRate = _FSCVRT_MAX(stHdl->upSmplRate, stHdl->downSmplRate);
-
   stHdl->nSec = 0;
   memset(stHdl->biquadB, 0, sizeof(stHdl->biquadB));
   memset(stHdl->biquadA, 0, sizeof(stHdl->biquadA));
   stHdl->biquadG = NULL;  // gain for each section
 
-  if (stHdl->mode != 0) {
+  if (stHdl->mode != 0 && stHdl->polyTapsLen == 0) {
     ret = AUP_Fscvrt_FilterSet(maxResmplRate, &(stHdl->nSec), stHdl->biquadB,
                                stHdl->biquadA, &(stHdl->biquadG));
     if (ret < 0) {
@@ -197,13 +233,188 @@ static int AUP_Fscvrt_publishStaticCfg(FscvrtSt* stHdl) {
   return 0;
 }
 
+// zeroth order modified Bessel function of the first kind
+static double AUP_Fscvrt_besselI0(double x) {
+  double sum = 1.0, term = 1.0;
+  int k;
+
+  for (k = 1; k < 50 && term > 1e-12 * sum; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+// build the polyphase branches from a Kaiser windowed sinc, normalized to
+// unit DC gain of each branch
+static void AUP_Fscvrt_polyDesign(FscvrtSt* stHdl) {
+  const int up = stHdl->upSmplRate;
+  const int tapsLen = stHdl->polyTapsLen;
+  const int phaseLen = stHdl->polyPhaseLen;
+  const double center = 0.5 * (tapsLen - 1);
+  const double fc = _FSCVRT_POLY_CUTOFF * 0.5 /
+                    _FSCVRT_MAX(stHdl->upSmplRate, stHdl->downSmplRate);
+  const double i0Beta = AUP_Fscvrt_besselI0(_FSCVRT_POLY_KAISER_BETA);
+  double t, r, tap, sum;
+  int idx, phase, m;
+
+  memset(stHdl->polyCoef, 0, sizeof(float) * up * phaseLen);
+  for (idx = 0; idx < tapsLen; idx++) {
+    t = idx - center;
+    r = t / center;
+    tap = (t == 0) ? 2.0 * fc : sin(2.0 * _FSCVRT_PI * fc * t) / (_FSCVRT_PI * t);
+    tap *= AUP_Fscvrt_besselI0(_FSCVRT_POLY_KAISER_BETA * sqrt(1.0 - r * r)) /
+           i0Beta;
+    phase = idx % up;
+    m = idx / up;
+    stHdl->polyCoef[phase * phaseLen + (phaseLen - 1 - m)] = (float)tap;
+  }
+
+  // unit DC gain of the whole prototype, i.e. gain up on each branch
+  sum = 0.0;
+  for (idx = 0; idx < up * phaseLen; idx++) {
+    sum += stHdl->polyCoef[idx];
+  }
+  for (idx = 0; idx < up * phaseLen; idx++) {
+    stHdl->polyCoef[idx] = (float)(stHdl->polyCoef[idx] * up / sum);
+  }
+}
+
+// polyphase FIR resampling of one step, only the kept outputs are computed
+static int AUP_Fscvrt_polyProc(FscvrtSt* stHdl, const FscvrtInData* pIn,
+                               FscvrtOutData* pOut) {
+  const FscvrtStaticCfg* pCfg = (const FscvrtStaticCfg*)&(stHdl->stCfg);
+  const int up = stHdl->upSmplRate;
+  const int down = stHdl->downSmplRate;
+  const int phaseLen = stHdl->polyPhaseLen;
+  const int endPos = pCfg->stepSz * up;
+  float* newInPtr = stHdl->polyInBuf + (phaseLen - 1);
+  const float* coefPtr;
+  const float* xPtr;
+  float acc0, acc1, acc2, acc3;
+  int nOutSamples = 0;
+  int pos, n, idx, tgtIdx;
+
+  if (stHdl->polyOutPos < endPos) {
+    nOutSamples = (endPos - stHdl->polyOutPos + down - 1) / down;
+  }
+  if (pIn->outDataSeqLen < nOutSamples) {
+    return -1;
+  }
+
+  if (pCfg->inputType == 0) {
+    for (idx = 0; idx < pCfg->stepSz; idx++) {
+      newInPtr[idx] = (float)(((const short*)pIn->inDataSeq)[idx]);
+    }
+  } else {
+    memcpy(newInPtr, pIn->inDataSeq, sizeof(float) * pCfg->stepSz);
+  }
+
+  for (pos = stHdl->polyOutPos, tgtIdx = 0; pos < endPos;
+       pos += down, tgtIdx++) {
+    n = pos / up;
+    coefPtr = stHdl->polyCoef + (pos - n * up) * phaseLen;
+    xPtr = stHdl->polyInBuf + n;
+    acc0 = acc1 = acc2 = acc3 = 0.0f;
+    for (idx = 0; idx + 4 <= phaseLen; idx += 4) {
+      acc0 += coefPtr[idx] * xPtr[idx];
+      acc1 += coefPtr[idx + 1] * xPtr[idx + 1];
+      acc2 += coefPtr[idx + 2] * xPtr[idx + 2];
+      acc3 += coefPtr[idx + 3] * xPtr[idx + 3];
+    }
+    for (; idx < phaseLen; idx++) {
+      acc0 += coefPtr[idx] * xPtr[idx];
+    }
+    acc0 += acc1 + acc2 + acc3;
+    if (pCfg->outputType == 0) {
+      ((short*)pOut->outDataSeq)[tgtIdx] = _FSCVRT_FLOAT2SHORT(acc0);
+    } else {
+      ((float*)pOut->outDataSeq)[tgtIdx] = acc0;
+    }
+  }
+  stHdl->polyOutPos = pos - endPos;
+
+  // keep the history for the next step
+  memmove(stHdl->polyInBuf, stHdl->polyInBuf + pCfg->stepSz,
+          sizeof(float) * (phaseLen - 1));
+
+  pOut->nOutData = nOutSamples;
+  pOut->outDataType = pCfg->outputType;
+
+  return 0;
+}
+
 static int AUP_Fscvrt_resetVariables(FscvrtSt* stHdl) {
   stHdl->biquadInBufCnt = 0;
   stHdl->biquadOutBufCnt = 0;
+  // same output grid as the biquad engine: every downSmplRate-th sample,
+  // starting at downSmplRate - 1
+  stHdl->polyOutPos = stHdl->downSmplRate - 1;
 
   if (stHdl->dynamMemPtr != NULL && stHdl->dynamMemSize > 0) {
     memset(stHdl->dynamMemPtr, 0, stHdl->dynamMemSize);
   }
+  if (stHdl->polyTapsLen != 0) {
+    AUP_Fscvrt_polyDesign(stHdl);
+  }
+  return 0;
+}
+
+static void AUP_Fscvrt_setDefaultCfg(FscvrtSt* stHdl) {
+  stHdl->stCfg.inputFs = 24000;
+  stHdl->stCfg.outputFs = 32000;
+  stHdl->stCfg.stepSz = 240;    // 10ms processing step
+  stHdl->stCfg.inputType = 0;   // short in
+  stHdl->stCfg.outputType = 0;  // short out
+  stHdl->stCfg.engine = AUP_FSCVRT_ENGINE_BIQUAD;
+}
+
+// static config of the anti-aliasing biquad, only used when nSec != 0
+static void AUP_Fscvrt_getBiquadCfg(const FscvrtSt* stHdl,
+                                    Biquad_StaticCfg* bqStatCfg) {
+  int idx;
+
+  memset(bqStatCfg, 0, sizeof(Biquad_StaticCfg));
+  bqStatCfg->maxNSample = (size_t)(stHdl->biquadInBufLen);
+  bqStatCfg->nsect = stHdl->nSec;
+  for (idx = 0; idx < stHdl->nSec; idx++) {
+    bqStatCfg->B[idx] = stHdl->biquadB[idx];
+    bqStatCfg->A[idx] = stHdl->biquadA[idx];
+  }
+  bqStatCfg->G = stHdl->biquadG;
+}
+
+// memory layout inside caller's memory: [FscvrtSt][dynamic memory][Biquad]
+// the biquad is left out (biquadMemSize = 0) in bypass mode
+static int AUP_Fscvrt_getMemLayout(const FscvrtStaticCfg* pCfg,
+                                   size_t* dynamMemSize,
+                                   size_t* biquadMemSize,
+                                   Biquad_StaticCfg* bqStatCfg) {
+  FscvrtSt tmpSt;
+  int totalMemSize;
+
+  memset(&tmpSt, 0, sizeof(FscvrtSt));
+  memcpy(&(tmpSt.stCfg), pCfg, sizeof(FscvrtStaticCfg));
+  if (AUP_Fscvrt_checkStatCfg(&(tmpSt.stCfg)) < 0 ||
+      AUP_Fscvrt_publishStaticCfg(&tmpSt) < 0) {
+    return -1;
+  }
+  if (tmpSt.nSec > AGORA_UAP_BIQUAD_MAX_SECTION) {
+    return -1;
+  }
+  totalMemSize = AUP_Fscvrt_dynamMemPrepare(&tmpSt, NULL, 0);
+  if (totalMemSize < 0) {
+    return -1;
+  }
+  (*biquadMemSize) = 0;
+  if (tmpSt.nSec != 0) {
+    AUP_Fscvrt_getBiquadCfg(&tmpSt, bqStatCfg);
+    if (AUP_Biquad_getMemSize(bqStatCfg, biquadMemSize) < 0) {
+      return -1;
+    }
+  }
+  (*dynamMemSize) = _FSCVRT_ALIGN8(totalMemSize);
+
   return 0;
 }
 
@@ -228,11 +439,7 @@ int AUP_Fscvrt_create(void** stPtr) {
   tmpPtr->dynamMemPtr = NULL;
   tmpPtr->dynamMemSize = 0;
 
-  tmpPtr->stCfg.inputFs = 24000;
-  tmpPtr->stCfg.outputFs = 32000;
-  tmpPtr->stCfg.stepSz = 240;    // 10ms processing step
-  tmpPtr->stCfg.inputType = 0;   // short in
-  tmpPtr->stCfg.outputType = 0;  // short out
+  AUP_Fscvrt_setDefaultCfg(tmpPtr);
 
   if (AUP_Biquad_create(&(tmpPtr->biquadSt)) < 0) {
     return -1;
@@ -241,6 +448,66 @@ int AUP_Fscvrt_create(void** stPtr) {
   return 0;
 }
 
+int AUP_Fscvrt_getMemSize(const FscvrtStaticCfg* pCfg, size_t* memSize) {
+  Biquad_StaticCfg bqStatCfg;
+  size_t dynamMemSize = 0;
+  size_t biquadMemSize = 0;
+
+  if (pCfg == NULL || memSize == NULL) {
+    return -1;
+  }
+  if (AUP_Fscvrt_getMemLayout(pCfg, &dynamMemSize, &biquadMemSize,
+                              &bqStatCfg) < 0) {
+    return -1;
+  }
+  (*memSize) = _FSCVRT_ALIGN8(sizeof(FscvrtSt)) + dynamMemSize + biquadMemSize;
+
+  return 0;
+}
+
+int AUP_Fscvrt_createIn(void** stPtr, void* mem, size_t memSize,
+                        const FscvrtStaticCfg* pCfg) {
+  FscvrtSt* tmpPtr;
+  Biquad_StaticCfg bqStatCfg;
+  size_t dynamMemSize = 0;
+  size_t biquadMemSize = 0;
+  char* memPtr;
+
+  if (stPtr == NULL || mem == NULL || pCfg == NULL || ((size_t)mem & 7) != 0) {
+    return -1;
+  }
+  if (AUP_Fscvrt_getMemLayout(pCfg, &dynamMemSize, &biquadMemSize,
+                              &bqStatCfg) < 0 ||
+      _FSCVRT_ALIGN8(sizeof(FscvrtSt)) + dynamMemSize + biquadMemSize >
+          memSize) {
+    return -1;
+  }
+
+  memPtr = (char*)mem;
+  tmpPtr = (FscvrtSt*)memPtr;
+  memset(tmpPtr, 0, sizeof(FscvrtSt));
+  memPtr += _FSCVRT_ALIGN8(sizeof(FscvrtSt));
+
+  tmpPtr->extMemFlag = 1;
+  tmpPtr->dynamMemPtr = memPtr;
+  tmpPtr->dynamMemSize = dynamMemSize;
+  memPtr += dynamMemSize;
+
+  tmpPtr->biquadSt = NULL;
+  if (biquadMemSize != 0) {
+    if (AUP_Biquad_createIn(&(tmpPtr->biquadSt), memPtr, biquadMemSize,
+                            &bqStatCfg) < 0) {
+      return -1;
+    }
+  }
+
+  AUP_Fscvrt_setDefaultCfg(tmpPtr);
+
+  (*stPtr) = (void*)tmpPtr;
+
+  return 0;
+}
+
 int AUP_Fscvrt_destroy(void** stPtr) {
   FscvrtSt* stHdl;
 
@@ -254,6 +521,11 @@ int AUP_Fscvrt_destroy(void** stPtr) {
   }
 
   AUP_Biquad_destroy(&(stHdl->biquadSt));
+  if (stHdl->extMemFlag) {  // memory is owned by the caller
+    (*stPtr) = NULL;
+    return 0;
+  }
+
   if (stHdl->dynamMemPtr != NULL) {
     free(stHdl->dynamMemPtr);
   }
@@ -269,7 +541,7 @@ int AUP_Fscvrt_memAllocate(void* stPtr, const FscvrtStaticCfg* pCfg) {
   FscvrtSt* stHdl = NULL;
   FscvrtStaticCfg tmpStatCfg = {0};
   Biquad_StaticCfg bqStatCfg;
-  int idx, ret;
+  int ret;
   int totalMemSize = 0;
 
   if (stPtr == NULL || pCfg == NULL) {
@@ -295,6 +567,9 @@ int AUP_Fscvrt_memAllocate(void* stPtr, const FscvrtStaticCfg* pCfg) {
 
   // allocate dynamic memory
   if ((size_t)totalMemSize > stHdl->dynamMemSize) {
+    if (stHdl->extMemFlag) {  // caller's memory can not grow
+      return -1;
+    }
     if (stHdl->dynamMemPtr != NULL) {
       free(stHdl->dynamMemPtr);
       stHdl->dynamMemSize = 0;
@@ -315,17 +590,11 @@ int AUP_Fscvrt_memAllocate(void* stPtr, const FscvrtStaticCfg* pCfg) {
 
   // memAllocation for upSmplBiquadSt and downSmplBiquadSt
   if (stHdl->nSec != 0) {
-    if (stHdl->nSec > AGORA_UAP_BIQUAD_MAX_SECTION) {
+    if (stHdl->nSec > AGORA_UAP_BIQUAD_MAX_SECTION ||
+        stHdl->biquadSt == NULL) {
       return -1;
     }
-    memset(&bqStatCfg, 0, sizeof(Biquad_StaticCfg));
-    bqStatCfg.maxNSample = (size_t)(stHdl->biquadInBufLen);
-    bqStatCfg.nsect = stHdl->nSec;
-    for (idx = 0; idx < stHdl->nSec; idx++) {
-      bqStatCfg.B[idx] = stHdl->biquadB[idx];
-      bqStatCfg.A[idx] = stHdl->biquadA[idx];
-    }
-    bqStatCfg.G = stHdl->biquadG;
+    AUP_Fscvrt_getBiquadCfg(stHdl, &bqStatCfg);
 
     ret = AUP_Biquad_memAllocate(stHdl->biquadSt, &bqStatCfg);
     if (ret < 0) {
@@ -359,6 +628,91 @@ int AUP_Fscvrt_init(void* stPtr) {
   return 0;
 }
 
+// copy sz bytes of var into buf + pos (save != 0) or back, return the next
+// position; buf == NULL only advances it
+static size_t AUP_Fscvrt_stateVar(char* buf, size_t pos, void* var, size_t sz,
+                                  int save) {
+  if (buf != NULL && sz > 0) {
+    if (save) {
+      memcpy(buf + pos, var, sz);
+    } else {
+      memcpy(var, buf + pos, sz);
+    }
+  }
+  return pos + sz;
+}
+
+// copy the signal state into buf (save != 0) or back from it, return its
+// size; buf == NULL only returns the size. The dynamic memory goes as a
+// whole, the polyphase taps in there come out the same for the same static
+// config
+static size_t AUP_Fscvrt_stateIo(FscvrtSt* stHdl, char* buf, int save) {
+  size_t pos = 0;
+  size_t bqSize = 0;
+
+  pos = AUP_Fscvrt_stateVar(buf, pos, stHdl->dynamMemPtr, stHdl->dynamMemSize,
+                            save);
+  pos = AUP_Fscvrt_stateVar(buf, pos, &(stHdl->biquadInBufCnt),
+                            sizeof(stHdl->biquadInBufCnt), save);
+  pos = AUP_Fscvrt_stateVar(buf, pos, &(stHdl->biquadOutBufCnt),
+                            sizeof(stHdl->biquadOutBufCnt), save);
+  pos = AUP_Fscvrt_stateVar(buf, pos, &(stHdl->polyOutPos),
+                            sizeof(stHdl->polyOutPos), save);
+
+  // the anti-aliasing / anti-imaging filter
+  if (stHdl->biquadSt != NULL && stHdl->nSec != 0) {
+    AUP_Biquad_getStateSize(stHdl->biquadSt, &bqSize);
+    if (buf != NULL) {
+      if (save) {
+        AUP_Biquad_saveState(stHdl->biquadSt, buf + pos, bqSize);
+      } else {
+        AUP_Biquad_loadState(stHdl->biquadSt, buf + pos, bqSize);
+      }
+    }
+    pos += bqSize;
+  }
+  return pos;
+}
+
+int AUP_Fscvrt_getStateSize(const void* stPtr, size_t* stateSize) {
+  if (stPtr == NULL || stateSize == NULL) {
+    return -1;
+  }
+  (*stateSize) = AUP_Fscvrt_stateIo((FscvrtSt*)stPtr, NULL, 1);
+
+  return 0;
+}
+
+int AUP_Fscvrt_saveState(const void* stPtr, void* buf, size_t bufSize) {
+  FscvrtSt* stHdl;
+
+  if (stPtr == NULL || buf == NULL) {
+    return -1;
+  }
+  stHdl = (FscvrtSt*)(stPtr);  // only read when saving
+  if (bufSize < AUP_Fscvrt_stateIo(stHdl, NULL, 1)) {
+    return -1;
+  }
+  AUP_Fscvrt_stateIo(stHdl, (char*)buf, 1);
+
+  return 0;
+}
+
+int AUP_Fscvrt_loadState(void* stPtr, const void* buf, size_t bufSize) {
+  FscvrtSt* stHdl;
+
+  if (stPtr == NULL || buf == NULL) {
+    return -1;
+  }
+  stHdl = (FscvrtSt*)(stPtr);
+  if (bufSize != AUP_Fscvrt_stateIo(stHdl, NULL, 0)) {
+    return -1;
+  }
+  AUP_Fscvrt_stateIo(stHdl, (char*)buf, 0);  // only read when loading
+
+  return 0;
+}
+
 int AUP_Fscvrt_getStaticCfg(const void* stPtr, FscvrtStaticCfg* pCfg) {
   const FscvrtSt* stHdl;
 
@@ -390,6 +744,9 @@ int AUP_Fscvrt_getInfor(const void* stPtr, FscvrtGetData* buff) {
 
   if (stHdl->mode == 0) {
     buff->delayInInputFs = 0;
+  } else if (stHdl->polyTapsLen != 0) {  // linear phase, half the prototype
+    buff->delayInInputFs =
+        (int)roundf((stHdl->polyTapsLen - 1) / (2.0f * stHdl->upSmplRate));
   } else if (stHdl->mode == 1) {
     buff->delayInInputFs =
         (int)roundf(delayBiquad / (float)(stHdl->upSmplRate));
@@ -465,6 +822,10 @@ int AUP_Fscvrt_proc(void* stPtr, const FscvrtInData* pIn, FscvrtOutData* pOut) {
     return 0;
   }
 
+  if (stHdl->polyTapsLen != 0) {
+    return AUP_Fscvrt_polyProc(stHdl, pIn, pOut);
+  }
+
   // prepare input buffer for Biquad .....
   memset(stHdl->biquadInBuf, 0, sizeof(float) * stHdl->biquadInBufLen);
   if (pCfg->inputType == 0) {
@@ -10,14 +10,21 @@
 #define AUP_FSCVRT_MAX_INPUT_LEN (2400)
 // max. number of samples each time can be fed in
 
+#define AUP_FSCVRT_ENGINE_BIQUAD (0)
+// zero-stuffing by upSmplRate, cascaded biquad IIR over the inflated signal,
+// then keeping every downSmplRate-th output
+#define AUP_FSCVRT_ENGINE_POLYPHASE (1)
+// linear-phase polyphase FIR, only the kept output samples are computed
+
 #include <stdio.h>
 
 typedef struct FscvrtStaticCfg_ {
-  int inputFs;     // input stream sampling freq.
-  int outputFs;    // output stream sampling freq.
+  int inputFs;     // input stream sampling freq., 8/16/24/32/48 kHz
+  int outputFs;    // output stream sampling freq., 8/16/24/32/48 kHz
   int stepSz;      // number of input samples per each proc.
   int inputType;   // input data type, 0: short, 1: float
   int outputType;  // output data type, 0: short, 1: float
+  int engine;      // resampler, AUP_FSCVRT_ENGINE_BIQUAD / _POLYPHASE
 } FscvrtStaticCfg;
 
 typedef struct FscvrtInData_ {
@@ -60,6 +67,47 @@ extern "C" {
  */
 int AUP_Fscvrt_create(void** stPtr);
 
+/****************************************************************************
+ * AUP_Fscvrt_getMemSize(...)
+ *
+ * This function returns the memory required by _createIn for a handler
+ * configured with pCfg, covering the state handler, its dynamic memory and
+ * the anti-aliasing biquad submodule
+ *
+ * Input:
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - memSize       : required memory size in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Fscvrt_getMemSize(const FscvrtStaticCfg* pCfg, size_t* memSize);
+
+/****************************************************************************
+ * AUP_Fscvrt_createIn(...)
+ *
+ * This function creats a state handler inside caller provided memory, no
+ * memory is allocated by this handler afterwards. _memAllocate has to be
+ * called with the same pCfg (or one requiring less memory); _destroy won't
+ * release mem
+ *
+ * Input:
+ *      - mem           : caller's memory, 8-byte aligned, which has to
+ *                        outlive the handler
+ *      - memSize       : size of mem, at least what _getMemSize returns
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - stPtr         : buffer to store the returned state handler
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Fscvrt_createIn(void** stPtr, void* mem, size_t memSize,
+                        const FscvrtStaticCfg* pCfg);
+
 /****************************************************************************
  * AUP_Fscvrt_destroy(...)
  *
@@ -110,6 +158,63 @@ int AUP_Fscvrt_memAllocate(void* stPtr, const FscvrtStaticCfg* pCfg);
  */
 int AUP_Fscvrt_init(void* stPtr);
 
+/****************************************************************************
+ * AUP_Fscvrt_getStateSize(...)
+ *
+ * This function returns the size of the signal state written by _saveState,
+ * the dynamic memory and the step counters of the
+ * resampler together with its anti-aliasing biquad; it only depends on the static config
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *
+ * Output:
+ *      - stateSize     : size of the state in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Fscvrt_getStateSize(const void* stPtr, size_t* stateSize);
+
+/****************************************************************************
+ * AUP_Fscvrt_saveState(...)
+ *
+ * This function copies the signal state of the handler into buf
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate and init
+ *      - bufSize       : size of buf, at least what _getStateSize returns
+ *
+ * Output:
+ *      - buf           : the state, _getStateSize bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Fscvrt_saveState(const void* stPtr, void* buf, size_t bufSize);
+
+/****************************************************************************
+ * AUP_Fscvrt_loadState(...)
+ *
+ * This function replaces the signal state of the handler with one written by
+ * _saveState of a handler with the same static config; the filter design of
+ * the handler is kept
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *      - buf           : the state
+ *      - bufSize       : size of buf, has to equal what _getStateSize returns
+ *
+ * Output:
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Fscvrt_loadState(void* stPtr, const void* buf, size_t bufSize);
+
 /****************************************************************************
  * AUP_Fscvrt_setDynamCfg(...)
  *
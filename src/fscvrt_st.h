@@ -19,6 +19,14 @@
 #define _FSCVRT_MIN(x, y) ((x > y) ? (y) : (x))
 #define _FSCVRT_MAX(x, y) ((x > y) ? (x) : (y))
 
+// polyphase FIR prototype, a Kaiser windowed sinc running @ inputFs * up
+#define _FSCVRT_POLY_HALF_LEN (24)
+// half length in samples @ the lower of inputFs and outputFs
+#define _FSCVRT_POLY_CUTOFF (1.0f)
+// cutoff, relative to the Nyquist freq. of the lower of inputFs and outputFs
+#define _FSCVRT_POLY_KAISER_BETA (8.0f)  // ~80dB stop-band attenuation
+#define _FSCVRT_PI (3.14159265358979323846)
+
 #define _FSCVRT_1over2_LOWPASS_NSEC (5)
 static const float _FSCVRT_1over2_LOWPASS_B[_FSCVRT_1over2_LOWPASS_NSEC][3] = {
     {1.000000e+00f, 1.830863e+00f, 1.000000e+00f},
@@ -93,6 +101,7 @@ static const float _FSCVRT_1over6_LOWPASS_G[_FSCVRT_1over6_LOWPASS_NSEC] = {
 typedef struct FscvrtSt_ {
   void* dynamMemPtr;    // memory pointer holding the dynamic memory
   size_t dynamMemSize;  // size of the buffer *dynamMemPtr
+  int extMemFlag;  // 1: handler and dynamic memory live in caller's memory
 
   // Static Configuration
   FscvrtStaticCfg stCfg;
@@ -111,6 +120,10 @@ typedef struct FscvrtSt_ {
   const float* biquadA[_FSCVRT_MAXNSEC];
   const float* biquadG;  // gain for each section
 
+  int polyTapsLen;   // prototype length, 0: polyphase engine not in use
+  int polyPhaseLen;  // taps of each of the upSmplRate branches
+  int polyInBufLen;  // polyPhaseLen - 1 + stepSz
+
   // ---------------------------------------------------------------
   // Variables
   void* biquadSt;  // biqua filter state handler
@@ -118,6 +131,13 @@ typedef struct FscvrtSt_ {
   float* biquadInBuf;  // [biquadInBufLen]
   int biquadOutBufCnt;
   float* biquadOutBuf;  // [biquadOutBufLen]
+  float* polyCoef;      // [upSmplRate][polyPhaseLen], branch p holds the
+                        // prototype taps p, p + up, ... time-reversed and
+                        // scaled by up
+  float* polyInBuf;     // [polyInBufLen], last polyPhaseLen - 1 input
+                        // samples followed by the current step
+  int polyOutPos;  // position of the next output @ inputFs * up, relative to
+                   // the first sample of the current step
 } FscvrtSt;
 
 #endif  // __FSCVRT_ST_H__
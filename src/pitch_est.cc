@@ -106,6 +106,9 @@ static int AUP_PE_checkStatCfg(PE_StaticCfg* pCfg) {
   if (pCfg->useLPCPreFiltering != 0) {
     pCfg->useLPCPreFiltering = 1;
   }
+  if (pCfg->fastMath != 0) {
+    pCfg->fastMath = 1;
+  }
 
   if (pCfg->procFs != 2000 && pCfg->procFs != 4000 && pCfg->procFs != 8000 &&
       pCfg->procFs != 16000) {
@@ -125,9 +128,28 @@ static int AUP_PE_checkDynamCfg(PE_DynamCfg* pCfg) {
   return 0;
 }
 
+static int AUP_PE_buildDctTable(float* dctTable) {
+  int idx, jdx;
+  for (idx = 0; idx < AUP_PE_NB_BANDS; idx++) {
+    for (jdx = 0; jdx < AUP_PE_NB_BANDS; jdx++) {
+      dctTable[idx * AUP_PE_NB_BANDS + jdx] =
+          cosf((idx + .5f) * jdx * AUP_PE_PI / AUP_PE_NB_BANDS);
+      if (jdx == 0) dctTable[idx * AUP_PE_NB_BANDS + jdx] *= sqrtf(.5f);
+    }
+  }
+  return 0;
+}
+
+// the DCT table is constant, build it once and share it among all handlers
+static const float* AUP_PE_getDctTable() {
+  static float dctTable[AUP_PE_NB_BANDS * AUP_PE_NB_BANDS];
+  static const int dctTableRet = AUP_PE_buildDctTable(dctTable);
+  (void)dctTableRet;
+  return dctTable;
+}
+
 static int AUP_PE_publishStaticCfg(PE_St* stHdl) {
   const PE_StaticCfg* pStatCfg;
-  int idx, jdx;
   int hopSz;
   int excBufShiftLen;
 
@@ -154,13 +176,7 @@ static int AUP_PE_publishStaticCfg(PE_St* stHdl) {
   stHdl->estDelay = 0;
 
   // publish DCT-table coeff.
-  for (idx = 0; idx < AUP_PE_NB_BANDS; idx++) {
-    for (jdx = 0; jdx < AUP_PE_NB_BANDS; jdx++) {
-      stHdl->dct_table[idx * AUP_PE_NB_BANDS + jdx] =
-          cosf((idx + .5f) * jdx * AUP_PE_PI / AUP_PE_NB_BANDS);
-      if (jdx == 0) stHdl->dct_table[idx * AUP_PE_NB_BANDS + jdx] *= sqrtf(.5f);
-    }
-  }
+  stHdl->dct_table = AUP_PE_getDctTable();
 
   return 0;
 }
@@ -173,9 +189,11 @@ static int AUP_PE_resetVariables(PE_St* stHdl) {
 
   stHdl->inputResampleBufIdx = 0;
 
+  stHdl->inputQIdx = 0;
+  stHdl->excBufIdx = 0;
+
   for (idx = 0; idx < AUP_PE_LPC_ORDER; idx++) {
     stHdl->lpc[idx] = 0;
-    stHdl->pitch_mem[idx] = 0;
   }
   stHdl->pitch_filt = 0;
 
@@ -202,6 +220,27 @@ static int AUP_PE_resetVariables(PE_St* stHdl) {
   return 0;
 }
 
+// append n samples to the mirrored excBuf / excBufSq, n <= excBufLen
+static void AUP_PE_pushExcBuf(PE_St* stHdl, const float* src, int n) {
+  const int excBufLen = stHdl->excBufLen;
+  int bufIdx = stHdl->excBufIdx;
+  float val;
+  int idx;
+
+  for (idx = 0; idx < n; idx++) {
+    val = src[idx];
+    stHdl->excBuf[bufIdx] = val;
+    stHdl->excBuf[bufIdx + excBufLen] = val;
+    stHdl->excBufSq[bufIdx] = val * val;
+    stHdl->excBufSq[bufIdx + excBufLen] = val * val;
+    bufIdx++;
+    if (bufIdx == excBufLen) {
+      bufIdx = 0;
+    }
+  }
+  stHdl->excBufIdx = bufIdx;
+}
+
 static int AUP_PE_dynamMemPrepare(PE_St* stHdl, void* memPtrExt,
                                   size_t memSize) {
   int idx;
@@ -227,13 +266,14 @@ static int AUP_PE_dynamMemPrepare(PE_St* stHdl, void* memPtrExt,
   inputQMemSize = AUP_PE_ALIGN8(sizeof(float) * stHdl->inputQLen);
   totalMemSize += inputQMemSize;
 
-  alignedInMemSize = AUP_PE_ALIGN8(sizeof(float) * stHdl->stCfg.hopSz);
+  alignedInMemSize =
+      AUP_PE_ALIGN8(sizeof(float) * (AUP_PE_LPC_ORDER + stHdl->stCfg.hopSz));
   totalMemSize += alignedInMemSize;
 
   lpcFilterOutBufMemSize = AUP_PE_ALIGN8(sizeof(float) * stHdl->stCfg.hopSz);
   totalMemSize += lpcFilterOutBufMemSize;
 
-  excBufMemSize = AUP_PE_ALIGN8(sizeof(float) * stHdl->excBufLen);
+  excBufMemSize = AUP_PE_ALIGN8(sizeof(float) * stHdl->excBufLen * 2);
   totalMemSize += excBufMemSize;
   excBufSqMemSize = excBufMemSize;
   totalMemSize += excBufSqMemSize;
@@ -513,7 +553,7 @@ static float AUP_PE_lpc_from_bands(const int windowSz, const int nBins,
 static float AUP_PE_lpcCompute(
     const int windowSz, const int nBins,
     const float DctTable[AUP_PE_NB_BANDS * AUP_PE_NB_BANDS],
-    const float* cepstrum, float* lpc) {
+    const float* cepstrum, int fastMath, float* lpc) {
   int i;
   float Ex[AUP_PE_NB_BANDS] = {0};
   float tmp[AUP_PE_NB_BANDS] = {0};
@@ -523,8 +563,18 @@ static float AUP_PE_lpcCompute(
   memcpy(tmp, cepstrum, sizeof(float) * AUP_PE_NB_BANDS);
 
   AUP_PE_idct(DctTable, tmp, Ex);  // idct(Ex, tmp);
+  if (fastMath) {  // 10^x = e^(x * ln10)
+    for (i = 0; i < AUP_PE_NB_BANDS; i++) {
+      Ex[i] *= AUP_PE_LN10;
+    }
+    AUP_FFTW_fastExp(Ex, AUP_PE_NB_BANDS, Ex);
+  } else {
+    for (i = 0; i < AUP_PE_NB_BANDS; i++) {
+      Ex[i] = powf(10.f, Ex[i]);
+    }
+  }
   for (i = 0; i < AUP_PE_NB_BANDS; i++) {
-    Ex[i] = powf(10.f, Ex[i]) * AUP_PE_BAND_LPC_COMP[i];
+    Ex[i] *= AUP_PE_BAND_LPC_COMP[i];
   }
 
   errValue = AUP_PE_lpc_from_bands(windowSz, nBins, Ex, lpc);
@@ -532,99 +582,75 @@ static float AUP_PE_lpcCompute(
   return (errValue);
 }
 
-static void AUP_PE_xcorr_kernel(const float* x, const float* y, float sum[4],
-                                int len) {
-  int j;
-  float y_0, y_1, y_2, y_3;
-  y_3 = 0; /* gcc doesn't realize that y_3 can't be used uninitialized */
-  y_0 = *y++;
-  y_1 = *y++;
-  y_2 = *y++;
-  for (j = 0; j < len - 3; j += 4) {
-    float tmp;
-    tmp = *x++;
-    y_3 = *y++;
-    sum[0] += tmp * y_0;
-    sum[1] += tmp * y_1;
-    sum[2] += tmp * y_2;
-    sum[3] += tmp * y_3;
-    tmp = *x++;
-    y_0 = *y++;
-    sum[0] += tmp * y_1;
-    sum[1] += tmp * y_2;
-    sum[2] += tmp * y_3;
-    sum[3] += tmp * y_0;
-    tmp = *x++;
-    y_1 = *y++;
-    sum[0] += tmp * y_2;
-    sum[1] += tmp * y_3;
-    sum[2] += tmp * y_0;
-    sum[3] += tmp * y_1;
-    tmp = *x++;
-    y_2 = *y++;
-    sum[0] += tmp * y_3;
-    sum[1] += tmp * y_0;
-    sum[2] += tmp * y_1;
-    sum[3] += tmp * y_2;
-  }
-  if (j++ < len) {
-    float tmp = *x++;
-    y_3 = *y++;
-    sum[0] += tmp * y_0;
-    sum[1] += tmp * y_1;
-    sum[2] += tmp * y_2;
-    sum[3] += tmp * y_3;
-  }
-  if (j++ < len) {
-    float tmp = *x++;
-    y_0 = *y++;
-    sum[0] += tmp * y_1;
-    sum[1] += tmp * y_2;
-    sum[2] += tmp * y_3;
-    sum[3] += tmp * y_0;
-  }
-  if (j < len) {
-    float tmp = *x++;
-    y_1 = *y++;
-    sum[0] += tmp * y_2;
-    sum[1] += tmp * y_3;
-    sum[2] += tmp * y_0;
-    sum[3] += tmp * y_1;
-  }
-  return;
+static void AUP_PE_setDefaultCfg(PE_St* stHdl) {
+  stHdl->stCfg.fftSz = 1024;
+  stHdl->stCfg.anaWindowSz = 768;
+  stHdl->stCfg.hopSz = 256;
+  stHdl->stCfg.useLPCPreFiltering = 1;
+  stHdl->stCfg.fastMath = 0;
+  stHdl->stCfg.procFs = 4000;  // 4KHz resampling rate
+
+  stHdl->dynamCfg.voicedThr = 0.4f;
 }
 
-static float AUP_PE_celt_inner_prod(const float* x, const float* y, int N) {
-  int i;
-  float xy = 0;
-  for (i = 0; i < N; i++) {
-    xy += (x[i] * y[i]);
-  }
+// static config of the anti-aliasing low-pass filter, derived from the
+// published static config registers
+static void AUP_PE_getBiquadCfg(const PE_St* stHdl,
+                                Biquad_StaticCfg* biquadStCfg) {
+  int idx;
 
-  return (xy);
+  memset(biquadStCfg, 0, sizeof(Biquad_StaticCfg));
+  biquadStCfg->maxNSample = stHdl->stCfg.hopSz;
+  if (stHdl->procResampleRate != 1) {
+    biquadStCfg->nsect = AUP_PE_LOWPSS_NSEC;
+    if (stHdl->stCfg.procFs == 2000) {
+      biquadStCfg->G = AUP_PE_G_2KHZ;
+      for (idx = 0; idx < biquadStCfg->nsect; idx++) {
+        biquadStCfg->B[idx] = AUP_PE_B_2KHZ[idx];
+        biquadStCfg->A[idx] = AUP_PE_A_2KHZ[idx];
+      }
+    } else if (stHdl->stCfg.procFs == 4000) {
+      biquadStCfg->G = AUP_PE_G_4KHZ;
+      for (idx = 0; idx < biquadStCfg->nsect; idx++) {
+        biquadStCfg->B[idx] = AUP_PE_B_4KHZ[idx];
+        biquadStCfg->A[idx] = AUP_PE_A_4KHZ[idx];
+      }
+    } else if (stHdl->stCfg.procFs == 8000) {
+      biquadStCfg->G = AUP_PE_G_8KHZ;
+      for (idx = 0; idx < biquadStCfg->nsect; idx++) {
+        biquadStCfg->B[idx] = AUP_PE_B_8KHZ[idx];
+        biquadStCfg->A[idx] = AUP_PE_A_8KHZ[idx];
+      }
+    }
+  } else {
+    biquadStCfg->nsect = -1;
+  }
 }
 
-static void AUP_PE_MvingXCorr(int corrWindowLen, int corrShiftTimes,
-                              const float* refIn, const float* yInToShift,
-                              float* xcorr) {
-  /* Unrolled version of the pitch correlation -- runs faster on x86 and ARM */
-  int i;
-  float tmp;
-
-  for (i = 0; i < corrShiftTimes - 3; i += 4) {
-    float sum[4] = {0, 0, 0, 0};
-    AUP_PE_xcorr_kernel(refIn, yInToShift + i, sum, corrWindowLen);
-    xcorr[i] = sum[0];
-    xcorr[i + 1] = sum[1];
-    xcorr[i + 2] = sum[2];
-    xcorr[i + 3] = sum[3];
+// memory layout inside caller's memory: [PE_St][dynamic memory][Biquad]
+static int AUP_PE_getMemLayout(const PE_StaticCfg* pCfg, size_t* dynamMemSize,
+                               size_t* biquadMemSize,
+                               Biquad_StaticCfg* biquadStCfg) {
+  PE_St tmpSt;
+  int totalMemSize;
+
+  memset(&tmpSt, 0, sizeof(PE_St));
+  memcpy(&(tmpSt.stCfg), pCfg, sizeof(PE_StaticCfg));
+  if (AUP_PE_checkStatCfg(&(tmpSt.stCfg)) < 0 ||
+      AUP_PE_publishStaticCfg(&tmpSt) < 0) {
+    return -1;
   }
-  /* In case corrShiftTimes isn't a multiple of 4, do non-unrolled version. */
-  for (; i < corrShiftTimes; i++) {
-    tmp = AUP_PE_celt_inner_prod(refIn, yInToShift + i, corrWindowLen);
-    xcorr[i] = tmp;
+  totalMemSize = AUP_PE_dynamMemPrepare(&tmpSt, NULL, 0);
+  if (totalMemSize < 0) {
+    return -1;
   }
-  return;
+  AUP_PE_getBiquadCfg(&tmpSt, biquadStCfg);
+  if (AUP_Biquad_getMemSize(biquadStCfg, biquadMemSize) < 0) {
+    return -1;
+  }
+  (*dynamMemSize) = AUP_PE_ALIGN8(totalMemSize);
+
+  return 0;
 }
 
 // ==========================================================================================
@@ -654,13 +680,63 @@ int AUP_PE_create(void** stPtr) {
     return -1;
   }
 
-  tmpPtr->stCfg.fftSz = 1024;
-  tmpPtr->stCfg.anaWindowSz = 768;
-  tmpPtr->stCfg.hopSz = 256;
-  tmpPtr->stCfg.useLPCPreFiltering = 1;
-  tmpPtr->stCfg.procFs = 4000;  // 4KHz resampling rate
+  AUP_PE_setDefaultCfg(tmpPtr);
+
+  return 0;
+}
+
+int AUP_PE_getMemSize(const PE_StaticCfg* pCfg, size_t* memSize) {
+  Biquad_StaticCfg biquadStCfg;
+  size_t dynamMemSize = 0;
+  size_t biquadMemSize = 0;
+
+  if (pCfg == NULL || memSize == NULL) {
+    return -1;
+  }
+  if (AUP_PE_getMemLayout(pCfg, &dynamMemSize, &biquadMemSize, &biquadStCfg) <
+      0) {
+    return -1;
+  }
+  (*memSize) = AUP_PE_ALIGN8(sizeof(PE_St)) + dynamMemSize + biquadMemSize;
+
+  return 0;
+}
+
+int AUP_PE_createIn(void** stPtr, void* mem, size_t memSize,
+                    const PE_StaticCfg* pCfg) {
+  PE_St* tmpPtr;
+  Biquad_StaticCfg biquadStCfg;
+  size_t dynamMemSize = 0;
+  size_t biquadMemSize = 0;
+  char* memPtr;
+
+  if (stPtr == NULL || mem == NULL || pCfg == NULL || ((size_t)mem & 7) != 0) {
+    return -1;
+  }
+  if (AUP_PE_getMemLayout(pCfg, &dynamMemSize, &biquadMemSize, &biquadStCfg) <
+          0 ||
+      AUP_PE_ALIGN8(sizeof(PE_St)) + dynamMemSize + biquadMemSize > memSize) {
+    return -1;
+  }
+
+  memPtr = (char*)mem;
+  tmpPtr = (PE_St*)memPtr;
+  memset(tmpPtr, 0, sizeof(PE_St));
+  memPtr += AUP_PE_ALIGN8(sizeof(PE_St));
 
-  tmpPtr->dynamCfg.voicedThr = 0.4f;
+  tmpPtr->extMemFlag = 1;
+  tmpPtr->dynamMemPtr = memPtr;
+  tmpPtr->dynamMemSize = dynamMemSize;
+  memPtr += dynamMemSize;
+
+  if (AUP_Biquad_createIn(&(tmpPtr->biquadIIRPtr), memPtr, biquadMemSize,
+                          &biquadStCfg) < 0) {
+    return -1;
+  }
+
+  AUP_PE_setDefaultCfg(tmpPtr);
+
+  (*stPtr) = (void*)tmpPtr;
 
   return 0;
 }
@@ -677,6 +753,12 @@ int AUP_PE_destroy(void** stPtr) {
     return 0;
   }
 
+  if (stHdl->extMemFlag) {  // memory is owned by the caller
+    AUP_Biquad_destroy(&(stHdl->biquadIIRPtr));
+    (*stPtr) = NULL;
+    return 0;
+  }
+
   if (stHdl->dynamMemPtr != NULL) {
     free(stHdl->dynamMemPtr);
   }
@@ -696,7 +778,6 @@ int AUP_PE_memAllocate(void* stPtr, const PE_StaticCfg* pCfg) {
   PE_St* stHdl = NULL;
   PE_StaticCfg localStCfg;
   Biquad_StaticCfg biquadStCfg = {0, 0, {0}, {0}, 0};
-  int idx;
   int totalMemSize = 0;
 
   if (stPtr == NULL || pCfg == NULL) {
@@ -724,6 +805,9 @@ int AUP_PE_memAllocate(void* stPtr, const PE_StaticCfg* pCfg) {
 
   // allocate dynamic memory
   if ((size_t)totalMemSize > stHdl->dynamMemSize) {
+    if (stHdl->extMemFlag) {  // caller's memory can not grow
+      return -1;
+    }
     if (stHdl->dynamMemPtr != NULL) {
       free(stHdl->dynamMemPtr);
       stHdl->dynamMemSize = 0;
@@ -742,52 +826,119 @@ int AUP_PE_memAllocate(void* stPtr, const PE_StaticCfg* pCfg) {
     return -1;
   }
 
-  if (AUP_Biquad_getStaticCfg(stHdl->biquadIIRPtr, &biquadStCfg) < 0) {
+  AUP_PE_getBiquadCfg(stHdl, &biquadStCfg);
+  if (AUP_Biquad_memAllocate(stHdl->biquadIIRPtr, &biquadStCfg) < 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+int AUP_PE_init(void* stPtr) {
+  PE_St* stHdl;
+
+  if (stPtr == NULL) {
+    return -1;
+  }
+  stHdl = (PE_St*)(stPtr);
+
+  if (AUP_PE_resetVariables(stHdl) < 0) {
     return -1;
   }
-  biquadStCfg.maxNSample = stHdl->stCfg.hopSz;
+
+  return 0;
+}
+
+// copy sz bytes of var into buf + pos (save != 0) or back, return the next
+// position; buf == NULL only advances it
+static size_t AUP_PE_stateVar(char* buf, size_t pos, void* var, size_t sz,
+                              int save) {
+  if (buf != NULL && sz > 0) {
+    if (save) {
+      memcpy(buf + pos, var, sz);
+    } else {
+      memcpy(var, buf + pos, sz);
+    }
+  }
+  return pos + sz;
+}
+
+// copy the signal state into buf (save != 0) or back from it, return its
+// size; buf == NULL only returns the size. The dynamic memory goes as a
+// whole, all buffers in there keep their offsets for the same static config
+static size_t AUP_PE_stateIo(PE_St* stHdl, char* buf, int save) {
+  size_t pos = 0;
+  size_t bqSize = 0;
+
+#define AUP_PE_STATE_VAR(v) \
+  pos = AUP_PE_stateVar(buf, pos, &(v), sizeof(v), save)
+  pos = AUP_PE_stateVar(buf, pos, stHdl->dynamMemPtr, stHdl->dynamMemSize,
+                        save);
+  AUP_PE_STATE_VAR(stHdl->inputResampleBufIdx);
+  AUP_PE_STATE_VAR(stHdl->inputQIdx);
+  AUP_PE_STATE_VAR(stHdl->excBufIdx);
+  AUP_PE_STATE_VAR(stHdl->lpc);
+  AUP_PE_STATE_VAR(stHdl->pitch_filt);
+  AUP_PE_STATE_VAR(stHdl->tmpFeat);
+  AUP_PE_STATE_VAR(stHdl->xCorrOffsetIdx);
+  AUP_PE_STATE_VAR(stHdl->frmWeight);
+  AUP_PE_STATE_VAR(stHdl->frmWeightNorm);
+  AUP_PE_STATE_VAR(stHdl->pitchMaxPathAll);
+  AUP_PE_STATE_VAR(stHdl->bestPeriodEst);
+  AUP_PE_STATE_VAR(stHdl->voiced);
+  AUP_PE_STATE_VAR(stHdl->pitchEstResult);
+#undef AUP_PE_STATE_VAR
+
+  // the low-pass filter in front of the decimation
   if (stHdl->procResampleRate != 1) {
-    biquadStCfg.nsect = AUP_PE_LOWPSS_NSEC;
-    if (stHdl->stCfg.procFs == 2000) {
-      biquadStCfg.G = AUP_PE_G_2KHZ;
-      for (idx = 0; idx < biquadStCfg.nsect; idx++) {
-        biquadStCfg.B[idx] = AUP_PE_B_2KHZ[idx];
-        biquadStCfg.A[idx] = AUP_PE_A_2KHZ[idx];
-      }
-    } else if (stHdl->stCfg.procFs == 4000) {
-      biquadStCfg.G = AUP_PE_G_4KHZ;
-      for (idx = 0; idx < biquadStCfg.nsect; idx++) {
-        biquadStCfg.B[idx] = AUP_PE_B_4KHZ[idx];
-        biquadStCfg.A[idx] = AUP_PE_A_4KHZ[idx];
-      }
-    } else if (stHdl->stCfg.procFs == 8000) {
-      biquadStCfg.G = AUP_PE_G_8KHZ;
-      for (idx = 0; idx < biquadStCfg.nsect; idx++) {
-        biquadStCfg.B[idx] = AUP_PE_B_8KHZ[idx];
-        biquadStCfg.A[idx] = AUP_PE_A_8KHZ[idx];
+    AUP_Biquad_getStateSize(stHdl->biquadIIRPtr, &bqSize);
+    if (buf != NULL) {
+      if (save) {
+        AUP_Biquad_saveState(stHdl->biquadIIRPtr, buf + pos, bqSize);
+      } else {
+        AUP_Biquad_loadState(stHdl->biquadIIRPtr, buf + pos, bqSize);
       }
     }
-  } else {
-    biquadStCfg.nsect = -1;
+    pos += bqSize;
   }
-  if (AUP_Biquad_memAllocate(stHdl->biquadIIRPtr, &biquadStCfg) < 0) {
+  return pos;
+}
+
+int AUP_PE_getStateSize(const void* stPtr, size_t* stateSize) {
+  if (stPtr == NULL || stateSize == NULL) {
     return -1;
   }
+  (*stateSize) = AUP_PE_stateIo((PE_St*)stPtr, NULL, 1);
 
   return 0;
 }
 
-int AUP_PE_init(void* stPtr) {
+int AUP_PE_saveState(const void* stPtr, void* buf, size_t bufSize) {
   PE_St* stHdl;
 
-  if (stPtr == NULL) {
+  if (stPtr == NULL || buf == NULL) {
     return -1;
   }
-  stHdl = (PE_St*)(stPtr);
+  stHdl = (PE_St*)(stPtr);  // only read when saving
+  if (bufSize < AUP_PE_stateIo(stHdl, NULL, 1)) {
+    return -1;
+  }
+  AUP_PE_stateIo(stHdl, (char*)buf, 1);
 
-  if (AUP_PE_resetVariables(stHdl) < 0) {
+  return 0;
+}
+
+int AUP_PE_loadState(void* stPtr, const void* buf, size_t bufSize) {
+  PE_St* stHdl;
+
+  if (stPtr == NULL || buf == NULL) {
     return -1;
   }
+  stHdl = (PE_St*)(stPtr);
+  if (bufSize != AUP_PE_stateIo(stHdl, NULL, 0)) {
+    return -1;
+  }
+  AUP_PE_stateIo(stHdl, (char*)buf, 0);  // only read when loading
 
   return 0;
 }
@@ -864,6 +1015,8 @@ int AUP_PE_proc(void* stPtr, const PE_InputData* pIn, PE_OutputData* pOut) {
   const float* startPtr = NULL;
   const float* refSeqPtr = NULL;
   const float* mvSeqPtr = NULL;
+  const float* excBuf = NULL;
+  const float* excBufSq = NULL;
   int CORR_HALF_HOPSZ, SIDXT, XCIdx;
   int bestPeriodEstLocal[AUP_PE_TOTAL_NFEAT * 2] = {0};
   float w, sx = 0, sxx = 0, sxy = 0, sy = 0, sw = 0;
@@ -900,7 +1053,19 @@ int AUP_PE_proc(void* stPtr, const PE_InputData* pIn, PE_OutputData* pOut) {
     logMax = -2.0f;
     follow = -2.0f;
     for (idx = 0; idx < AUP_PE_NB_BANDS; idx++) {
-      Ly[idx] = log10f(1e-2f + bandPow[idx]);  // Ex
+      Ly[idx] = 1e-2f + bandPow[idx];
+    }
+    if (stHdl->stCfg.fastMath) {  // log10(x) = ln(x) * log10(e)
+      AUP_FFTW_fastLog(Ly, AUP_PE_NB_BANDS, Ly);
+      for (idx = 0; idx < AUP_PE_NB_BANDS; idx++) {
+        Ly[idx] *= AUP_PE_LOG10E;
+      }
+    } else {
+      for (idx = 0; idx < AUP_PE_NB_BANDS; idx++) {
+        Ly[idx] = log10f(Ly[idx]);  // Ex
+      }
+    }
+    for (idx = 0; idx < AUP_PE_NB_BANDS; idx++) {
       Ly[idx] = AUP_PE_MAX(logMax - 8.0f, AUP_PE_MAX(follow - 2.5f, Ly[idx]));
       logMax = AUP_PE_MAX(logMax, Ly[idx]);
 
@@ -910,33 +1075,43 @@ int AUP_PE_proc(void* stPtr, const PE_InputData* pIn, PE_OutputData* pOut) {
     AUP_PE_dct(stHdl->dct_table, Ly, stHdl->tmpFeat);
 
     lpcErr = AUP_PE_lpcCompute((int)(stHdl->stCfg.anaWindowSz), nBins,
-                               stHdl->dct_table, stHdl->tmpFeat, stHdl->lpc);
-
-    memmove(stHdl->inputQ, stHdl->inputQ + hopSz,
-            sizeof(float) * (stHdl->inputQLen - hopSz));
-    memcpy(&(stHdl->inputQ[stHdl->inputQLen - hopSz]), pIn->timeSignal,
-           sizeof(float) * hopSz);
+                               stHdl->dct_table, stHdl->tmpFeat,
+                               stHdl->stCfg.fastMath, stHdl->lpc);
+
+    // push this hop into the circular inputQ (hopSz <= inputQLen - hopSz)
+    tmpInt = AUP_PE_MIN(hopSz, stHdl->inputQLen - stHdl->inputQIdx);
+    memcpy(stHdl->inputQ + stHdl->inputQIdx, pIn->timeSignal,
+           sizeof(float) * tmpInt);
+    memcpy(stHdl->inputQ, pIn->timeSignal + tmpInt,
+           sizeof(float) * (hopSz - tmpInt));
+    stHdl->inputQIdx += hopSz;
+    if (stHdl->inputQIdx >= stHdl->inputQLen) {
+      stHdl->inputQIdx -= stHdl->inputQLen;
+    }
     // then, take part out into alignedIn for later correlation calculation
     offset =
         AUP_PE_MAX(0, stHdl->inputQLen - hopSz - AUP_PE_XCORR_TRAINING_OFFSET);
-    memcpy(stHdl->alignedIn, stHdl->inputQ + offset, sizeof(float) * hopSz);
-
+    offset += stHdl->inputQIdx;
+    if (offset >= stHdl->inputQLen) {
+      offset -= stHdl->inputQLen;
+    }
+    tmpInt = AUP_PE_MIN(hopSz, stHdl->inputQLen - offset);
+    memcpy(stHdl->alignedIn + AUP_PE_LPC_ORDER, stHdl->inputQ + offset,
+           sizeof(float) * tmpInt);
+    memcpy(stHdl->alignedIn + AUP_PE_LPC_ORDER + tmpInt, stHdl->inputQ,
+           sizeof(float) * (hopSz - tmpInt));
+
+    // FIR LPC filtering ..... over the history-prefixed block
+    AUP_FFTW_firBlock(stHdl->alignedIn + AUP_PE_LPC_ORDER, stHdl->lpc,
+                      AUP_PE_LPC_ORDER, hopSz, stHdl->lpcFilterOutBuf);
     for (idx = 0; idx < hopSz; idx++) {
-      // FIR LPC filtering .....
-      slidWinSum = stHdl->alignedIn[idx];
-      for (jdx = 0; jdx < AUP_PE_LPC_ORDER; jdx++) {
-        slidWinSum += stHdl->lpc[jdx] * stHdl->pitch_mem[jdx];
-      }
-
-      memmove(stHdl->pitch_mem + 1, stHdl->pitch_mem,
-              sizeof(float) * (AUP_PE_LPC_ORDER - 1));
-      stHdl->pitch_mem[0] =
-          stHdl->alignedIn[idx];  // push the latest base-sample into the tail
-                                  // of FIFO
-
+      slidWinSum = stHdl->lpcFilterOutBuf[idx];
       stHdl->lpcFilterOutBuf[idx] = slidWinSum + 0.7f * stHdl->pitch_filt;
       stHdl->pitch_filt = slidWinSum;
     }
+    // keep the latest samples as the FIR history of the next hop
+    memmove(stHdl->alignedIn, stHdl->alignedIn + hopSz,
+            sizeof(float) * AUP_PE_LPC_ORDER);
 
     if (stHdl->procResampleRate != 1) {
       // resample of lpcFilterOutBuf
@@ -956,18 +1131,11 @@ int AUP_PE_proc(void* stPtr, const PE_InputData* pIn, PE_OutputData* pOut) {
         stHdl->inputResampleBufIdx++;
       }
       // update the excBuf ....
-      tmpInt = stHdl->inputResampleBufIdx;
-      memmove(stHdl->excBuf, stHdl->excBuf + tmpInt,
-              sizeof(float) * (stHdl->excBufLen - tmpInt));
-      memcpy(stHdl->excBuf + (stHdl->excBufLen - tmpInt),
-             stHdl->inputResampleBuf, sizeof(float) * tmpInt);
+      AUP_PE_pushExcBuf(stHdl, stHdl->inputResampleBuf,
+                        stHdl->inputResampleBufIdx);
       stHdl->inputResampleBufIdx = 0;
     } else {
-      tmpInt = hopSz;
-      memmove(stHdl->excBuf, stHdl->excBuf + tmpInt,
-              sizeof(float) * (stHdl->excBufLen - tmpInt));
-      memcpy(stHdl->excBuf + (stHdl->excBufLen - tmpInt),
-             stHdl->lpcFilterOutBuf, sizeof(float) * tmpInt);
+      AUP_PE_pushExcBuf(stHdl, stHdl->lpcFilterOutBuf, hopSz);
     }
 
   } else {
@@ -990,25 +1158,18 @@ int AUP_PE_proc(void* stPtr, const PE_InputData* pIn, PE_OutputData* pOut) {
       }
 
       // update the excBuf ....
-      tmpInt = stHdl->inputResampleBufIdx;
-      memmove(stHdl->excBuf, stHdl->excBuf + tmpInt,
-              sizeof(float) * (stHdl->excBufLen - tmpInt));
-      memcpy(stHdl->excBuf + (stHdl->excBufLen - tmpInt),
-             stHdl->inputResampleBuf, sizeof(float) * tmpInt);
+      AUP_PE_pushExcBuf(stHdl, stHdl->inputResampleBuf,
+                        stHdl->inputResampleBufIdx);
       stHdl->inputResampleBufIdx = 0;
     } else {
-      tmpInt = hopSz;
-      memmove(stHdl->excBuf, stHdl->excBuf + tmpInt,
-              sizeof(float) * (stHdl->excBufLen - tmpInt));
-      memcpy(stHdl->excBuf + (stHdl->excBufLen - tmpInt), pIn->timeSignal,
-             sizeof(float) * tmpInt);
+      AUP_PE_pushExcBuf(stHdl, pIn->timeSignal, hopSz);
     }
   }
 
-  // prepare for cross-correlation computation ....
-  for (idx = 0; idx < stHdl->excBufLen; idx++) {
-    stHdl->excBufSq[idx] = (stHdl->excBuf[idx] * stHdl->excBuf[idx]);
-  }
+  // prepare for cross-correlation computation ...., excBufSq is updated
+  // along with excBuf
+  excBuf = stHdl->excBuf + stHdl->excBufIdx;
+  excBufSq = stHdl->excBufSq + stHdl->excBufIdx;
 
   // shift the frmWeight queue to left space for this new frame
   for (idx = 0; idx < (stHdl->nFeat - 1); idx++) {
@@ -1021,20 +1182,20 @@ int AUP_PE_proc(void* stPtr, const PE_InputData* pIn, PE_OutputData* pOut) {
     xcorrAccIdx = 2 * (stHdl->xCorrOffsetIdx) + sub;
     offset = sub * CORR_HALF_HOPSZ;
 
-    refSeqPtr = stHdl->excBuf + (stHdl->maxPeriod + offset);
-    mvSeqPtr = stHdl->excBuf + offset;
-    AUP_PE_MvingXCorr(CORR_HALF_HOPSZ, stHdl->maxPeriod, refSeqPtr, mvSeqPtr,
-                      stHdl->xCorrInst);
+    refSeqPtr = excBuf + (stHdl->maxPeriod + offset);
+    mvSeqPtr = excBuf + offset;
+    AUP_FFTW_xcorrLags(refSeqPtr, mvSeqPtr, CORR_HALF_HOPSZ, stHdl->maxPeriod,
+                       stHdl->xCorrInst);
 
     energy0 = 0;
-    startPtr = stHdl->excBufSq + (stHdl->maxPeriod + offset);
+    startPtr = excBufSq + (stHdl->maxPeriod + offset);
     for (idx = 0; idx < CORR_HALF_HOPSZ; idx++) {
       energy0 += startPtr[idx];
     }
     stHdl->frmWeight[2 * (stHdl->nFeat - 1) + sub] = energy0;
 
     slidWinSum = 0;
-    startPtr = stHdl->excBufSq + offset;
+    startPtr = excBufSq + offset;
     for (idx = 0; idx < CORR_HALF_HOPSZ; idx++) {
       slidWinSum += startPtr[idx];
     }
@@ -1046,8 +1207,8 @@ int AUP_PE_proc(void* stPtr, const PE_InputData* pIn, PE_OutputData* pOut) {
     for (idx = 1; idx < stHdl->maxPeriod; idx++) {
       // update the slidWinSum
       slidWinSum =
-          AUP_PE_MAX(0, slidWinSum - stHdl->excBufSq[offset + idx - 1]);
-      slidWinSum += stHdl->excBufSq[offset + idx + CORR_HALF_HOPSZ - 1];
+          AUP_PE_MAX(0, slidWinSum - excBufSq[offset + idx - 1]);
+      slidWinSum += excBufSq[offset + idx + CORR_HALF_HOPSZ - 1];
 
       tmpDenom = AUP_PE_MAX(1e-12f, slidWinSum + (1 + energy0));
       stHdl->xCorr[xcorrAccIdx][idx] = 2 * stHdl->xCorrInst[idx] / tmpDenom;
@@ -30,6 +30,9 @@ typedef struct PE_StaticCfg_ {
   // 1: use LPC prefiltering before pitch estimation
   size_t procFs;  // internal processing sampling rate
   // 2000/4000/8000/16000
+  int fastMath;
+  // 0: libm log10f / powf of the LPC band energies
+  // 1: the polynomial AUP_FFTW_fastLog / fastExp
 } PE_StaticCfg;
 
 // Configuraiton parameters which can be modified/set every frames
@@ -85,6 +88,47 @@ extern "C" {
  */
 int AUP_PE_create(void** stPtr);
 
+/****************************************************************************
+ * AUP_PE_getMemSize(...)
+ *
+ * This function returns the memory required by _createIn for a handler
+ * configured with pCfg, covering the state handler, its dynamic memory and
+ * the low-pass biquad submodule
+ *
+ * Input:
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - memSize       : required memory size in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_PE_getMemSize(const PE_StaticCfg* pCfg, size_t* memSize);
+
+/****************************************************************************
+ * AUP_PE_createIn(...)
+ *
+ * This function creats a state handler inside caller provided memory, no
+ * memory is allocated by this handler afterwards. _memAllocate has to be
+ * called with the same pCfg (or one requiring less memory); _destroy won't
+ * release mem
+ *
+ * Input:
+ *      - mem           : caller's memory, 8-byte aligned, which has to
+ *                        outlive the handler
+ *      - memSize       : size of mem, at least what _getMemSize returns
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - stPtr         : buffer to store the returned state handler
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_PE_createIn(void** stPtr, void* mem, size_t memSize,
+                    const PE_StaticCfg* pCfg);
+
 /****************************************************************************
  * AUP_PE_destroy(...)
  *
@@ -135,6 +179,64 @@ int AUP_PE_memAllocate(void* stPtr, const PE_StaticCfg* pCfg);
  */
 int AUP_PE_init(void* stPtr);
 
+/****************************************************************************
+ * AUP_PE_getStateSize(...)
+ *
+ * This function returns the size of the signal state written by _saveState,
+ * the dynamic memory (resampler, LPC and excitation
+ * history, cross-correlation and path buffers), the estimator variables and
+ * the internal low-pass filter; it only depends on the static config
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *
+ * Output:
+ *      - stateSize     : size of the state in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_PE_getStateSize(const void* stPtr, size_t* stateSize);
+
+/****************************************************************************
+ * AUP_PE_saveState(...)
+ *
+ * This function copies the signal state of the handler into buf
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate and init
+ *      - bufSize       : size of buf, at least what _getStateSize returns
+ *
+ * Output:
+ *      - buf           : the state, _getStateSize bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_PE_saveState(const void* stPtr, void* buf, size_t bufSize);
+
+/****************************************************************************
+ * AUP_PE_loadState(...)
+ *
+ * This function replaces the signal state of the handler with one written by
+ * _saveState of a handler with the same static config; the dynamic config of
+ * the handler is kept
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *      - buf           : the state
+ *      - bufSize       : size of buf, has to equal what _getStateSize returns
+ *
+ * Output:
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_PE_loadState(void* stPtr, const void* buf, size_t bufSize);
+
 /****************************************************************************
  * AUP_PE_setDynamCfg(...)
  *
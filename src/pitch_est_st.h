@@ -69,6 +69,8 @@ const float AUP_PE_G_8KHZ[AUP_PE_LOWPSS_NSEC] = {
     4.165686e-01f, 4.165686e-01f, 4.165686e-01f, 4.165686e-01f, 4.165686e-01f};
 
 #define AUP_PE_PI (3.1415926f)
+#define AUP_PE_LN10 (2.30258509f)     // ln(10)
+#define AUP_PE_LOG10E (0.434294482f)  // log10(e)
 
 #define AUP_PE_FEAT_TIME_WINDOW (40)  // in ms
 // how much time data to use for cross-correlation calculation
@@ -89,6 +91,7 @@ const float AUP_PE_BAND_LPC_COMP[AUP_PE_NB_BANDS] = {
 typedef struct PE_St_ {
   void* dynamMemPtr;    // memory pointer holding the dynamic memory
   size_t dynamMemSize;  // size of the buffer *dynamMemPtr
+  int extMemFlag;  // 1: handler and dynamic memory live in caller's memory
   // void* ifftStHdl;  // AgoraFft*
   void* biquadIIRPtr;
 
@@ -108,8 +111,8 @@ typedef struct PE_St_ {
   int excBufLen;            // PITCH_MAX_PERIOD + hopSz + 1
   int nFeat;                // number of feature frames to use/store
   int estDelay;             // pitch estimate delay in terms of frames
-  float dct_table[AUP_PE_NB_BANDS *
-                  AUP_PE_NB_BANDS];  // coeff. table of DCT transformation
+  const float* dct_table;  // [AUP_PE_NB_BANDS * AUP_PE_NB_BANDS]
+  // coeff. table of DCT transformation, shared by all handlers
 
   // ---------------------------------------------------------------
   // Dynamic Configuration
@@ -124,17 +127,21 @@ typedef struct PE_St_ {
   float* inputResampleBuf;  // [inputResampleBufLen]
   int inputResampleBufIdx;
 
-  float* inputQ;           // [inputQLen]
-  float* alignedIn;        // [hopSz]
+  float* inputQ;  // [inputQLen], circular
+  int inputQIdx;  // position of the oldest sample in inputQ
+  float* alignedIn;  // [AUP_PE_LPC_ORDER + hopSz]
+  // LPC FIR history (oldest first) followed by the samples of this hop
   float* lpcFilterOutBuf;  // [hopSz]
 
-  float* excBuf;  // [excBufLen]
-  // excBuf stores the smoothed LPC prediction result
-  float* excBufSq;  // [excBufLen]
+  float* excBuf;  // [excBufLen * 2], mirrored
+  // excBuf stores the smoothed LPC prediction result, every sample is written
+  // at idx and idx + excBufLen, so that excBuf + excBufIdx always holds the
+  // latest excBufLen samples contiguously (oldest first)
+  float* excBufSq;  // [excBufLen * 2], mirrored
   // = excBuf.^2
+  int excBufIdx;  // position of the oldest sample in excBuf / excBufSq
 
   float lpc[AUP_PE_LPC_ORDER];
-  float pitch_mem[AUP_PE_LPC_ORDER];
   float pitch_filt;
 
   float tmpFeat[AUP_PE_TOTAL_NFEAT];
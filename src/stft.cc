@@ -63,6 +63,7 @@ static int AUP_Analyzer_publishStaticCfg(Analyzer_St* stHdl) {
 
 static int AUP_Analyzer_resetVariables(Analyzer_St* stHdl) {
   memset(stHdl->dynamMemPtr, 0, stHdl->dynamMemSize);
+  stHdl->inputQIdx = 0;
   return 0;
 }
 
@@ -106,6 +107,13 @@ static int AUP_Analyzer_dynamMemPrepare(Analyzer_St* stHdl, void* memPtrExt,
   return (totalMemSize);
 }
 
+static void AUP_Analyzer_setDefaultCfg(Analyzer_St* stHdl) {
+  stHdl->stCfg.win_len = 768;
+  stHdl->stCfg.hop_size = 256;
+  stHdl->stCfg.fft_size = 1024;
+  stHdl->stCfg.ana_win_coeff = NULL;
+}
+
 // ==========================================================================================
 // public APIs
 // ==========================================================================================
@@ -128,10 +136,56 @@ int AUP_Analyzer_create(void** stPtr) {
   tmpPtr->dynamMemPtr = NULL;
   tmpPtr->dynamMemSize = 0;
 
-  tmpPtr->stCfg.win_len = 768;
-  tmpPtr->stCfg.hop_size = 256;
-  tmpPtr->stCfg.fft_size = 1024;
-  tmpPtr->stCfg.ana_win_coeff = NULL;
+  AUP_Analyzer_setDefaultCfg(tmpPtr);
+
+  return 0;
+}
+
+int AUP_Analyzer_getMemSize(const Analyzer_StaticCfg* pCfg, size_t* memSize) {
+  Analyzer_St tmpSt;
+  int dynamMemSize;
+
+  if (pCfg == NULL || memSize == NULL) {
+    return -1;
+  }
+  memset(&tmpSt, 0, sizeof(Analyzer_St));
+  memcpy(&(tmpSt.stCfg), pCfg, sizeof(Analyzer_StaticCfg));
+  if (AUP_Analyzer_checkStatCfg(&(tmpSt.stCfg)) < 0) {
+    return -1;
+  }
+
+  dynamMemSize = AUP_Analyzer_dynamMemPrepare(&tmpSt, NULL, 0);
+  if (dynamMemSize < 0) {
+    return -1;
+  }
+  (*memSize) = AUP_STFT_ALIGN8(sizeof(Analyzer_St)) + dynamMemSize;
+
+  return 0;
+}
+
+int AUP_Analyzer_createIn(void** stPtr, void* mem, size_t memSize,
+                          const Analyzer_StaticCfg* pCfg) {
+  Analyzer_St* tmpPtr;
+  size_t reqMemSize = 0;
+
+  if (stPtr == NULL || mem == NULL || ((size_t)mem & 7) != 0) {
+    return -1;
+  }
+  if (AUP_Analyzer_getMemSize(pCfg, &reqMemSize) < 0 ||
+      reqMemSize > memSize) {
+    return -1;
+  }
+
+  tmpPtr = (Analyzer_St*)mem;
+  memset(tmpPtr, 0, sizeof(Analyzer_St));
+
+  tmpPtr->extMemFlag = 1;
+  tmpPtr->dynamMemPtr = (char*)mem + AUP_STFT_ALIGN8(sizeof(Analyzer_St));
+  tmpPtr->dynamMemSize = reqMemSize - AUP_STFT_ALIGN8(sizeof(Analyzer_St));
+
+  AUP_Analyzer_setDefaultCfg(tmpPtr);
+
+  (*stPtr) = (void*)tmpPtr;
 
   return 0;
 }
@@ -148,6 +202,11 @@ int AUP_Analyzer_destroy(void** stPtr) {
     return 0;
   }
 
+  if (stHdl->extMemFlag) {  // memory is owned by the caller
+    (*stPtr) = NULL;
+    return 0;
+  }
+
   if (stHdl->dynamMemPtr != NULL) {
     free(stHdl->dynamMemPtr);
   }
@@ -189,6 +248,9 @@ int AUP_Analyzer_memAllocate(void* stPtr, const Analyzer_StaticCfg* pCfg) {
 
   // 5th: allocate dynamic memory
   if ((size_t)totalMemSize > stHdl->dynamMemSize) {
+    if (stHdl->extMemFlag) {  // caller's memory can not grow
+      return -1;
+    }
     if (stHdl->dynamMemPtr != NULL) {
       free(stHdl->dynamMemPtr);
       stHdl->dynamMemSize = 0;
@@ -225,6 +287,62 @@ int AUP_Analyzer_init(void* stPtr) {
   return 0;
 }
 
+// copy the window queue and its position into buf (save != 0) or back from
+// it, return their size; buf == NULL only returns the size
+static size_t AUP_Analyzer_stateIo(Analyzer_St* stHdl, char* buf, int save) {
+  size_t qLen = sizeof(float) * stHdl->stCfg.win_len;
+
+  if (buf != NULL) {
+    if (save) {
+      memcpy(buf, stHdl->inputQ, qLen);
+      memcpy(buf + qLen, &(stHdl->inputQIdx), sizeof(stHdl->inputQIdx));
+    } else {
+      memcpy(stHdl->inputQ, buf, qLen);
+      memcpy(&(stHdl->inputQIdx), buf + qLen, sizeof(stHdl->inputQIdx));
+    }
+  }
+  return qLen + sizeof(stHdl->inputQIdx);
+}
+
+int AUP_Analyzer_getStateSize(const void* stPtr, size_t* stateSize) {
+  if (stPtr == NULL || stateSize == NULL) {
+    return -1;
+  }
+  (*stateSize) = AUP_Analyzer_stateIo((Analyzer_St*)stPtr, NULL, 1);
+
+  return 0;
+}
+
+int AUP_Analyzer_saveState(const void* stPtr, void* buf, size_t bufSize) {
+  Analyzer_St* stHdl;
+
+  if (stPtr == NULL || buf == NULL) {
+    return -1;
+  }
+  stHdl = (Analyzer_St*)(stPtr);  // only read when saving
+  if (bufSize < AUP_Analyzer_stateIo(stHdl, NULL, 1)) {
+    return -1;
+  }
+  AUP_Analyzer_stateIo(stHdl, (char*)buf, 1);
+
+  return 0;
+}
+
+int AUP_Analyzer_loadState(void* stPtr, const void* buf, size_t bufSize) {
+  Analyzer_St* stHdl;
+
+  if (stPtr == NULL || buf == NULL) {
+    return -1;
+  }
+  stHdl = (Analyzer_St*)(stPtr);
+  if (bufSize != AUP_Analyzer_stateIo(stHdl, NULL, 0)) {
+    return -1;
+  }
+  AUP_Analyzer_stateIo(stHdl, (char*)buf, 0);  // only read when loading
+
+  return 0;
+}
+
 int AUP_Analyzer_getStaticCfg(const void* stPtr, Analyzer_StaticCfg* pCfg) {
   const Analyzer_St* stHdl;
 
@@ -238,11 +356,79 @@ int AUP_Analyzer_getStaticCfg(const void* stPtr, Analyzer_StaticCfg* pCfg) {
   return 0;
 }
 
+// push one hop into the input queue and leave the windowed, zero-padded
+// frame in fftInputBuf; kFftSz / kWinLen / kHopSz are the configuration as
+// compile-time constants, so that all sizes are known when compiling, or 0
+// to take it from stCfg
+template <int kFftSz, int kWinLen, int kHopSz>
+static void AUP_Analyzer_frame(Analyzer_St* stHdl, const float* input) {
+  const int hopSz = kHopSz ? kHopSz : stHdl->stCfg.hop_size;
+  const int fftSz = kFftSz ? kFftSz : stHdl->stCfg.fft_size;
+  const int winLen = kWinLen ? kWinLen : stHdl->stCfg.win_len;
+  int qIdx, segLen;
+
+  // overwrite the oldest hopSz samples of the circular inputQ, afterwards
+  // inputQ[inputQIdx] is the oldest sample of the analysis window
+  qIdx = stHdl->inputQIdx;
+  segLen = AUP_STFT_MIN(hopSz, winLen - qIdx);
+  memcpy(stHdl->inputQ + qIdx, input, sizeof(float) * segLen);
+  memcpy(stHdl->inputQ, input + segLen, sizeof(float) * (hopSz - segLen));
+  qIdx += hopSz;
+  if (qIdx >= winLen) {
+    qIdx -= winLen;
+  }
+  stHdl->inputQIdx = qIdx;
+
+  // windowing, unrolling the window in two contiguous segments
+  segLen = winLen - qIdx;
+  if (stHdl->stCfg.ana_win_coeff != NULL) {
+    AUP_FFTW_mulWindow(stHdl->inputQ + qIdx, stHdl->windowCoffCopy, segLen,
+                       stHdl->fftInputBuf);
+    AUP_FFTW_mulWindow(stHdl->inputQ, stHdl->windowCoffCopy + segLen, qIdx,
+                       stHdl->fftInputBuf + segLen);
+  } else {
+    memcpy(stHdl->fftInputBuf, stHdl->inputQ + qIdx, sizeof(float) * segLen);
+    memcpy(stHdl->fftInputBuf + segLen, stHdl->inputQ,
+           sizeof(float) * qIdx);
+  }
+  memset(stHdl->fftInputBuf + winLen, 0, sizeof(float) * (fftSz - winLen));
+}
+
+// one analysis frame, AUP_Analyzer_frame and the FFT selected at compile
+// time for a fixed configuration
+template <int kFftSz, int kWinLen, int kHopSz>
+static void AUP_Analyzer_procFrm(Analyzer_St* stHdl, const float* input,
+                                 float* output, int oLength) {
+  const int fftSz = kFftSz ? kFftSz : stHdl->stCfg.fft_size;
+
+  // every FFT writes the fftSz leading values
+  if (oLength > fftSz) {
+    memset(output + fftSz, 0, sizeof(float) * (oLength - fftSz));
+  }
+  AUP_Analyzer_frame<kFftSz, kWinLen, kHopSz>(stHdl, input);
+
+  if (fftSz == 1024) {
+    // SIMD kernel, already in format1 and unscaled
+    AUP_FFTW_r2c_1024_fmt1(stHdl->fftInputBuf, output);
+    return;
+  }
+
+  if (fftSz == 256) {
+    AUP_FFTW_r2c_256(stHdl->fftInputBuf, output);
+  } else if (fftSz == 512) {
+    AUP_FFTW_r2c_512(stHdl->fftInputBuf, output);
+  } else if (fftSz == 2048) {
+    AUP_FFTW_r2c_2048(stHdl->fftInputBuf, output);
+  } else if (fftSz == 4096) {
+    AUP_FFTW_r2c_4096(stHdl->fftInputBuf, output);
+  }
+  AUP_FFTW_InplaceTransf(1, fftSz, output);
+  AUP_FFTW_RescaleFFTOut(fftSz, output);
+}
+
 int AUP_Analyzer_proc(void* stPtr, const Analyzer_InputData* pIn,
                       Analyzer_OutputData* pOut) {
   Analyzer_St* stHdl = NULL;
-  int hopSz, fftSz, winLen, nBins;
-  int idx = 0;
 
   if (stPtr == NULL || pIn == NULL || pIn->input == NULL || pOut == NULL ||
       pOut->output == NULL) {
@@ -254,42 +440,58 @@ int AUP_Analyzer_proc(void* stPtr, const Analyzer_InputData* pIn,
       pOut->oLength < stHdl->stCfg.fft_size) {
     return -1;
   }
-  hopSz = stHdl->stCfg.hop_size;
-  fftSz = stHdl->stCfg.fft_size;
-  nBins = (fftSz >> 1) + 1;
-  winLen = stHdl->stCfg.win_len;
-
-  memset(pOut->output, 0, sizeof(float) * pOut->oLength);
-  memmove(stHdl->inputQ, stHdl->inputQ + hopSz,
-          sizeof(float) * (winLen - hopSz));
-  memcpy(stHdl->inputQ + (winLen - hopSz), pIn->input, sizeof(float) * hopSz);
 
-  if (stHdl->stCfg.ana_win_coeff != NULL) {
-    for (idx = 0; idx < winLen; idx++) {
-      stHdl->fftInputBuf[idx] = stHdl->inputQ[idx] * stHdl->windowCoffCopy[idx];
-    }
+  if (stHdl->stCfg.fft_size == AUP_STFT_FIXED_FFTSZ &&
+      stHdl->stCfg.win_len == AUP_STFT_FIXED_WINLEN &&
+      stHdl->stCfg.hop_size == AUP_STFT_FIXED_HOPSZ) {
+    AUP_Analyzer_procFrm<AUP_STFT_FIXED_FFTSZ, AUP_STFT_FIXED_WINLEN,
+                         AUP_STFT_FIXED_HOPSZ>(stHdl, pIn->input,
+                                               pOut->output, pOut->oLength);
   } else {
-    for (idx = 0; idx < winLen; idx++) {
-      stHdl->fftInputBuf[idx] = stHdl->inputQ[idx];
-    }
+    AUP_Analyzer_procFrm<0, 0, 0>(stHdl, pIn->input, pOut->output,
+                                  pOut->oLength);
   }
-  for (; idx < fftSz; idx++) {
-    stHdl->fftInputBuf[idx] = 0;
+
+  return 0;
+}
+
+int AUP_Analyzer_procLanes(void* const* stPtrs, const Analyzer_InputData* pIns,
+                           int num, float* output, float* work) {
+  const int lanes = AUP_FFTW_lanes();
+  const float* frames[AUP_FFTW_MAX_LANES];
+  Analyzer_St* stHdl;
+  int c;
+
+  if (stPtrs == NULL || pIns == NULL || output == NULL || work == NULL ||
+      num <= 0 || num > lanes) {
+    return -1;
+  }
+  for (c = 0; c < num; c++) {
+    stHdl = (Analyzer_St*)(stPtrs[c]);
+    if (stHdl == NULL || pIns[c].input == NULL ||
+        pIns[c].iLength != stHdl->stCfg.hop_size ||
+        stHdl->stCfg.fft_size != AUP_STFT_FIXED_FFTSZ ||
+        stHdl->stCfg.win_len != AUP_STFT_FIXED_WINLEN ||
+        stHdl->stCfg.hop_size != AUP_STFT_FIXED_HOPSZ) {
+      return -1;
+    }
   }
 
-  if (fftSz == 256) {
-    AUP_FFTW_r2c_256(stHdl->fftInputBuf, pOut->output);
-  } else if (fftSz == 512) {
-    AUP_FFTW_r2c_512(stHdl->fftInputBuf, pOut->output);
-  } else if (fftSz == 1024) {
-    AUP_FFTW_r2c_1024(stHdl->fftInputBuf, pOut->output);
-  } else if (fftSz == 2048) {
-    AUP_FFTW_r2c_2048(stHdl->fftInputBuf, pOut->output);
-  } else if (fftSz == 4096) {
-    AUP_FFTW_r2c_4096(stHdl->fftInputBuf, pOut->output);
+  // unused lanes take a zero frame, work is free until the FFT
+  if (num < lanes) {
+    memset(work, 0, sizeof(float) * AUP_STFT_FIXED_FFTSZ);
+  }
+  for (c = 0; c < lanes; c++) {
+    frames[c] = work;
+  }
+  for (c = 0; c < num; c++) {
+    stHdl = (Analyzer_St*)(stPtrs[c]);
+    AUP_Analyzer_frame<AUP_STFT_FIXED_FFTSZ, AUP_STFT_FIXED_WINLEN,
+                       AUP_STFT_FIXED_HOPSZ>(stHdl, pIns[c].input);
+    frames[c] = stHdl->fftInputBuf;
   }
-  AUP_FFTW_InplaceTransf(1, fftSz, pOut->output);
-  AUP_FFTW_RescaleFFTOut(fftSz, pOut->output);
+  AUP_FFTW_interleaveLanes(frames, AUP_STFT_FIXED_FFTSZ, output);
+  AUP_FFTW_r2c_1024_fmt1Lanes(output, work);
 
   return 0;
 }
@@ -13,6 +13,13 @@
 
 #define AUP_STFT_MAX_FFTSZ (4096)
 
+// the configuration of the AIVAD front end, for which AUP_Analyzer_proc runs
+// a copy compiled with these sizes (FFT selected at compile time, constant
+// trip counts); any other configuration takes the generic path
+#define AUP_STFT_FIXED_FFTSZ (1024)
+#define AUP_STFT_FIXED_WINLEN (768)
+#define AUP_STFT_FIXED_HOPSZ (256)
+
 // Configuration Parameters, which impacts dynamic memory occupation, can only
 // be set during allocation
 typedef struct Analyzer_StaticCfg_ {
@@ -55,6 +62,46 @@ extern "C" {
  */
 int AUP_Analyzer_create(void** stPtr);
 
+/****************************************************************************
+ * AUP_Analyzer_getMemSize(...)
+ *
+ * This function returns the memory required by _createIn for a handler
+ * configured with pCfg, covering the state handler and its dynamic memory
+ *
+ * Input:
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - memSize       : required memory size in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Analyzer_getMemSize(const Analyzer_StaticCfg* pCfg, size_t* memSize);
+
+/****************************************************************************
+ * AUP_Analyzer_createIn(...)
+ *
+ * This function creats a state handler inside caller provided memory, no
+ * memory is allocated by this handler afterwards. _memAllocate has to be
+ * called with the same pCfg (or one requiring less memory); _destroy won't
+ * release mem
+ *
+ * Input:
+ *      - mem           : caller's memory, 8-byte aligned, which has to
+ *                        outlive the handler
+ *      - memSize       : size of mem, at least what _getMemSize returns
+ *      - pCfg          : static configuration parameters
+ *
+ * Output:
+ *      - stPtr         : buffer to store the returned state handler
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Analyzer_createIn(void** stPtr, void* mem, size_t memSize,
+                          const Analyzer_StaticCfg* pCfg);
+
 /****************************************************************************
  * AUP_Analyzer_destroy(...)
  *
@@ -105,6 +152,62 @@ int AUP_Analyzer_memAllocate(void* stPtr, const Analyzer_StaticCfg* pCfg);
  */
 int AUP_Analyzer_init(void* stPtr);
 
+/****************************************************************************
+ * AUP_Analyzer_getStateSize(...)
+ *
+ * This function returns the size of the signal state written by _saveState,
+ * the queue of the analysis window; it only depends on the static config
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *
+ * Output:
+ *      - stateSize     : size of the state in bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Analyzer_getStateSize(const void* stPtr, size_t* stateSize);
+
+/****************************************************************************
+ * AUP_Analyzer_saveState(...)
+ *
+ * This function copies the signal state of the handler into buf
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate and init
+ *      - bufSize       : size of buf, at least what _getStateSize returns
+ *
+ * Output:
+ *      - buf           : the state, _getStateSize bytes
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Analyzer_saveState(const void* stPtr, void* buf, size_t bufSize);
+
+/****************************************************************************
+ * AUP_Analyzer_loadState(...)
+ *
+ * This function replaces the signal state of the handler with one written by
+ * _saveState of a handler with the same static config; the analysis window
+ * of the handler is kept
+ *
+ * Input:
+ *      - stPtr         : State Handler which has gone through create and
+ *                        memAllocate
+ *      - buf           : the state
+ *      - bufSize       : size of buf, has to equal what _getStateSize returns
+ *
+ * Output:
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int AUP_Analyzer_loadState(void* stPtr, const void* buf, size_t bufSize);
+
 /****************************************************************************
  * AUP_Analyzer_getStaticCfg(...)
  *
@@ -142,6 +245,32 @@ int AUP_Analyzer_getStaticCfg(const void* stPtr, Analyzer_StaticCfg* pCfg);
 int AUP_Analyzer_proc(void* stPtr, const Analyzer_InputData* pIn,
                       Analyzer_OutputData* pOut);
 
+/****************************************************************************
+ * AUP_Analyzer_procLanes(...)
+ *
+ * AUP_Analyzer_proc of up to AUP_FFTW_lanes() handlers at once, the frames
+ * interleaved across the handlers so that the FFT runs one handler per SIMD
+ * lane (see fftw.h); the spectrum of every handler is bit-identical to the
+ * one of AUP_Analyzer_proc
+ *
+ * Input:
+ *      - stPtrs        : [num] State Handlers of the AUP_STFT_FIXED_xxx
+ *                        configuration, all different
+ *      - pIns          : [num] one hop of input each
+ *      - num           : [1, AUP_FFTW_lanes()]
+ *      - work          : scratch of fft_size * AUP_FFTW_lanes() floats
+ *
+ * Output:
+ *      - output        : [fft_size][AUP_FFTW_lanes()] format1 spectra, the
+ *                        one of stPtrs[c] at output[k * lanes + c], lanes
+ *                        beyond num hold the spectrum of a zero frame
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error, e.g. no SoA kernels in scalar builds
+ */
+int AUP_Analyzer_procLanes(void* const* stPtrs, const Analyzer_InputData* pIns,
+                           int num, float* output, float* work);
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,6 +17,7 @@
 typedef struct Analyzer_St_ {
   void* dynamMemPtr;    // memory pointer holding the dynamic memory
   size_t dynamMemSize;  // size of the buffer *dynamMemPtr
+  int extMemFlag;  // 1: handler and dynamic memory live in caller's memory
 
   // ---------------------------------------------------------------
   // Static Configuration
@@ -35,7 +36,8 @@ typedef struct Analyzer_St_ {
 
   // ---------------------------------------------------------------
   // Variables
-  float* inputQ;       // [stCfg->win_len + 4]
+  float* inputQ;       // [stCfg->win_len + 4], circular over win_len
+  int inputQIdx;       // position of the oldest sample in inputQ
   float* fftInputBuf;  // [stCfg->fft_size + 4]
 } Analyzer_St;
 
@@ -4,38 +4,275 @@
 // Licensed under the Apache License, Version 2.0, with certain conditions.
 // Refer to the "LICENSE" file in the root directory for more information.
 //
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
 #include "ten_vad.h"
 #include "aed_st.h"
 #include "aed.h"
 
-static void int16_to_float(const int16_t* inputs, int inputLen, float* output) {
-  for (int i = 0; i < inputLen; ++i) {
-    output[i] = float(inputs[i]);
+// hops per AUP_Aed_procBuffer call of ten_vad_process_buffer, bounds the
+// buffered features of a call
+#define TEN_VAD_BUFFER_BLOCK_HOPS (1024)
+// max. hops completed per AUP_Aed_procChunk call of ten_vad_process_chunk
+#define TEN_VAD_CHUNK_BLOCK_HOPS (16)
+
+// wait-free single-producer / single-consumer ring of trivially copyable
+// elements; the counters only grow, their difference is the fill level
+template <typename T>
+class TenVadSpscRing {
+ public:
+  explicit TenVadSpscRing(size_t capacity) {
+    size_t cap = 1;
+    while (cap < capacity) {
+      cap <<= 1;
+    }
+    buf_.resize(cap);
+    mask_ = cap - 1;
+  }
+
+  // producer side
+  size_t writeAvail() const {
+    return buf_.size() - (head_.load(std::memory_order_relaxed) -
+                          tail_.load(std::memory_order_acquire));
+  }
+  void write(const T* data, size_t num) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t pos = head & mask_;
+    size_t first = num < buf_.size() - pos ? num : buf_.size() - pos;
+    memcpy(&buf_[pos], data, sizeof(T) * first);
+    memcpy(&buf_[0], data + first, sizeof(T) * (num - first));
+    head_.store(head + num, std::memory_order_release);
+  }
+
+  // consumer side
+  size_t readAvail() const {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_relaxed);
+  }
+  void read(T* data, size_t num) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t pos = tail & mask_;
+    size_t first = num < buf_.size() - pos ? num : buf_.size() - pos;
+    memcpy(data, &buf_[pos], sizeof(T) * first);
+    memcpy(data + first, &buf_[0], sizeof(T) * (num - first));
+    tail_.store(tail + num, std::memory_order_release);
+  }
+
+ private:
+  std::vector<T> buf_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> head_{0};  // written by the producer
+  alignas(64) std::atomic<size_t> tail_{0};  // written by the consumer
+};
+
+#define TEN_VAD_PUSH_DEFAULT_QUEUE_SAMPLES (16000)
+#define TEN_VAD_PUSH_DEFAULT_QUEUE_RESULTS (256)
+
+// state of the ten_vad_push() mode, see Aed_St::pushQueue
+struct TenVadPushQueue {
+  TenVadPushQueue(size_t samples, size_t results, size_t hopSz)
+      : pcm(samples), res(results), frame(hopSz) {}
+  TenVadSpscRing<int16_t> pcm;
+  TenVadSpscRing<ten_vad_result_t> res;
+  std::vector<int16_t> frame;  // [hopSz], consumer side
+  uint64_t timestamp = 0;      // consumed samples, consumer side
+  std::thread thread;          // consumer thread of start_thread
+  std::atomic<bool> stop{false};
+};
+
+#define TEN_VAD_SEGMENT_DEFAULT_SPEECH_FRAMES (3)    // 48ms
+#define TEN_VAD_SEGMENT_DEFAULT_SILENCE_FRAMES (10)  // 160ms
+#define TEN_VAD_SEGMENT_DEFAULT_END_OFFSET (0.15f)
+
+// state of the speech segmenter, see Aed_St::segmenter: a hysteresis over
+// the processed frames, counted as Aed_St::procFrmNum
+struct TenVadSegmenter {
+  float startThr;
+  float endThr;
+  size_t minSpeechFrms;
+  size_t minSilenceFrms;
+  uint64_t frmLen;  // see AUP_Aed_getFrmTiming
+  uint64_t delay;
+  uint64_t frmNum = 0;    // frames fed so far
+  bool inSpeech = false;  // whether a segment is open
+  size_t runFrms = 0;     // frames of the run against the state: at
+                          // startThr or above while silent, below endThr
+                          // while in speech
+  uint64_t runStart = 0;  // first frame of that run
+  float runMax = 0.0f;    // max. probability of that run
+  uint64_t segStart = 0;  // frames [segStart, segEnd) of the open segment
+  uint64_t segEnd = 0;
+  float segMax = 0.0f;
+
+  // restart silent at frame frms
+  void restart(uint64_t frms) {
+    frmNum = frms;
+    inSpeech = false;
+    runFrms = 0;
+  }
+
+  uint64_t sample(uint64_t frm) const {
+    return frm * frmLen > delay ? frm * frmLen - delay : 0;
   }
+
+  // write the open segment to seg and close it
+  void close(ten_vad_segment_t* seg) {
+    seg->start_sample = sample(segStart);
+    seg->end_sample = sample(segEnd);
+    seg->max_prob = segMax;
+    inSpeech = false;
+    runFrms = 0;
+  }
+
+  // feed the frames up to frms, all of the probability prob; returns
+  // whether a segment ended and was written to seg
+  bool feed(uint64_t frms, float prob, ten_vad_segment_t* seg) {
+    if (frms <= frmNum) {
+      return false;
+    }
+    size_t num = (size_t)(frms - frmNum);
+    uint64_t first = frmNum;
+    frmNum = frms;
+    if (!inSpeech) {
+      if (prob < startThr) {
+        runFrms = 0;
+        return false;
+      }
+      if (runFrms == 0) {
+        runStart = first;
+        runMax = prob;
+      }
+      runFrms += num;
+      runMax = prob > runMax ? prob : runMax;
+      if (runFrms >= minSpeechFrms) {
+        inSpeech = true;
+        runFrms = 0;
+        segStart = runStart;
+        segEnd = frms;
+        segMax = runMax;
+      }
+      return false;
+    }
+    if (prob >= endThr) {
+      runFrms = 0;
+      segEnd = frms;
+      segMax = prob > segMax ? prob : segMax;
+      return false;
+    }
+    runFrms += num;
+    if (runFrms < minSilenceFrms) {
+      return false;
+    }
+    close(seg);
+    return true;
+  }
+};
+
+// internal hop of the analysis, the only one external spectra can come at
+#define TEN_VAD_SPECTRUM_HOP_SIZE (256)
+
+static int ten_vad_static_cfg(const ten_vad_config_t* config,
+                              Aed_StaticCfg* aedStCfg) {
+  aedStCfg->enableFlag = 1;
+  aedStCfg->fftSz = 0;
+  aedStCfg->hopSz = config->hop_size;
+  aedStCfg->anaWindowSz = 0;
+  aedStCfg->frqInputAvailableFlag = 0;
+  if (config->spectrum_fft_size != 0) {
+    if (config->hop_size != TEN_VAD_SPECTRUM_HOP_SIZE ||
+        (config->sample_rate != 0 && config->sample_rate != AUP_AED_FS) ||
+        config->spectrum_fft_size < TEN_VAD_SPECTRUM_HOP_SIZE) {
+      return -1;
+    }
+    aedStCfg->fftSz = config->spectrum_fft_size;
+    aedStCfg->anaWindowSz = config->spectrum_fft_size;
+    aedStCfg->frqInputAvailableFlag = 1;
+  }
+  aedStCfg->modelPath = config->model_path;
+  aedStCfg->modelData = config->model_data;
+  aedStCfg->modelDataLen = config->model_data_len;
+  aedStCfg->inputFs = config->sample_rate;
+  aedStCfg->modelPrecision = config->model_precision;
+  aedStCfg->fastMath = config->fast_math;
+  return 0;
 }
 
-int ten_vad_create(ten_vad_handle_t* handle, size_t hop_size, float threshold) {
+static int ten_vad_setup(ten_vad_handle_t* handle,
+                         const ten_vad_config_t* config,
+                         const Aed_StaticCfg* aedStCfg) {
+  Aed_St* stHdl = (Aed_St*)(*handle);
+  stHdl->dynamCfg.extVoiceThr = config->threshold;
+  if (config->gate_rms_threshold > 0.0f) {
+    stHdl->dynamCfg.extEnergyThr = config->gate_rms_threshold;
+    stHdl->dynamCfg.energyGateFlag = 1;
+    if (config->gate_hang_frames > 0) {
+      stHdl->dynamCfg.energyGateHangFrm = config->gate_hang_frames;
+    }
+  }
+  if (config->inference_stride > 1) {
+    stHdl->dynamCfg.infStride = config->inference_stride;
+    stHdl->dynamCfg.infStrideMargin = config->inference_stride_margin;
+  }
+  stHdl->dynamCfg.lazyPitchFlag = config->lazy_pitch != 0;
+
+  if (AUP_Aed_memAllocate(*handle, aedStCfg) < 0 ||
+      AUP_Aed_init(*handle) < 0) {
+    AUP_Aed_destroy(handle);
+    return -1;
+  }
+  return 0;
+}
+
+int ten_vad_create_ex(ten_vad_handle_t* handle,
+                      const ten_vad_config_t* config) {
+  if (handle == nullptr || config == nullptr) {
+    return -1;
+  }
+  Aed_StaticCfg aedStCfg;
+  if (ten_vad_static_cfg(config, &aedStCfg) < 0) {
+    return -1;
+  }
   if (AUP_Aed_create(handle) < 0) {
     return -1;
   }
-  Aed_St* stHdl = nullptr;
+  return ten_vad_setup(handle, config, &aedStCfg);
+}
+
+int ten_vad_get_mem_size(const ten_vad_config_t* config, size_t* mem_size) {
+  if (config == nullptr || mem_size == nullptr) {
+    return -1;
+  }
   Aed_StaticCfg aedStCfg;
-  aedStCfg.enableFlag = 1;
-  aedStCfg.fftSz = 0;
-  aedStCfg.hopSz = hop_size;
-  aedStCfg.anaWindowSz = 0;
-  aedStCfg.frqInputAvailableFlag = 0;
-  stHdl = (Aed_St*)(*handle);
-  stHdl->dynamCfg.extVoiceThr = threshold;
+  if (ten_vad_static_cfg(config, &aedStCfg) < 0) {
+    return -1;
+  }
+  return AUP_Aed_getMemSize(&aedStCfg, mem_size);
+}
 
-  if (AUP_Aed_memAllocate(*handle, &aedStCfg) < 0) {
+int ten_vad_create_in(ten_vad_handle_t* handle, void* mem, size_t mem_size,
+                      const ten_vad_config_t* config) {
+  if (handle == nullptr || config == nullptr) {
     return -1;
   }
-  if (AUP_Aed_init(*handle) < 0) {
+  Aed_StaticCfg aedStCfg;
+  if (ten_vad_static_cfg(config, &aedStCfg) < 0) {
     return -1;
   }
-  return 0;
+  if (AUP_Aed_createIn(handle, mem, mem_size, &aedStCfg) < 0) {
+    return -1;
+  }
+  return ten_vad_setup(handle, config, &aedStCfg);
+}
+
+int ten_vad_create(ten_vad_handle_t* handle, size_t hop_size, float threshold) {
+  ten_vad_config_t config = {};
+  config.hop_size = hop_size;
+  config.threshold = threshold;
+  return ten_vad_create_ex(handle, &config);
 }
 
 int ten_vad_process(ten_vad_handle_t handle, const int16_t* audio_data,
@@ -47,13 +284,68 @@ int ten_vad_process(ten_vad_handle_t handle, const int16_t* audio_data,
   }
   Aed_St* ptr = (Aed_St*)handle;
   assert(audio_data_length == ptr->stCfg.hopSz);
-  int16_to_float(audio_data, audio_data_length, ptr->inputFloatBuff);
   Aed_InputData aedInputData;
   Aed_OutputData aedOutputData;
   aedInputData.binPower = NULL;
   aedInputData.hopSz = ptr->stCfg.hopSz;
   aedInputData.nBins = -1;
-  aedInputData.timeSignal = ptr->inputFloatBuff;
+  aedInputData.timeSignal = audio_data;
+  aedInputData.sampleType = AUP_AED_SAMPLE_S16;
+  int ret = AUP_Aed_proc(handle, &aedInputData, &aedOutputData);
+  if (ret == 0) {
+    *out_probability = aedOutputData.voiceProb;
+    *out_flag = aedOutputData.vadRes;
+  }
+  return ret;
+}
+
+int ten_vad_process_f32(ten_vad_handle_t handle, const float* audio_data,
+                        size_t audio_data_length, float* out_probability,
+                        int* out_flag) {
+  if (handle == nullptr || audio_data == nullptr ||
+      out_probability == nullptr || out_flag == nullptr) {
+    return -1;
+  }
+  Aed_St* ptr = (Aed_St*)handle;
+  if (audio_data_length != ptr->stCfg.hopSz) {
+    return -1;
+  }
+  Aed_InputData aedInputData;
+  Aed_OutputData aedOutputData;
+  aedInputData.binPower = NULL;
+  aedInputData.hopSz = ptr->stCfg.hopSz;
+  aedInputData.nBins = -1;
+  aedInputData.timeSignal = audio_data;
+  aedInputData.sampleType = AUP_AED_SAMPLE_F32;
+  int ret = AUP_Aed_proc(handle, &aedInputData, &aedOutputData);
+  if (ret == 0) {
+    *out_probability = aedOutputData.voiceProb;
+    *out_flag = aedOutputData.vadRes;
+  }
+  return ret;
+}
+
+int ten_vad_process_spectrum(ten_vad_handle_t handle,
+                             const int16_t* audio_data,
+                             size_t audio_data_length, const float* power,
+                             size_t n_bins, float* out_probability,
+                             int* out_flag) {
+  if (handle == nullptr || audio_data == nullptr || power == nullptr ||
+      out_probability == nullptr || out_flag == nullptr) {
+    return -1;
+  }
+  Aed_St* ptr = (Aed_St*)handle;
+  if (ptr->stCfg.frqInputAvailableFlag == 0 ||
+      audio_data_length != ptr->stCfg.hopSz) {
+    return -1;
+  }
+  Aed_InputData aedInputData;
+  Aed_OutputData aedOutputData;
+  aedInputData.binPower = power;
+  aedInputData.hopSz = ptr->stCfg.hopSz;
+  aedInputData.nBins = (int)n_bins;
+  aedInputData.timeSignal = audio_data;
+  aedInputData.sampleType = AUP_AED_SAMPLE_S16;
   int ret = AUP_Aed_proc(handle, &aedInputData, &aedOutputData);
   if (ret == 0) {
     *out_probability = aedOutputData.voiceProb;
@@ -62,7 +354,501 @@ int ten_vad_process(ten_vad_handle_t handle, const int16_t* audio_data,
   return ret;
 }
 
+// AUP_Aed_procBatch of one hop on each of the num handles
+static int ten_vad_batch(ten_vad_handle_t* handles,
+                         const int16_t* const* audio_data,
+                         size_t audio_data_length, size_t num,
+                         std::vector<Aed_OutputData>& aedOutputData) {
+  std::vector<Aed_InputData> aedInputData(num);
+  aedOutputData.resize(num);
+  for (size_t i = 0; i < num; i++) {
+    if (handles[i] == nullptr || audio_data[i] == nullptr) {
+      return -1;
+    }
+    Aed_St* ptr = (Aed_St*)handles[i];
+    assert(audio_data_length == ptr->stCfg.hopSz);
+    aedInputData[i].binPower = NULL;
+    aedInputData[i].hopSz = ptr->stCfg.hopSz;
+    aedInputData[i].nBins = -1;
+    aedInputData[i].timeSignal = audio_data[i];
+    aedInputData[i].sampleType = AUP_AED_SAMPLE_S16;
+  }
+  return AUP_Aed_procBatch(handles, aedInputData.data(),
+                           aedOutputData.data(), (int)num);
+}
+
+int ten_vad_process_batch(ten_vad_handle_t* handles,
+                          const int16_t* const* audio_data,
+                          size_t audio_data_length, float* out_probabilities,
+                          int* out_flags, size_t num) {
+  if (handles == nullptr || audio_data == nullptr ||
+      out_probabilities == nullptr || out_flags == nullptr || num == 0) {
+    return -1;
+  }
+  std::vector<Aed_OutputData> aedOutputData;
+  int ret = ten_vad_batch(handles, audio_data, audio_data_length, num,
+                          aedOutputData);
+  if (ret == 0) {
+    for (size_t i = 0; i < num; i++) {
+      out_probabilities[i] = aedOutputData[i].voiceProb;
+      out_flags[i] = aedOutputData[i].vadRes;
+    }
+  }
+  return ret;
+}
+
+// AUP_Aed_procBuffer over the n / hopSz hops of pcm in blocks, onHop(i, out)
+// gets the output of every hop i
+template <typename F>
+static int ten_vad_buffer(ten_vad_handle_t handle, const int16_t* pcm,
+                          size_t n, F onHop) {
+  Aed_St* ptr = (Aed_St*)handle;
+  size_t hopSz = ptr->stCfg.hopSz;
+  size_t num = n / hopSz;
+  size_t blkHops = num < TEN_VAD_BUFFER_BLOCK_HOPS ? num
+                                                   : TEN_VAD_BUFFER_BLOCK_HOPS;
+  std::vector<Aed_InputData> aedInputData(blkHops);
+  std::vector<Aed_OutputData> aedOutputData(blkHops);
+  for (size_t i = 0; i < blkHops; i++) {
+    aedInputData[i].binPower = NULL;
+    aedInputData[i].hopSz = (int)hopSz;
+    aedInputData[i].nBins = -1;
+    aedInputData[i].sampleType = AUP_AED_SAMPLE_S16;
+  }
+  for (size_t done = 0; done < num; done += blkHops) {
+    size_t cnt = num - done < blkHops ? num - done : blkHops;
+    for (size_t i = 0; i < cnt; i++) {
+      aedInputData[i].timeSignal = pcm + (done + i) * hopSz;
+    }
+    if (AUP_Aed_procBuffer(handle, aedInputData.data(), aedOutputData.data(),
+                           (int)cnt) != 0) {
+      return -1;
+    }
+    for (size_t i = 0; i < cnt; i++) {
+      onHop(done + i, aedOutputData[i]);
+    }
+  }
+  return 0;
+}
+
+int ten_vad_process_buffer(ten_vad_handle_t handle, const int16_t* pcm,
+                           size_t n, float* probs, int* flags,
+                           size_t* n_frames) {
+  if (handle == nullptr || pcm == nullptr || probs == nullptr ||
+      flags == nullptr || n_frames == nullptr) {
+    return -1;
+  }
+  *n_frames = 0;
+  return ten_vad_buffer(handle, pcm, n,
+                        [&](size_t i, const Aed_OutputData& out) {
+                          probs[i] = out.voiceProb;
+                          flags[i] = out.vadRes;
+                          *n_frames = i + 1;
+                        });
+}
+
+static int ten_vad_chunk(ten_vad_handle_t handle, const void* audio_data,
+                         size_t sampleSz, int sampleType,
+                         size_t audio_data_length, float* out_probabilities,
+                         int* out_flags, size_t max_frames,
+                         size_t* n_frames) {
+  if (handle == nullptr || (audio_data == nullptr && audio_data_length > 0) ||
+      out_probabilities == nullptr || out_flags == nullptr ||
+      n_frames == nullptr) {
+    return -1;
+  }
+  Aed_St* ptr = (Aed_St*)handle;
+  size_t hopSz = ptr->stCfg.hopSz;
+  *n_frames = 0;
+  if ((ptr->chunkFill + audio_data_length) / hopSz > max_frames) {
+    return -1;
+  }
+  if (audio_data_length == 0) {
+    return 0;
+  }
+  Aed_InputData aedInputData;
+  Aed_OutputData aedOutputData[TEN_VAD_CHUNK_BLOCK_HOPS];
+  aedInputData.binPower = NULL;
+  aedInputData.nBins = -1;
+  aedInputData.sampleType = sampleType;
+  const char* in = (const char*)audio_data;
+  size_t done = 0;
+  while (done < audio_data_length) {
+    // as many samples as complete at most TEN_VAD_CHUNK_BLOCK_HOPS hops
+    size_t cnt = TEN_VAD_CHUNK_BLOCK_HOPS * hopSz - ptr->chunkFill;
+    if (cnt > audio_data_length - done) {
+      cnt = audio_data_length - done;
+    }
+    int num = 0;
+    aedInputData.timeSignal = in + done * sampleSz;
+    aedInputData.hopSz = (int)cnt;
+    if (AUP_Aed_procChunk(handle, &aedInputData, aedOutputData,
+                          TEN_VAD_CHUNK_BLOCK_HOPS, &num) != 0) {
+      return -1;
+    }
+    for (int i = 0; i < num; i++) {
+      out_probabilities[*n_frames] = aedOutputData[i].voiceProb;
+      out_flags[*n_frames] = aedOutputData[i].vadRes;
+      (*n_frames)++;
+    }
+    done += cnt;
+  }
+  return 0;
+}
+
+int ten_vad_process_chunk(ten_vad_handle_t handle, const int16_t* audio_data,
+                          size_t audio_data_length, float* out_probabilities,
+                          int* out_flags, size_t max_frames,
+                          size_t* n_frames) {
+  return ten_vad_chunk(handle, audio_data, sizeof(int16_t),
+                       AUP_AED_SAMPLE_S16, audio_data_length,
+                       out_probabilities, out_flags, max_frames, n_frames);
+}
+
+int ten_vad_process_chunk_f32(ten_vad_handle_t handle, const float* audio_data,
+                              size_t audio_data_length,
+                              float* out_probabilities, int* out_flags,
+                              size_t max_frames, size_t* n_frames) {
+  return ten_vad_chunk(handle, audio_data, sizeof(float), AUP_AED_SAMPLE_F32,
+                       audio_data_length, out_probabilities, out_flags,
+                       max_frames, n_frames);
+}
+
+int ten_vad_segmenter_start(ten_vad_handle_t handle,
+                            const ten_vad_segmenter_config_t* config) {
+  if (handle == nullptr) {
+    return -1;
+  }
+  Aed_St* ptr = (Aed_St*)handle;
+  ten_vad_segmenter_config_t cfg = {};
+  int frmLen, delay;
+  if (config != nullptr) {
+    cfg = *config;
+  }
+  if (ptr->stCfg.frqInputAvailableFlag != 0 || cfg.start_threshold < 0.0f ||
+      cfg.start_threshold > 1.0f || cfg.end_threshold < 0.0f ||
+      cfg.end_threshold > 1.0f ||
+      AUP_Aed_getFrmTiming(handle, &frmLen, &delay) < 0) {
+    return -1;
+  }
+  if (cfg.start_threshold == 0.0f) {
+    cfg.start_threshold = ptr->dynamCfg.extVoiceThr;
+  }
+  if (cfg.end_threshold == 0.0f) {
+    cfg.end_threshold =
+        cfg.start_threshold - TEN_VAD_SEGMENT_DEFAULT_END_OFFSET;
+    if (cfg.end_threshold < cfg.start_threshold * 0.5f) {
+      cfg.end_threshold = cfg.start_threshold * 0.5f;
+    }
+  }
+  if (cfg.end_threshold > cfg.start_threshold) {
+    return -1;
+  }
+  if (cfg.min_speech_frames == 0) {
+    cfg.min_speech_frames = TEN_VAD_SEGMENT_DEFAULT_SPEECH_FRAMES;
+  }
+  if (cfg.min_silence_frames == 0) {
+    cfg.min_silence_frames = TEN_VAD_SEGMENT_DEFAULT_SILENCE_FRAMES;
+  }
+  TenVadSegmenter* seg = (TenVadSegmenter*)ptr->segmenter;
+  if (seg == nullptr) {
+    seg = new TenVadSegmenter();
+    ptr->segmenter = seg;
+  }
+  seg->startThr = cfg.start_threshold;
+  seg->endThr = cfg.end_threshold;
+  seg->minSpeechFrms = cfg.min_speech_frames;
+  seg->minSilenceFrms = cfg.min_silence_frames;
+  seg->frmLen = (uint64_t)frmLen;
+  seg->delay = (uint64_t)delay;
+  seg->restart(ptr->procFrmNum);
+  return 0;
+}
+
+int ten_vad_segment_buffer(ten_vad_handle_t handle, const int16_t* pcm,
+                           size_t n, ten_vad_segment_t* segments,
+                           size_t max_segments, size_t* n_segments) {
+  if (handle == nullptr || pcm == nullptr || segments == nullptr ||
+      n_segments == nullptr) {
+    return -1;
+  }
+  Aed_St* ptr = (Aed_St*)handle;
+  TenVadSegmenter* seg = (TenVadSegmenter*)ptr->segmenter;
+  // a segment ends on a hop below endThr after one at startThr or above
+  if (seg == nullptr || max_segments < n / ptr->stCfg.hopSz / 2 + 1) {
+    return -1;
+  }
+  *n_segments = 0;
+  return ten_vad_buffer(handle, pcm, n,
+                        [&](size_t, const Aed_OutputData& out) {
+                          if (seg->feed(out.procFrmNum, out.voiceProb,
+                                        &segments[*n_segments])) {
+                            (*n_segments)++;
+                          }
+                        });
+}
+
+int ten_vad_segment_batch(ten_vad_handle_t* handles,
+                          const int16_t* const* audio_data,
+                          size_t audio_data_length,
+                          ten_vad_segment_t* segments,
+                          size_t* handle_indices, size_t num,
+                          size_t* n_segments) {
+  if (handles == nullptr || audio_data == nullptr || segments == nullptr ||
+      handle_indices == nullptr || n_segments == nullptr || num == 0) {
+    return -1;
+  }
+  for (size_t i = 0; i < num; i++) {
+    if (handles[i] == nullptr || ((Aed_St*)handles[i])->segmenter == nullptr) {
+      return -1;
+    }
+  }
+  std::vector<Aed_OutputData> aedOutputData;
+  *n_segments = 0;
+  if (ten_vad_batch(handles, audio_data, audio_data_length, num,
+                    aedOutputData) != 0) {
+    return -1;
+  }
+  for (size_t i = 0; i < num; i++) {
+    TenVadSegmenter* seg = (TenVadSegmenter*)((Aed_St*)handles[i])->segmenter;
+    if (seg->feed(aedOutputData[i].procFrmNum, aedOutputData[i].voiceProb,
+                  &segments[*n_segments])) {
+      handle_indices[*n_segments] = i;
+      (*n_segments)++;
+    }
+  }
+  return 0;
+}
+
+int ten_vad_segment_flush(ten_vad_handle_t handle, ten_vad_segment_t* segment,
+                          size_t* n_segments) {
+  if (handle == nullptr || segment == nullptr || n_segments == nullptr) {
+    return -1;
+  }
+  TenVadSegmenter* seg = (TenVadSegmenter*)((Aed_St*)handle)->segmenter;
+  if (seg == nullptr) {
+    return -1;
+  }
+  *n_segments = 0;
+  if (seg->inSpeech) {
+    seg->close(segment);
+    *n_segments = 1;
+  }
+  seg->runFrms = 0;
+  return 0;
+}
+
+// drain the input ring frame by frame, as long as results can be stored
+static int ten_vad_push_drain(ten_vad_handle_t handle, TenVadPushQueue* q,
+                              size_t* n_frames) {
+  size_t hopSz = q->frame.size();
+  size_t num = 0;
+  int ret = 0;
+  while (q->pcm.readAvail() >= hopSz && q->res.writeAvail() > 0) {
+    ten_vad_result_t res;
+    q->pcm.read(q->frame.data(), hopSz);
+    res.timestamp = q->timestamp;
+    if (ten_vad_process(handle, q->frame.data(), hopSz, &res.probability,
+                        &res.flag) != 0) {
+      res.probability = -1.0f;
+      res.flag = -1;
+      ret = -1;
+    }
+    q->timestamp += hopSz;
+    q->res.write(&res, 1);
+    num++;
+  }
+  if (n_frames != nullptr) {
+    *n_frames = num;
+  }
+  return ret;
+}
+
+static void ten_vad_push_thread(ten_vad_handle_t handle, TenVadPushQueue* q) {
+  // poll at twice the frame rate, the producer never signals
+  std::chrono::microseconds period(q->frame.size() * 1000000 / 16000 / 2);
+  while (!q->stop.load(std::memory_order_relaxed)) {
+    ten_vad_push_drain(handle, q, nullptr);
+    std::this_thread::sleep_for(period);
+  }
+}
+
+int ten_vad_push_start(ten_vad_handle_t handle,
+                       const ten_vad_push_config_t* config) {
+  if (handle == nullptr) {
+    return -1;
+  }
+  Aed_St* ptr = (Aed_St*)handle;
+  if (ptr->pushQueue != nullptr) {
+    return -1;
+  }
+  ten_vad_push_config_t cfg = {};
+  if (config != nullptr) {
+    cfg = *config;
+  }
+  if (cfg.queue_samples == 0) {
+    cfg.queue_samples = TEN_VAD_PUSH_DEFAULT_QUEUE_SAMPLES;
+  }
+  if (cfg.queue_results == 0) {
+    cfg.queue_results = TEN_VAD_PUSH_DEFAULT_QUEUE_RESULTS;
+  }
+  if (cfg.queue_samples < ptr->stCfg.hopSz) {
+    return -1;
+  }
+  TenVadPushQueue* q = new TenVadPushQueue(
+      cfg.queue_samples, cfg.queue_results, ptr->stCfg.hopSz);
+  if (cfg.start_thread) {
+    q->thread = std::thread(ten_vad_push_thread, handle, q);
+  }
+  ptr->pushQueue = q;
+  return 0;
+}
+
+int ten_vad_push(ten_vad_handle_t handle, const int16_t* pcm, size_t n) {
+  if (handle == nullptr || pcm == nullptr) {
+    return -1;
+  }
+  TenVadPushQueue* q = (TenVadPushQueue*)((Aed_St*)handle)->pushQueue;
+  if (q == nullptr || q->pcm.writeAvail() < n) {
+    return -1;
+  }
+  q->pcm.write(pcm, n);
+  return 0;
+}
+
+int ten_vad_push_process(ten_vad_handle_t handle, size_t* n_frames) {
+  if (handle == nullptr) {
+    return -1;
+  }
+  TenVadPushQueue* q = (TenVadPushQueue*)((Aed_St*)handle)->pushQueue;
+  if (q == nullptr || q->thread.joinable()) {
+    return -1;
+  }
+  return ten_vad_push_drain(handle, q, n_frames);
+}
+
+int ten_vad_poll(ten_vad_handle_t handle, ten_vad_result_t* results,
+                 size_t max_results, size_t* num_results) {
+  if (handle == nullptr || results == nullptr || num_results == nullptr) {
+    return -1;
+  }
+  TenVadPushQueue* q = (TenVadPushQueue*)((Aed_St*)handle)->pushQueue;
+  if (q == nullptr) {
+    return -1;
+  }
+  size_t num = q->res.readAvail();
+  num = num < max_results ? num : max_results;
+  q->res.read(results, num);
+  *num_results = num;
+  return 0;
+}
+
+int ten_vad_push_stop(ten_vad_handle_t handle) {
+  if (handle == nullptr) {
+    return -1;
+  }
+  Aed_St* ptr = (Aed_St*)handle;
+  TenVadPushQueue* q = (TenVadPushQueue*)ptr->pushQueue;
+  if (q == nullptr) {
+    return -1;
+  }
+  if (q->thread.joinable()) {
+    q->stop = true;
+    q->thread.join();
+  }
+  delete q;
+  ptr->pushQueue = nullptr;
+  return 0;
+}
+
+int ten_vad_get_frame_counts(ten_vad_handle_t handle, uint64_t* frames,
+                             uint64_t* gated_frames,
+                             uint64_t* inferred_frames) {
+  if (handle == nullptr) {
+    return -1;
+  }
+  return AUP_Aed_getFrmCnts(handle, frames, gated_frames, inferred_frames);
+}
+
+static void ten_vad_copy_latency(const Aed_StageTiming* src,
+                                 ten_vad_latency_t* tgt) {
+  tgt->count = src->cnt;
+  tgt->min_ns = src->minNs;
+  tgt->avg_ns = src->avgNs;
+  tgt->p99_ns = src->p99Ns;
+  tgt->max_ns = src->maxNs;
+}
+
+int ten_vad_get_stats(ten_vad_handle_t handle, ten_vad_stats_t* stats) {
+  if (stats == nullptr) {
+    return -1;
+  }
+  Aed_Stats aedStats;
+  if (AUP_Aed_getStats(handle, &aedStats) < 0) {
+    return -1;
+  }
+  stats->frames = aedStats.procFrms;
+  stats->gated_frames = aedStats.gatedFrms;
+  stats->inferred_frames = aedStats.inferFrms;
+  ten_vad_copy_latency(&aedStats.stage[AUP_AED_STAGE_STFT], &stats->stft);
+  ten_vad_copy_latency(&aedStats.stage[AUP_AED_STAGE_MEL], &stats->mel);
+  ten_vad_copy_latency(&aedStats.stage[AUP_AED_STAGE_PITCH], &stats->pitch);
+  ten_vad_copy_latency(&aedStats.stage[AUP_AED_STAGE_INFER],
+                       &stats->inference);
+  ten_vad_copy_latency(&aedStats.stage[AUP_AED_STAGE_HOP], &stats->hop);
+  return 0;
+}
+
+// restart the segmenter of handle, if any, at its current frame
+static void ten_vad_segmenter_restart(ten_vad_handle_t handle) {
+  Aed_St* ptr = (Aed_St*)handle;
+  if (ptr->segmenter != nullptr) {
+    ((TenVadSegmenter*)ptr->segmenter)->restart(ptr->procFrmNum);
+  }
+}
+
+int ten_vad_reset(ten_vad_handle_t handle) {
+  if (handle == nullptr || ((Aed_St*)handle)->pushQueue != nullptr) {
+    return -1;
+  }
+  if (AUP_Aed_init(handle) < 0) {
+    return -1;
+  }
+  ten_vad_segmenter_restart(handle);
+  return 0;
+}
+
+int ten_vad_snapshot_size(ten_vad_handle_t handle, size_t* size) {
+  return AUP_Aed_getSnapshotSize(handle, size);
+}
+
+int ten_vad_snapshot(ten_vad_handle_t handle, void* buf, size_t buf_size) {
+  if (handle == nullptr || ((Aed_St*)handle)->pushQueue != nullptr) {
+    return -1;
+  }
+  return AUP_Aed_snapshot(handle, buf, buf_size);
+}
+
+int ten_vad_restore(ten_vad_handle_t handle, const void* buf, size_t size) {
+  if (handle == nullptr || ((Aed_St*)handle)->pushQueue != nullptr) {
+    return -1;
+  }
+  if (AUP_Aed_restore(handle, buf, size) < 0) {
+    return -1;
+  }
+  ten_vad_segmenter_restart(handle);
+  return 0;
+}
+
 int ten_vad_destroy(ten_vad_handle_t* handle) {
+  if (handle != nullptr && *handle != nullptr &&
+      ((Aed_St*)(*handle))->pushQueue != nullptr) {
+    ten_vad_push_stop(*handle);
+  }
+  if (handle != nullptr && *handle != nullptr) {
+    delete (TenVadSegmenter*)((Aed_St*)(*handle))->segmenter;
+    ((Aed_St*)(*handle))->segmenter = nullptr;
+  }
   return AUP_Aed_destroy(handle);
 }
 
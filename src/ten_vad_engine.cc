@@ -0,0 +1,357 @@
+//
+// Copyright © 2025 Agora
+// This file is part of TEN Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "ten_vad.h"
+#include "aed_st.h"
+#include "aed.h"
+
+#define TEN_VAD_ENGINE_DEFAULT_MAX_BATCH (64)
+
+// samples queued for one attached handle, guarded by its own mutex
+struct TenVadEngineStream {
+  ten_vad_handle_t handle = nullptr;
+  size_t hopSz = 0;
+  int homeWorker = 0;
+  std::mutex mutex;
+  std::vector<int16_t> pcm;  // queued samples, pcm[rdPos] is the oldest
+  size_t rdPos = 0;
+  uint64_t frameIdx = 0;  // index of the next frame to process
+  bool scheduled = false;  // sitting in a worker deque or being processed
+};
+
+// deque of streams with at least one complete frame queued, the owner takes
+// from the back and thieves from the front
+struct TenVadEngineWorker {
+  std::mutex mutex;
+  std::deque<TenVadEngineStream*> ready;
+  std::thread thread;
+};
+
+struct TenVadEngine {
+  ten_vad_engine_config_t cfg = {};
+  std::vector<TenVadEngineWorker*> workers;
+  std::atomic<int> nextHome{0};
+
+  std::mutex streamMutex;  // streams
+  std::unordered_map<ten_vad_handle_t, TenVadEngineStream*> streams;
+
+  std::mutex wakeMutex;  // sleeping workers
+  std::condition_variable wakeCv;
+  std::atomic<int> readyCnt{0};  // streams in all worker deques
+  std::atomic<bool> stop{false};
+
+  std::mutex doneMutex;  // ten_vad_engine_flush() and _detach()
+  std::condition_variable doneCv;
+  std::atomic<int64_t> pendingFrames{0};
+
+  std::mutex resultMutex;  // completion queue without callback
+  std::deque<ten_vad_engine_result_t> results;
+};
+
+static void ten_vad_engine_schedule(TenVadEngine* eng,
+                                    TenVadEngineStream* stream, int worker) {
+  TenVadEngineWorker* w = eng->workers[worker];
+  {
+    std::lock_guard<std::mutex> lock(w->mutex);
+    w->ready.push_back(stream);
+  }
+  eng->readyCnt++;
+  { std::lock_guard<std::mutex> lock(eng->wakeMutex); }
+  eng->wakeCv.notify_one();
+}
+
+// own deque first, newest first for cache locality, then steal the oldest
+// streams of the other workers
+static size_t ten_vad_engine_take(TenVadEngine* eng, int self,
+                                  std::vector<TenVadEngineStream*>* batch) {
+  size_t maxBatch = eng->cfg.max_batch;
+  int num = (int)eng->workers.size();
+  for (int k = 0; k < num && batch->size() < maxBatch; k++) {
+    TenVadEngineWorker* w = eng->workers[(self + k) % num];
+    std::lock_guard<std::mutex> lock(w->mutex);
+    while (!w->ready.empty() && batch->size() < maxBatch) {
+      if (k == 0) {
+        batch->push_back(w->ready.back());
+        w->ready.pop_back();
+      } else {
+        batch->push_back(w->ready.front());
+        w->ready.pop_front();
+      }
+    }
+  }
+  eng->readyCnt -= (int)batch->size();
+  return batch->size();
+}
+
+static void ten_vad_engine_pin(int worker) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  unsigned int ncpu = std::thread::hardware_concurrency();
+  if (ncpu == 0) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(worker % ncpu, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)worker;
+#endif
+}
+
+static void ten_vad_engine_deliver(TenVadEngine* eng,
+                                   const ten_vad_engine_result_t* res,
+                                   size_t num) {
+  if (eng->cfg.callback != nullptr) {
+    for (size_t i = 0; i < num; i++) {
+      eng->cfg.callback(&res[i], eng->cfg.user_data);
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> lock(eng->resultMutex);
+  eng->results.insert(eng->results.end(), res, res + num);
+}
+
+static void ten_vad_engine_run(TenVadEngine* eng, int self) {
+  std::vector<TenVadEngineStream*> batch;
+  std::vector<ten_vad_handle_t> handles;
+  std::vector<Aed_InputData> aedInputData;
+  std::vector<Aed_OutputData> aedOutputData;
+  std::vector<ten_vad_engine_result_t> res;
+
+  if (eng->cfg.pin_workers) {
+    ten_vad_engine_pin(self);
+  }
+  batch.reserve(eng->cfg.max_batch);
+  while (!eng->stop) {
+    batch.clear();
+    if (ten_vad_engine_take(eng, self, &batch) == 0) {
+      std::unique_lock<std::mutex> lock(eng->wakeMutex);
+      eng->wakeCv.wait(lock, [eng] { return eng->stop || eng->readyCnt > 0; });
+      continue;
+    }
+
+    // one frame per stream and round, so every stream advances in order
+    size_t num = batch.size();
+    handles.resize(num);
+    aedInputData.resize(num);
+    aedOutputData.resize(num);
+    res.resize(num);
+    for (size_t i = 0; i < num; i++) {
+      TenVadEngineStream* stream = batch[i];
+      Aed_St* ptr = (Aed_St*)stream->handle;
+      std::lock_guard<std::mutex> lock(stream->mutex);
+      const int16_t* pcm = stream->pcm.data() + stream->rdPos;
+      for (size_t k = 0; k < stream->hopSz; k++) {
+        ptr->inputFloatBuff[k] = float(pcm[k]);
+      }
+      stream->rdPos += stream->hopSz;
+      handles[i] = stream->handle;
+      aedInputData[i].binPower = NULL;
+      aedInputData[i].hopSz = (int)stream->hopSz;
+      aedInputData[i].nBins = -1;
+      aedInputData[i].timeSignal = ptr->inputFloatBuff;
+      aedInputData[i].sampleType = AUP_AED_SAMPLE_FLT;
+      res[i].handle = stream->handle;
+      res[i].frame_index = stream->frameIdx++;
+    }
+    int ret = AUP_Aed_procBatch(handles.data(), aedInputData.data(),
+                                aedOutputData.data(), (int)num);
+    for (size_t i = 0; i < num; i++) {
+      res[i].probability = ret == 0 ? aedOutputData[i].voiceProb : -1.0f;
+      res[i].flag = ret == 0 ? aedOutputData[i].vadRes : -1;
+    }
+    ten_vad_engine_deliver(eng, res.data(), num);
+
+    // re-queue the streams with more complete frames on this worker
+    bool idle = false;
+    for (size_t i = 0; i < num; i++) {
+      TenVadEngineStream* stream = batch[i];
+      bool more;
+      {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        more = stream->pcm.size() - stream->rdPos >= stream->hopSz;
+        stream->scheduled = more;
+      }
+      if (more) {
+        ten_vad_engine_schedule(eng, stream, self);
+      } else {
+        idle = true;
+      }
+    }
+    // wakes ten_vad_engine_flush() and ten_vad_engine_detach()
+    if ((eng->pendingFrames -= (int64_t)num) == 0 || idle) {
+      { std::lock_guard<std::mutex> lock(eng->doneMutex); }
+      eng->doneCv.notify_all();
+    }
+  }
+}
+
+static TenVadEngineStream* ten_vad_engine_find(TenVadEngine* eng,
+                                               ten_vad_handle_t handle) {
+  std::lock_guard<std::mutex> lock(eng->streamMutex);
+  auto it = eng->streams.find(handle);
+  return it == eng->streams.end() ? nullptr : it->second;
+}
+
+int ten_vad_engine_create(ten_vad_engine_t* engine,
+                          const ten_vad_engine_config_t* config) {
+  if (engine == nullptr) {
+    return -1;
+  }
+  TenVadEngine* eng = new TenVadEngine();
+  if (config != nullptr) {
+    eng->cfg = *config;
+  }
+  if (eng->cfg.num_workers == 0) {
+    eng->cfg.num_workers = std::thread::hardware_concurrency();
+    if (eng->cfg.num_workers == 0) {
+      eng->cfg.num_workers = 1;
+    }
+  }
+  if (eng->cfg.max_batch == 0) {
+    eng->cfg.max_batch = TEN_VAD_ENGINE_DEFAULT_MAX_BATCH;
+  }
+  for (size_t i = 0; i < eng->cfg.num_workers; i++) {
+    eng->workers.push_back(new TenVadEngineWorker());
+  }
+  for (size_t i = 0; i < eng->cfg.num_workers; i++) {
+    eng->workers[i]->thread = std::thread(ten_vad_engine_run, eng, (int)i);
+  }
+  *engine = eng;
+  return 0;
+}
+
+int ten_vad_engine_attach(ten_vad_engine_t engine, ten_vad_handle_t handle) {
+  TenVadEngine* eng = (TenVadEngine*)engine;
+  if (eng == nullptr || handle == nullptr) {
+    return -1;
+  }
+  TenVadEngineStream* stream = new TenVadEngineStream();
+  stream->handle = handle;
+  stream->hopSz = ((Aed_St*)handle)->stCfg.hopSz;
+  stream->homeWorker = eng->nextHome++ % (int)eng->workers.size();
+  std::lock_guard<std::mutex> lock(eng->streamMutex);
+  if (!eng->streams.emplace(handle, stream).second) {
+    delete stream;
+    return -1;
+  }
+  return 0;
+}
+
+int ten_vad_engine_submit(ten_vad_engine_t engine, ten_vad_handle_t handle,
+                          const int16_t* audio_data, size_t audio_data_length) {
+  TenVadEngine* eng = (TenVadEngine*)engine;
+  if (eng == nullptr || audio_data == nullptr) {
+    return -1;
+  }
+  TenVadEngineStream* stream = ten_vad_engine_find(eng, handle);
+  if (stream == nullptr) {
+    return -1;
+  }
+  bool wake;
+  {
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    size_t avail = stream->pcm.size() - stream->rdPos;
+    // workers only read under the stream lock, drop the consumed samples
+    stream->pcm.erase(stream->pcm.begin(), stream->pcm.begin() + stream->rdPos);
+    stream->rdPos = 0;
+    stream->pcm.insert(stream->pcm.end(), audio_data,
+                       audio_data + audio_data_length);
+    eng->pendingFrames += (int64_t)((avail + audio_data_length) /
+                                        stream->hopSz -
+                                    avail / stream->hopSz);
+    wake = !stream->scheduled && avail + audio_data_length >= stream->hopSz;
+    if (wake) {
+      stream->scheduled = true;
+    }
+  }
+  if (wake) {
+    ten_vad_engine_schedule(eng, stream, stream->homeWorker);
+  }
+  return 0;
+}
+
+int ten_vad_engine_poll(ten_vad_engine_t engine,
+                        ten_vad_engine_result_t* results, size_t max_results,
+                        size_t* num_results) {
+  TenVadEngine* eng = (TenVadEngine*)engine;
+  if (eng == nullptr || results == nullptr || num_results == nullptr) {
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(eng->resultMutex);
+  size_t num = 0;
+  while (num < max_results && !eng->results.empty()) {
+    results[num++] = eng->results.front();
+    eng->results.pop_front();
+  }
+  *num_results = num;
+  return 0;
+}
+
+int ten_vad_engine_flush(ten_vad_engine_t engine) {
+  TenVadEngine* eng = (TenVadEngine*)engine;
+  if (eng == nullptr) {
+    return -1;
+  }
+  std::unique_lock<std::mutex> lock(eng->doneMutex);
+  eng->doneCv.wait(lock, [eng] { return eng->pendingFrames == 0; });
+  return 0;
+}
+
+int ten_vad_engine_detach(ten_vad_engine_t engine, ten_vad_handle_t handle) {
+  TenVadEngine* eng = (TenVadEngine*)engine;
+  if (eng == nullptr) {
+    return -1;
+  }
+  TenVadEngineStream* stream = ten_vad_engine_find(eng, handle);
+  if (stream == nullptr) {
+    return -1;
+  }
+  // wait until no worker holds the stream, the caller does not submit any more
+  std::unique_lock<std::mutex> lock(eng->doneMutex);
+  eng->doneCv.wait(lock, [stream] {
+    std::lock_guard<std::mutex> streamLock(stream->mutex);
+    return !stream->scheduled;
+  });
+  lock.unlock();
+  {
+    std::lock_guard<std::mutex> streamLock(eng->streamMutex);
+    eng->streams.erase(handle);
+  }
+  delete stream;
+  return 0;
+}
+
+int ten_vad_engine_destroy(ten_vad_engine_t* engine) {
+  if (engine == nullptr || *engine == nullptr) {
+    return -1;
+  }
+  TenVadEngine* eng = (TenVadEngine*)(*engine);
+  eng->stop = true;
+  { std::lock_guard<std::mutex> lock(eng->wakeMutex); }
+  eng->wakeCv.notify_all();
+  for (TenVadEngineWorker* w : eng->workers) {
+    w->thread.join();
+    delete w;
+  }
+  for (auto& it : eng->streams) {
+    delete it.second;
+  }
+  delete eng;
+  *engine = nullptr;
+  return 0;
+}